@@ -34,10 +34,36 @@ FFTConvolver::FFTConvolver() :
   _segCount(0),
   _fftComplexSize(0),
   _segments(),
+  _segmentGenerations(),
+  _generation(0),
   _segmentsIR(),
+  _segmentsIRHalf(),
+  _segmentsIRZero(),
+  _irSegCount(0),
+  _irCount(0),
+  _routed(false),
+  _halfPrecision(false),
+  _ownsIR(true),
+  _pager(nullptr),
+  _activePager(nullptr),
+  _residentBytes(0),
+  _historyLength(0),
+  _residentSegments(0),
   _fftBuffer(),
   _fft(),
   _preMultiplied(),
+  _morphPreMultiplied(),
+  _morphWeights(),
+  _morphWeightsActive(),
+  _morphConv(),
+  _decayFirst(1),
+  _decayRatio(1),
+  _segmentGains(),
+  _fadeSource(nullptr),
+  _fadePosition(0),
+  _fadePositionActive(0),
+  _fadeEnd(false),
+  _fadePreMultiplied(),
   _conv(),
   _overlap(),
   _current(0),
@@ -55,10 +81,24 @@ FFTConvolver::~FFTConvolver()
 
 void FFTConvolver::reset()
 {
-  for (size_t i=0; i<_segCount; ++i)
+  for (size_t i=0; i<_segments.size(); ++i)
   {
     delete _segments[i];
-    delete _segmentsIR[i];
+  }
+  for (size_t i=0; i<_morphPreMultiplied.size(); ++i)
+  {
+    delete _morphPreMultiplied[i];
+  }
+  if (_ownsIR)
+  {
+    for (size_t i=0; i<_segmentsIR.size(); ++i)
+    {
+      delete _segmentsIR[i];
+    }
+    for (size_t i=0; i<_segmentsIRHalf.size(); ++i)
+    {
+      delete _segmentsIRHalf[i];
+    }
   }
 
   _blockSize = 0;
@@ -66,10 +106,29 @@ void FFTConvolver::reset()
   _segCount = 0;
   _fftComplexSize = 0;
   _segments.clear();
+  _segmentGenerations.clear();
   _segmentsIR.clear();
+  _segmentsIRHalf.clear();
+  _segmentsIRZero.clear();
+  _irSegCount = 0;
+  _irCount = 0;
+  _routed = false;
+  _ownsIR = true;
+  _residentSegments = 0;
+  _activePager = nullptr;
   _fftBuffer.clear();
   _fft.init(0);
   _preMultiplied.clear();
+  _morphPreMultiplied.clear();
+  _morphWeights.clear();
+  _morphWeightsActive.clear();
+  _morphConv.clear();
+  _segmentGains.clear();
+  _fadeSource = nullptr;
+  _fadePosition = 0;
+  _fadePositionActive = 0;
+  _fadeEnd = false;
+  _fadePreMultiplied.clear();
   _conv.clear();
   _overlap.clear();
   _current = 0;
@@ -77,42 +136,114 @@ void FFTConvolver::reset()
   _inputBufferFill = 0;
 }
 
-void FFTConvolver::clear()
+void FFTConvolver::setHalfPrecision(bool enabled)
 {
-    _overlap.setZero();
-    _inputBuffer.setZero();
+  _halfPrecision = enabled;
+}
 
-    for (auto& segment : _segments) {
-        segment->setZero();
-    }
 
-    _current = 0;
+void FFTConvolver::setInputHistory(size_t len)
+{
+  _historyLength = len;
+}
+
+
+void FFTConvolver::setSpectraPager(SpectraPager* pager, size_t residentBytes)
+{
+  _pager = pager;
+  _residentBytes = residentBytes;
+}
+
+
+size_t FFTConvolver::getIRMemoryUsage() const
+{
+  if (!_ownsIR)
+  {
+    return 0;
+  }
+  const size_t sampleSize = _segmentsIRHalf.empty() ? sizeof(Sample) : sizeof(HalfSample);
+  return 2 * _fftComplexSize * sampleSize * _residentSegments * _irCount;
+}
+
+
+void FFTConvolver::setMorphWeights(const Sample* weights, size_t count)
+{
+  const size_t n = std::min(count, _morphWeights.size());
+  for (size_t i=0; i<n; ++i)
+  {
+    _morphWeights[i] = weights[i];
+  }
+}
+
+
+void FFTConvolver::setSegmentDecay(Sample firstGain, Sample segmentGain)
+{
+  _decayFirst = firstGain;
+  _decayRatio = segmentGain;
+}
+
+void FFTConvolver::clear()
+{
+  _overlap.setZero();
+  _inputBuffer.setZero();
+  _inputBufferFill = 0;
+
+  // The input segments are not touched, older generations read as zero
+  ++_generation;
 }
 
 
 bool FFTConvolver::init(size_t blockSize, const Sample* ir, size_t irLen)
+{
+  return initMorph(blockSize, &ir, 1, irLen);
+}
+
+
+bool FFTConvolver::initMorph(size_t blockSize, const Sample* const* irs, size_t irCount, size_t irLen)
+{
+  return initSets(blockSize, irs, irCount, irLen, false);
+}
+
+
+bool FFTConvolver::initRoutes(size_t blockSize, const Sample* const* irs, size_t irCount, size_t irLen)
+{
+  return initSets(blockSize, irs, irCount, irLen, true);
+}
+
+
+bool FFTConvolver::initSets(size_t blockSize, const Sample* const* irs, size_t irCount, size_t irLen, bool routed)
 {
   reset();
 
-  if (blockSize == 0)
+  if (blockSize == 0 || irCount == 0)
   {
     return false;
   }
 
-  // Ignore zeros at the end of the impulse response because they only waste computation time
-  while (irLen > 0 && ::fabs(ir[irLen-1]) < 0.000001f)
+  // Ignore zeros at the end of the impulse responses because they only waste computation time
+  auto isSilent = [&](size_t pos)
+  {
+    return std::all_of(irs, irs+irCount, [pos](const Sample* ir) { return ::fabs(ir[pos]) < 0.000001f; });
+  };
+  while (irLen > 0 && isSilent(irLen-1))
   {
     --irLen;
   }
 
-  if (irLen == 0)
+  // Silent routes still have their outputs
+  _irCount = irCount;
+  _routed = routed;
+
+  const size_t historyLen = std::max(irLen, _historyLength);
+  if (historyLen == 0)
   {
     return true;
   }
 
   _blockSize = NextPowerOf2(blockSize);
   _segSize = 2 * _blockSize;
-  _segCount = static_cast<size_t>(::ceil(static_cast<float>(irLen) / static_cast<float>(_blockSize)));
+  _irSegCount = static_cast<size_t>(::ceil(static_cast<float>(irLen) / static_cast<float>(_blockSize)));
+  _segCount = static_cast<size_t>(::ceil(static_cast<float>(historyLen) / static_cast<float>(_blockSize)));
   _fftComplexSize = audiofft::AudioFFT::ComplexSize(_segSize);
 
   // FFT
@@ -125,21 +256,125 @@ bool FFTConvolver::init(size_t blockSize, const Sample* ir, size_t irLen)
     _segments.push_back(new SplitComplex(_fftComplexSize));
   }
 
-  // Prepare IR
+  // Segments exceeding the resident budget go to the pager
+  _residentSegments = _irSegCount;
+  if (_pager && _irCount == 1)
+  {
+    const size_t sampleSize = _halfPrecision ? sizeof(HalfSample) : sizeof(Sample);
+    const size_t segmentBytes = 2 * _fftComplexSize * sampleSize;
+    const size_t budgetSegments = std::max(size_t(1), _residentBytes / segmentBytes);
+    if (budgetSegments < _irSegCount && _pager->beginStore(_fftComplexSize, budgetSegments, _irSegCount - budgetSegments))
+    {
+      _residentSegments = budgetSegments;
+      _activePager = _pager;
+    }
+  }
+
+  // Prepare IRs, the segments of all impulse responses are stored one after another
+  SplitComplex staging((_halfPrecision || _residentSegments < _irSegCount) ? _fftComplexSize : 0);
+  for (size_t set=0; set<_irCount; ++set)
+  {
+    const Sample* ir = irs[set];
+    for (size_t i=0; i<_irSegCount; ++i)
+    {
+      const size_t remaining = irLen - (i * _blockSize);
+      const size_t sizeCopy = (remaining >= _blockSize) ? _blockSize : remaining;
+      CopyAndPad(_fftBuffer, &ir[i*_blockSize], sizeCopy);
+      const Sample* segmentIR = &ir[i*_blockSize];
+      _segmentsIRZero.push_back(std::all_of(segmentIR, segmentIR+sizeCopy, [](Sample s) { return s == Sample(0.0); }));
+      if (i >= _residentSegments)
+      {
+        _fft.fft(_fftBuffer.data(), staging.re(), staging.im());
+        _activePager->store(i, staging.re(), staging.im());
+      }
+      else if (_halfPrecision)
+      {
+        _fft.fft(_fftBuffer.data(), staging.re(), staging.im());
+        HalfSplitComplex* segment = new HalfSplitComplex(_fftComplexSize);
+        segment->copyFrom(staging);
+        _segmentsIRHalf.push_back(segment);
+      }
+      else
+      {
+        SplitComplex* segment = new SplitComplex(_fftComplexSize);
+        _fft.fft(_fftBuffer.data(), segment->re(), segment->im());
+        _segmentsIR.push_back(segment);
+      }
+    }
+  }
+
+  if (_activePager && !_activePager->endStore())
+  {
+    // Storing failed, keep everything in memory instead
+    SpectraPager* pager = _pager;
+    _pager = nullptr;
+    const bool success = initSets(blockSize, irs, irCount, irLen, routed);
+    _pager = pager;
+    return success;
+  }
+
+  // Prepare convolution buffers
+  prepareMorph();
+  _preMultiplied.resize(_fftComplexSize);
+  _conv.resize(_fftComplexSize);
+  _overlap.resize(_blockSize * (_routed ? _irCount : 1));
+
+  // Prepare input buffer
+  _inputBuffer.resize(_blockSize);
+  _inputBufferFill = 0;
+
+  // Reset current position
+  _current = 0;
+
+  return true;
+}
+
+
+bool FFTConvolver::initFrom(const FFTConvolver& other)
+{
+  reset();
+
+  if (other._activePager)
+  {
+    // Paged segments are fetched sequentially, the pager can't serve two convolvers
+    return false;
+  }
+
+  _irCount = other._irCount;
+  _routed = other._routed;
+  if (other._segCount == 0)
+  {
+    return true;
+  }
+
+  _blockSize = other._blockSize;
+  _segSize = other._segSize;
+  _segCount = other._segCount;
+  _fftComplexSize = other._fftComplexSize;
+
+  // FFT
+  _fft.init(_segSize);
+  _fftBuffer.resize(_segSize);
+
+  // Prepare segments
   for (size_t i=0; i<_segCount; ++i)
   {
-    SplitComplex* segment = new SplitComplex(_fftComplexSize);
-    const size_t remaining = irLen - (i * _blockSize);
-    const size_t sizeCopy = (remaining >= _blockSize) ? _blockSize : remaining;
-    CopyAndPad(_fftBuffer, &ir[i*_blockSize], sizeCopy);
-    _fft.fft(_fftBuffer.data(), segment->re(), segment->im());
-    _segmentsIR.push_back(segment);
+    _segments.push_back(new SplitComplex(_fftComplexSize));
   }
 
+  // Share IR
+  _segmentsIR = other._segmentsIR;
+  _segmentsIRHalf = other._segmentsIRHalf;
+  _segmentsIRZero = other._segmentsIRZero;
+  _residentSegments = other._residentSegments;
+  _irSegCount = other._irSegCount;
+  _ownsIR = false;
+
   // Prepare convolution buffers
+  prepareMorph();
   _preMultiplied.resize(_fftComplexSize);
   _conv.resize(_fftComplexSize);
-  _overlap.resize(_blockSize);
+  _overlap.resize(_blockSize * (_routed ? _irCount : 1));
 
   // Prepare input buffer
   _inputBuffer.resize(_blockSize);
@@ -152,11 +387,193 @@ bool FFTConvolver::init(size_t blockSize, const Sample* ir, size_t irLen)
 }
 
 
+bool FFTConvolver::canFadeTo(const FFTConvolver& other) const
+{
+  if (_fadeSource || other._fadeSource || &other == this)
+  {
+    return false;
+  }
+  if (other._segCount == 0)
+  {
+    return true;
+  }
+  // The input history has to cover the new impulse response
+  return _segCount > 0 && !_routed && !other._routed &&
+         _blockSize == other._blockSize &&
+         other._irSegCount <= _segCount &&
+         _irCount == 1 && other._irCount == 1 &&
+         !_activePager && !other._activePager &&
+         _segmentsIRHalf.empty() == other._segmentsIRHalf.empty();
+}
+
+
+bool FFTConvolver::beginFade(FFTConvolver& other)
+{
+  if (!canFadeTo(other))
+  {
+    return false;
+  }
+  if (_segCount == 0)
+  {
+    // Nothing convolved, nothing to fade
+    return true;
+  }
+  _fadeSource = &other;
+  _fadePosition = Sample(0.0);
+  _fadeEnd = false;
+  return true;
+}
+
+
+void FFTConvolver::setFadePosition(Sample position)
+{
+  _fadePosition = std::min(std::max(position, Sample(0.0)), Sample(1.0));
+}
+
+
+void FFTConvolver::endFade()
+{
+  if (_fadeSource)
+  {
+    _fadePosition = Sample(1.0);
+    _fadeEnd = true;
+  }
+}
+
+
+bool FFTConvolver::isFading() const
+{
+  return _fadeSource != nullptr;
+}
+
+
+void FFTConvolver::adoptFadeSource()
+{
+  // Swaps the impulse responses, the source keeps the old one until it is reset
+  FFTConvolver& other = *_fadeSource;
+  std::swap(_segmentsIR, other._segmentsIR);
+  std::swap(_segmentsIRHalf, other._segmentsIRHalf);
+  std::swap(_segmentsIRZero, other._segmentsIRZero);
+  std::swap(_irSegCount, other._irSegCount);
+  std::swap(_residentSegments, other._residentSegments);
+  std::swap(_ownsIR, other._ownsIR);
+  _fadeSource = nullptr;
+  _fadePosition = Sample(0.0);
+  _fadePositionActive = Sample(0.0);
+  _fadeEnd = false;
+}
+
+
+void FFTConvolver::prepareMorph()
+{
+  for (size_t set=1; set<_irCount; ++set)
+  {
+    _morphPreMultiplied.push_back(new SplitComplex(_fftComplexSize));
+  }
+  _morphWeights.assign(_irCount, Sample(0.0));
+  _morphWeights[0] = Sample(1.0);
+  _morphWeightsActive = _morphWeights;
+  _morphConv.resize(_fftComplexSize);
+  _segmentGains.assign(_segCount, Sample(1.0));
+  _segmentGenerations.assign(_segCount, _generation);
+  _fadePreMultiplied.resize(_fftComplexSize);
+}
+
+
+void FFTConvolver::accumulateSegments(SplitComplex& result, const FFTConvolver& irSource, size_t offset)
+{
+  // Segments 1..N of an impulse response set against the input history, segment 0 follows per call
+  const bool halfIR = !irSource._segmentsIRHalf.empty();
+  for (size_t i=1; i<irSource._irSegCount; ++i)
+  {
+    const size_t indexIr = i;
+    const size_t indexAudio = (_current + i) % _segCount;
+    const Sample gain = _segmentGains[indexIr];
+    const bool cleared = (_segmentGenerations[indexAudio] != _generation);
+    if (indexIr >= irSource._residentSegments)
+    {
+      // Paged segments are always fetched, the pager relies on the access order
+      const Sample* re = nullptr;
+      const Sample* im = nullptr;
+      if (irSource._activePager->fetch(indexIr, re, im))
+      {
+        if (cleared)
+        {
+          irSource._activePager->release(indexIr);
+          continue;
+        }
+        const SplitComplex& audio = *_segments[indexAudio];
+        ComplexMultiplyAccumulate(result.re(), result.im(), re, im, audio.re(), audio.im(), _fftComplexSize, gain);
+        irSource._activePager->release(indexIr);
+      }
+    }
+    else if (cleared || irSource._segmentsIRZero[offset+indexIr] || gain < Sample(0.000001))
+    {
+      continue;
+    }
+    else if (halfIR)
+    {
+      ComplexMultiplyAccumulate(result, *irSource._segmentsIRHalf[offset+indexIr], *_segments[indexAudio], gain);
+    }
+    else
+    {
+      ComplexMultiplyAccumulate(result, *irSource._segmentsIR[offset+indexIr], *_segments[indexAudio], gain);
+    }
+  }
+}
+
+
+void FFTConvolver::multiplyFirstSegment(SplitComplex& result, const FFTConvolver& irSource, size_t offset)
+{
+  if (irSource._irSegCount == 0 || irSource._segmentsIRZero[offset])
+  {
+    return;
+  }
+  if (!irSource._segmentsIRHalf.empty())
+  {
+    ComplexMultiplyAccumulate(result, *irSource._segmentsIRHalf[offset], *_segments[_current], _segmentGains[0]);
+  }
+  else
+  {
+    ComplexMultiplyAccumulate(result, *_segments[_current], *irSource._segmentsIR[offset], _segmentGains[0]);
+  }
+}
+
+
+void FFTConvolver::inverseAndOverlap(Sample* output, size_t set, size_t pos, size_t len)
+{
+  Sample* overlap = _overlap.data() + set * _blockSize;
+
+  // Backward FFT
+  _fft.ifft(_fftBuffer.data(), _conv.re(), _conv.im());
+
+  // Add overlap
+  Sum(output, _fftBuffer.data()+pos, overlap+pos, len);
+
+  // Save the overlap once the block is complete
+  if (pos + len == _blockSize)
+  {
+    ::memcpy(overlap, _fftBuffer.data()+_blockSize, _blockSize * sizeof(Sample));
+  }
+}
+
+
 void FFTConvolver::process(const Sample* input, Sample* output, size_t len)
+{
+  assert(!_routed || _irCount == 1);
+  processRoutes(input, &output, len);
+}
+
+
+void FFTConvolver::processRoutes(const Sample* input, Sample* const* outputs, size_t len)
 {
   if (_segCount == 0)
   {
-    ::memset(output, 0, len * sizeof(Sample));
+    const size_t outputCount = _routed ? _irCount : 1;
+    for (size_t i=0; i<outputCount; ++i)
+    {
+      ::memset(outputs[i], 0, len * sizeof(Sample));
+    }
     return;
   }
 
@@ -171,26 +588,103 @@ void FFTConvolver::process(const Sample* input, Sample* output, size_t len)
     // Forward FFT
     CopyAndPad(_fftBuffer, &_inputBuffer[0], _blockSize);
     _fft.fft(_fftBuffer.data(), _segments[_current]->re(), _segments[_current]->im());
+    _segmentGenerations[_current] = _generation;
 
     // Complex multiplication
     if (inputBufferWasEmpty)
     {
-      _preMultiplied.setZero();
-      for (size_t i=1; i<_segCount; ++i)
+      // A requested fade end takes over the new impulse response at a block boundary
+      if (_fadeSource && _fadeEnd)
       {
-        const size_t indexIr = i;
-        const size_t indexAudio = (_current + i) % _segCount;
-        ComplexMultiplyAccumulate(_preMultiplied, *_segmentsIR[indexIr], *_segments[indexAudio]);
+        adoptFadeSource();
       }
-    }
-    _conv.copyFrom(_preMultiplied);
-    ComplexMultiplyAccumulate(_conv, *_segments[_current], *_segmentsIR[0]);
 
-    // Backward FFT
-    _fft.ifft(_fftBuffer.data(), _conv.re(), _conv.im());
+      // Weights are latched per block, they have to match the accumulated sums
+      std::copy(_morphWeights.begin(), _morphWeights.end(), _morphWeightsActive.begin());
+      _fadePositionActive = _fadePosition;
+      Sample gain = _decayFirst;
+      for (size_t i=0; i<_segCount; ++i)
+      {
+        _segmentGains[i] = gain;
+        gain *= _decayRatio;
+      }
+      for (size_t set=0; set<_irCount; ++set)
+      {
+        SplitComplex& preMultiplied = (set == 0) ? _preMultiplied : *_morphPreMultiplied[set-1];
+        preMultiplied.setZero();
+        if (!_routed && _irCount > 1 && _morphWeightsActive[set] == Sample(0.0))
+        {
+          continue;
+        }
+        if (_fadeSource && _fadePositionActive == Sample(1.0))
+        {
+          continue;
+        }
+        accumulateSegments(preMultiplied, *this, set * _irSegCount);
+      }
+      if (_fadeSource)
+      {
+        _fadePreMultiplied.setZero();
+        if (_fadePositionActive > Sample(0.0))
+        {
+          accumulateSegments(_fadePreMultiplied, *_fadeSource, 0);
+        }
+      }
+    }
+    if (_routed)
+    {
+      // Every impulse response into its own output, the input spectra are shared
+      for (size_t set=0; set<_irCount; ++set)
+      {
+        _conv.copyFrom(set == 0 ? _preMultiplied : *_morphPreMultiplied[set-1]);
+        multiplyFirstSegment(_conv, *this, set * _irSegCount);
+        inverseAndOverlap(outputs[set]+processed, set, inputBufferPos, processing);
+      }
+    }
+    else if (_fadeSource)
+    {
+      // Crossfade, both impulse responses share the input spectra and the inverse FFT
+      const Sample position = _fadePositionActive;
+      _conv.setZero();
+      if (position < Sample(1.0))
+      {
+        _morphConv.copyFrom(_preMultiplied);
+        multiplyFirstSegment(_morphConv, *this, 0);
+        ScaleAccumulate(_conv, _morphConv, Sample(1.0) - position);
+      }
+      if (position > Sample(0.0))
+      {
+        _morphConv.copyFrom(_fadePreMultiplied);
+        multiplyFirstSegment(_morphConv, *_fadeSource, 0);
+        ScaleAccumulate(_conv, _morphConv, position);
+      }
+    }
+    else if (_irCount == 1)
+    {
+      _conv.copyFrom(_preMultiplied);
+      multiplyFirstSegment(_conv, *this, 0);
+    }
+    else
+    {
+      // Weighted sum of all impulse responses, a single inverse FFT follows
+      _conv.setZero();
+      for (size_t set=0; set<_irCount; ++set)
+      {
+        const Sample weight = _morphWeightsActive[set];
+        if (weight == Sample(0.0))
+        {
+          continue;
+        }
+        _morphConv.copyFrom(set == 0 ? _preMultiplied : *_morphPreMultiplied[set-1]);
+        multiplyFirstSegment(_morphConv, *this, set * _irSegCount);
+        ScaleAccumulate(_conv, _morphConv, weight);
+      }
+    }
 
-    // Add overlap
-    Sum(output+processed, _fftBuffer.data()+inputBufferPos, _overlap.data()+inputBufferPos, processing);
+    if (!_routed)
+    {
+      inverseAndOverlap(outputs[0]+processed, 0, inputBufferPos, processing);
+    }
 
     // Input buffer full => Next block
     _inputBufferFill += processing;
@@ -200,9 +694,6 @@ void FFTConvolver::process(const Sample* input, Sample* output, size_t len)
       _inputBuffer.setZero();
       _inputBufferFill = 0;
 
-      // Save the overlap
-      ::memcpy(_overlap.data(), _fftBuffer.data()+_blockSize, _blockSize * sizeof(Sample));
-
       // Update current segment
       _current = (_current > 0) ? (_current - 1) : (_segCount - 1);
     }
@@ -27,6 +27,68 @@
 namespace fftconvolver
 { 
 
+/**
+* @class SpectraPager
+* @brief Backing store for impulse response spectra which are not kept in memory
+*
+* A convolver with a pager keeps only the first impulse response segments in
+* memory (as many as fit into its resident budget), the remaining ones are handed
+* to the pager during init() and requested again during processing.
+*
+* Some notes on how to implement it:
+*
+* - Paged segments are fetched in ascending order, each of them exactly once per
+*   processed block, so the access pattern is fully predictable and data can be
+*   paged in ahead of time (e.g. by a prefetching thread).
+*
+* - fetch() is called from the processing thread, the returned pointers must be
+*   16-byte aligned and stay valid until the matching call of release().
+*
+* - The stored values have to be returned bit-exact, the convolution result is
+*   then identical to the one of a convolver without pager.
+*/
+class SpectraPager
+{
+public:
+  virtual ~SpectraPager() {}
+
+  /**
+  * @brief Called on init() before the paged segments are stored
+  * @param complexSize Number of complex values per segment
+  * @param firstSegment Index of the first paged segment
+  * @param segmentCount Number of paged segments
+  * @return true: Success - false: Failed (all segments are kept in memory)
+  */
+  virtual bool beginStore(size_t complexSize, size_t firstSegment, size_t segmentCount) = 0;
+
+  /**
+  * @brief Stores the spectrum of one segment (called in ascending segment order)
+  */
+  virtual void store(size_t segment, const Sample* re, const Sample* im) = 0;
+
+  /**
+  * @brief Called on init() after all paged segments have been stored
+  * @return true: Success - false: Failed (all segments are kept in memory)
+  */
+  virtual bool endStore() = 0;
+
+  /**
+  * @brief Returns the spectrum of a previously stored segment
+  *
+  * A skipped segment changes the convolution result, implementations should
+  * rather wait for the data and report the segments they could not deliver.
+  *
+  * @return true: Success - false: Data unavailable, the segment is skipped
+  */
+  virtual bool fetch(size_t segment, const Sample*& re, const Sample*& im) = 0;
+
+  /**
+  * @brief Signals that the data of the last fetched segment is not used anymore
+  */
+  virtual void release(size_t segment) = 0;
+};
+
+
 /**
 * @class FFTConvolver
 * @brief Implementation of a partitioned FFT convolution algorithm with uniform block size
@@ -41,6 +103,20 @@ namespace fftconvolver
 *   processing time, of course), i.e. the output always is the convolved
 *   input for each processing call.
 *
+* - Impulse response segments containing only zeros (e.g. the gaps of sparse
+*   impulse responses) are skipped during the complex multiplication.
+*
+* - Several impulse responses can be loaded at once (see initMorph()), the output
+*   is then the weighted sum of their convolutions computed with a single forward
+*   and inverse FFT per block.
+*
+* - Several impulse responses can also be convolved with the same input into
+*   separate outputs (see initRoutes()), e.g. the routes of one input channel of a
+*   convolution matrix, the input is then transformed once for all of them.
+*
+* - A new impulse response can be crossfaded in (see beginFade()) reusing the
+*   input spectra, so switching costs neither a second convolver nor a warmup.
+*
 * - The convolver is suitable for real-time processing which means that no
 *   "unpredictable" operations like allocations, locking, API calls, etc. are
 *   performed during processing (all necessary allocations and preparations take
@@ -61,6 +137,114 @@ public:
   */
   bool init(size_t blockSize, const Sample* ir, size_t irLen);
 
+  /**
+  * @brief Initializes the convolver with several impulse responses to morph between
+  *
+  * Each impulse response keeps its own accumulator over the shared input spectra,
+  * the accumulators are weighted (see setMorphWeights()) and summed before the
+  * inverse FFT. Impulse responses with a weight of zero cost no complex
+  * multiplications. Morphing convolvers keep all spectra in memory (no pager).
+  *
+  * @param blockSize Block size internally used by the convolver (partition size)
+  * @param irs The impulse responses
+  * @param irCount Number of impulse responses
+  * @param irLen Length of each impulse response (shorter ones have to be zero padded)
+  * @return true: Success - false: Failed
+  */
+  bool initMorph(size_t blockSize, const Sample* const* irs, size_t irCount, size_t irLen);
+
+  /**
+  * @brief Initializes the convolver with several impulse responses each convolved into its own output
+  *
+  * All impulse responses share the forward FFT of the input and its spectra, each
+  * one adds its complex multiplications and an inverse FFT (see processRoutes()).
+  * Routing convolvers can't morph or fade.
+  *
+  * @param blockSize Block size internally used by the convolver (partition size)
+  * @param irs The impulse responses
+  * @param irCount Number of impulse responses (and outputs)
+  * @param irLen Length of each impulse response (shorter ones have to be zero padded)
+  * @return true: Success - false: Failed
+  */
+  bool initRoutes(size_t blockSize, const Sample* const* irs, size_t irCount, size_t irLen);
+
+  /**
+  * @brief Sets the weights of the impulse responses loaded with initMorph()
+  *
+  * The weights are latched at the start of each block of blockSize samples, so
+  * they should be smoothed by the caller. Defaults to 1 for the first impulse
+  * response and 0 for the others.
+  *
+  * @param weights One weight per impulse response
+  * @param count Number of weights (extra weights are ignored)
+  */
+  void setMorphWeights(const Sample* weights, size_t count);
+
+  /**
+  * @brief Weights the impulse response segments with geometrically decaying gains
+  *
+  * Segment i is weighted by firstGain * segmentGain^i while accumulating, which
+  * imposes a decay on the impulse response without touching its spectra. The gains
+  * are latched at the start of each block of blockSize samples, like the morph
+  * weights. Resident segments whose gain drops below -120dB are skipped. Defaults
+  * to 1 for all segments.
+  *
+  * @param firstGain Gain of the first segment
+  * @param segmentGain Gain ratio between two consecutive segments
+  */
+  void setSegmentDecay(Sample firstGain, Sample segmentGain);
+
+  /**
+  * @brief Returns whether beginFade() would accept the given convolver
+  *
+  * Requires the same block size, an impulse response not longer than the current
+  * one (the input history is shared), the same precision, no morphing and no pager.
+  */
+  bool canFadeTo(const FFTConvolver& other) const;
+
+  /**
+  * @brief Starts crossfading to the impulse response of another convolver
+  *
+  * The other convolver only provides its impulse response spectra, it is not
+  * processed. Both impulse responses are accumulated against the input history of
+  * this convolver and summed with the fade position before a single inverse FFT,
+  * so the new impulse response needs no warmup. Once the position reached 1,
+  * endFade() takes over the new spectra at the next block and hands the old ones
+  * to the other convolver, which then has to be reset (e.g. off the real-time thread).
+  *
+  * @param other The convolver holding the new impulse response
+  * @return true: Success - false: Incompatible convolver (see canFadeTo())
+  */
+  bool beginFade(FFTConvolver& other);
+
+  /**
+  * @brief Sets the crossfade position, latched at the start of each block like the morph weights
+  * @param position 0: Current impulse response only - 1: New impulse response only
+  */
+  void setFadePosition(Sample position);
+
+  /**
+  * @brief Ends the crossfade at the next block, the new impulse response is taken over
+  */
+  void endFade();
+
+  /**
+  * @brief Returns whether a crossfade started with beginFade() is still attached
+  */
+  bool isFading() const;
+
+  /**
+  * @brief Initializes the convolver with the impulse response of another convolver
+  *
+  * The impulse response spectra are shared, not copied, so no transforms are
+  * done and no spectra memory is allocated. The other convolver must keep its
+  * impulse response (no reset() or init()) while this convolver uses it.
+  *
+  * @param other The convolver whose impulse response is shared
+  * @return true: Success - false: Failed (spectra of the other convolver are paged)
+  */
+  bool initFrom(const FFTConvolver& other);
+
   /**
   * @brief Convolves the the given input samples and immediately outputs the result
   * @param input The input samples
@@ -69,8 +253,21 @@ public:
   */
   void process(const Sample* input, Sample* output, size_t len);
 
-  /*
-  * Only clears buffers, leaving IR loaded
+  /**
+  * @brief Convolves the given input samples with every impulse response loaded with initRoutes()
+  * @param input The input samples
+  * @param outputs One output per impulse response
+  * @param len Number of input/output samples
+  */
+  void processRoutes(const Sample* input, Sample* const* outputs, size_t len);
+
+  /**
+  * @brief Clears the input history and the overlap, leaving the impulse response loaded
+  *
+  * Runs in constant time regardless of the impulse response length: the input
+  * segments are tagged with a generation which clear() advances, segments of an
+  * older generation are treated as zero and get overwritten one per block as the
+  * input history wraps around.
   */
   void clear();
 
@@ -78,17 +275,93 @@ public:
   * @brief Resets the convolver and discards the set impulse response
   */
   void reset();
+
+  /**
+  * @brief Stores the impulse response spectra in half precision
+  *
+  * Takes effect on the next call of init(). Halves the memory and bandwidth used
+  * by the impulse response spectra, the output keeps roughly 70dB signal to error
+  * ratio (see test/Test.cpp for the accuracy report).
+  *
+  * @param enabled true: Half precision storage - false: Full precision storage (default)
+  */
+  void setHalfPrecision(bool enabled);
+
+  /**
+  * @brief Returns the number of bytes used by the impulse response spectra kept in memory
+  *
+  * Spectra shared from another convolver (see initFrom()) are not counted.
+  */
+  size_t getIRMemoryUsage() const;
+
+  /**
+  * @brief Keeps the input history of at least len samples of impulse response
+  *
+  * Takes effect on the next call of init(). A convolver only keeps as much input
+  * history as its impulse response needs, a longer history lets it fade to longer
+  * impulse responses (see canFadeTo()). The extra segments cost input spectra
+  * memory but no complex multiplications.
+  *
+  * @param len Minimum impulse response length covered by the input history (0: impulse response length)
+  */
+  void setInputHistory(size_t len);
+
+  /**
+  * @brief Moves impulse response segments exceeding a memory budget into a pager
+  *
+  * Takes effect on the next call of init(). The first segment is always kept in
+  * memory. Paged segments are stored in full precision regardless of
+  * setHalfPrecision(). The pager is not owned by the convolver and has to outlive
+  * its usage.
+  *
+  * @param pager The pager storing the segments beyond the budget (nullptr: no paging)
+  * @param residentBytes Budget for the impulse response spectra kept in memory
+  */
+  void setSpectraPager(SpectraPager* pager, size_t residentBytes);
   
 private:
+  bool initSets(size_t blockSize, const Sample* const* irs, size_t irCount, size_t irLen, bool routed);
+  void prepareMorph();
+  void inverseAndOverlap(Sample* output, size_t set, size_t pos, size_t len);
+  void accumulateSegments(SplitComplex& result, const FFTConvolver& irSource, size_t offset);
+  void multiplyFirstSegment(SplitComplex& result, const FFTConvolver& irSource, size_t offset);
+  void adoptFadeSource();
+
   size_t _blockSize;
   size_t _segSize;
   size_t _segCount;
   size_t _fftComplexSize;
   std::vector<SplitComplex*> _segments;
+  std::vector<uint32_t> _segmentGenerations;
+  uint32_t _generation;
   std::vector<SplitComplex*> _segmentsIR;
+  std::vector<HalfSplitComplex*> _segmentsIRHalf;
+  std::vector<bool> _segmentsIRZero;
+  size_t _irSegCount;
+  size_t _irCount;
+  bool _routed;
+  bool _halfPrecision;
+  bool _ownsIR;
+  SpectraPager* _pager;
+  SpectraPager* _activePager;
+  size_t _residentBytes;
+  size_t _historyLength;
+  size_t _residentSegments;
   SampleBuffer _fftBuffer;
   audiofft::AudioFFT _fft;
   SplitComplex _preMultiplied;
+  std::vector<SplitComplex*> _morphPreMultiplied;
+  std::vector<Sample> _morphWeights;
+  std::vector<Sample> _morphWeightsActive;
+  SplitComplex _morphConv;
+  Sample _decayFirst;
+  Sample _decayRatio;
+  std::vector<Sample> _segmentGains;
+  FFTConvolver* _fadeSource;
+  Sample _fadePosition;
+  Sample _fadePositionActive;
+  bool _fadeEnd;
+  SplitComplex _fadePreMultiplied;
   SplitComplex _conv;
   SampleBuffer _overlap;
   size_t _current;
@@ -37,7 +37,21 @@ TwoStageFFTConvolver::TwoStageFFTConvolver() :
   _tailInput(),
   _tailInputFill(0),
   _precalculatedPos(0),
-  _backgroundProcessingInput()
+  _backgroundProcessingInput(),
+  _morphWeights(),
+  _backgroundMorphWeights(),
+  _decay(1),
+  _backgroundDecay(1),
+  _fadePosition(0),
+  _tailFadeSource(nullptr),
+  _tailFadeEnd(false),
+  _tailFading(false),
+  _tailClearPending(false),
+  _historyLength(0),
+  _routed(false),
+  _routeCount(1),
+  _routeOutputs(),
+  _backgroundRouteOutputs()
 {
 }
 
@@ -64,23 +78,60 @@ void TwoStageFFTConvolver::reset()
   _tailInputFill = 0;
   _precalculatedPos = 0;
   _backgroundProcessingInput.clear();
+  _morphWeights.clear();
+  _backgroundMorphWeights.clear();
+  _fadePosition = 0;
+  _tailFadeSource = nullptr;
+  _tailFadeEnd = false;
+  _tailFading = false;
+  _tailClearPending = false;
+  _routed = false;
+  _routeCount = 1;
+  _routeOutputs.clear();
+  _backgroundRouteOutputs.clear();
 }
 
 void TwoStageFFTConvolver::clear()
 {
-    _tailOutput.setZero();
-    _tailOutput0.setZero();
-    _tailPrecalculated.setZero();
-    _tailPrecalculated0.setZero();
-    _tailInput.setZero();
-    _backgroundProcessingInput.setZero();
+  _headConvolver.clear();
+  _tailConvolver0.clear();
+  _tailOutput0.setZero();
+  _tailPrecalculated0.setZero();
+  _tailPrecalculated.setZero();
+  _tailInput.setZero();
+  _tailInputFill = 0;
+  _precalculatedPos = 0;
+
+  // The background tail may still be running, it is cleared at the next hand-over
+  _tailClearPending = (_tailPrecalculated.size() > 0);
+}
+
+
+void TwoStageFFTConvolver::setHalfPrecision(bool enabled)
+{
+  _headConvolver.setHalfPrecision(enabled);
+  _tailConvolver0.setHalfPrecision(enabled);
+  _tailConvolver.setHalfPrecision(enabled);
+}
 
-    _tailInputFill = 0;
-    _precalculatedPos = 0;
 
-    _headConvolver.clear();
-    _tailConvolver0.clear();
-    _tailConvolver.clear();
+void TwoStageFFTConvolver::setTailSpectraPager(SpectraPager* pager, size_t residentBytes)
+{
+  _tailConvolver.setSpectraPager(pager, residentBytes);
+}
+
+
+void TwoStageFFTConvolver::setInputHistory(size_t len)
+{
+  _historyLength = len;
+}
+
+
+size_t TwoStageFFTConvolver::getIRMemoryUsage() const
+{
+  return _headConvolver.getIRMemoryUsage()
+    + _tailConvolver0.getIRMemoryUsage()
+    + _tailConvolver.getIRMemoryUsage();
 }
 
   
@@ -88,10 +139,41 @@ bool TwoStageFFTConvolver::init(size_t headBlockSize,
                                 size_t tailBlockSize,
                                 const Sample* ir,
                                 size_t irLen)
+{
+  return initMorph(headBlockSize, tailBlockSize, &ir, 1, irLen);
+}
+
+
+bool TwoStageFFTConvolver::initMorph(size_t headBlockSize,
+                                     size_t tailBlockSize,
+                                     const Sample* const* irs,
+                                     size_t irCount,
+                                     size_t irLen)
+{
+  return initSets(headBlockSize, tailBlockSize, irs, irCount, irLen, false);
+}
+
+
+bool TwoStageFFTConvolver::initRoutes(size_t headBlockSize,
+                                      size_t tailBlockSize,
+                                      const Sample* const* irs,
+                                      size_t irCount,
+                                      size_t irLen)
+{
+  return initSets(headBlockSize, tailBlockSize, irs, irCount, irLen, true);
+}
+
+
+bool TwoStageFFTConvolver::initSets(size_t headBlockSize,
+                                    size_t tailBlockSize,
+                                    const Sample* const* irs,
+                                    size_t irCount,
+                                    size_t irLen,
+                                    bool routed)
 {
   reset();
 
-  if (headBlockSize == 0 || tailBlockSize == 0)
+  if (headBlockSize == 0 || tailBlockSize == 0 || irCount == 0)
   {
     return false;
   }
@@ -103,37 +185,75 @@ bool TwoStageFFTConvolver::init(size_t headBlockSize,
     std::swap(headBlockSize, tailBlockSize);
   }
   
-  // Ignore zeros at the end of the impulse response because they only waste computation time
-  while (irLen > 0 && ::fabs(ir[irLen-1]) < 0.000001f)
+  // Ignore zeros at the end of the impulse responses because they only waste computation time
+  auto isSilent = [&](size_t pos)
+  {
+    return std::all_of(irs, irs+irCount, [pos](const Sample* ir) { return ::fabs(ir[pos]) < 0.000001f; });
+  };
+  while (irLen > 0 && isSilent(irLen-1))
   {
     --irLen;
   }
 
-  if (irLen == 0)
+  // Routes have an output each, the tail stages keep one block per route
+  _routed = routed;
+  _routeCount = routed ? irCount : 1;
+  _routeOutputs.resize(_routeCount);
+  _backgroundRouteOutputs.resize(_routeCount);
+
+  // The stages are laid out for the input history, which may exceed the impulse response
+  const size_t layoutLen = std::max(irLen, _historyLength);
+  if (layoutLen == 0)
   {
     return true;
   }
   
   _headBlockSize = NextPowerOf2(headBlockSize);
   _tailBlockSize = NextPowerOf2(tailBlockSize);
+  _morphWeights.assign(irCount, Sample(0.0));
+  _morphWeights[0] = Sample(1.0);
+  _backgroundMorphWeights = _morphWeights;
 
-  const size_t headIrLen = std::min(irLen, _tailBlockSize);
-  _headConvolver.init(_headBlockSize, ir, headIrLen);
+  // Each stage convolves the same section of all impulse responses
+  std::vector<const Sample*> sections(irCount);
+  auto offsetIRs = [&](size_t offset)
+  {
+    for (size_t i=0; i<irCount; ++i)
+    {
+      sections[i] = irs[i] + offset;
+    }
+    return sections.data();
+  };
+
+  auto sectionLen = [&](size_t len, size_t offset, size_t maxLen)
+  {
+    return (len > offset) ? std::min(len-offset, maxLen) : size_t(0);
+  };
+
+  auto initStage = [&](FFTConvolver& stage, size_t blockSize, const Sample* const* stageIRs, size_t stageLen)
+  {
+    return routed ? stage.initRoutes(blockSize, stageIRs, irCount, stageLen) : stage.initMorph(blockSize, stageIRs, irCount, stageLen);
+  };
+
+  _headConvolver.setInputHistory(sectionLen(layoutLen, 0, _tailBlockSize));
+  initStage(_headConvolver, _headBlockSize, offsetIRs(0), sectionLen(irLen, 0, _tailBlockSize));
 
-  if (irLen > _tailBlockSize)
+  if (layoutLen > _tailBlockSize)
   {
-    const size_t conv1IrLen = std::min(irLen-_tailBlockSize, _tailBlockSize);
-    _tailConvolver0.init(_headBlockSize, ir+_tailBlockSize, conv1IrLen);
-    _tailOutput0.resize(_tailBlockSize);
-    _tailPrecalculated0.resize(_tailBlockSize);
+    const size_t conv1IrLen = sectionLen(irLen, _tailBlockSize, _tailBlockSize);
+    _tailConvolver0.setInputHistory(sectionLen(layoutLen, _tailBlockSize, _tailBlockSize));
+    initStage(_tailConvolver0, _headBlockSize, offsetIRs(conv1IrLen > 0 ? _tailBlockSize : 0), conv1IrLen);
+    _tailOutput0.resize(_tailBlockSize * _routeCount);
+    _tailPrecalculated0.resize(_tailBlockSize * _routeCount);
   }
 
-  if (irLen > 2 * _tailBlockSize)
+  if (layoutLen > 2 * _tailBlockSize)
   {
-    const size_t tailIrLen = irLen - (2*_tailBlockSize);
-    _tailConvolver.init(_tailBlockSize, ir+(2*_tailBlockSize), tailIrLen);
-    _tailOutput.resize(_tailBlockSize);
-    _tailPrecalculated.resize(_tailBlockSize);
+    const size_t tailIrLen = sectionLen(irLen, 2*_tailBlockSize, irLen);
+    _tailConvolver.setInputHistory(layoutLen - 2*_tailBlockSize);
+    initStage(_tailConvolver, _tailBlockSize, offsetIRs(tailIrLen > 0 ? 2*_tailBlockSize : 0), tailIrLen);
+    _tailOutput.resize(_tailBlockSize * _routeCount);
+    _tailPrecalculated.resize(_tailBlockSize * _routeCount);
     _backgroundProcessingInput.resize(_tailBlockSize);
   }
 
@@ -143,15 +263,178 @@ bool TwoStageFFTConvolver::init(size_t headBlockSize,
   }
   _tailInputFill = 0;
   _precalculatedPos = 0;
+  setDecay(_decay);
+
+  return true;
+}
+
+
+bool TwoStageFFTConvolver::initFrom(const TwoStageFFTConvolver& other)
+{
+  reset();
+
+  if (!_headConvolver.initFrom(other._headConvolver) ||
+      !_tailConvolver0.initFrom(other._tailConvolver0) ||
+      !_tailConvolver.initFrom(other._tailConvolver))
+  {
+    reset();
+    return false;
+  }
+
+  _headBlockSize = other._headBlockSize;
+  _tailBlockSize = other._tailBlockSize;
+  _routed = other._routed;
+  _routeCount = other._routeCount;
+  _routeOutputs.resize(_routeCount);
+  _backgroundRouteOutputs.resize(_routeCount);
+  _tailOutput0.resize(other._tailOutput0.size());
+  _tailPrecalculated0.resize(other._tailPrecalculated0.size());
+  _tailOutput.resize(other._tailOutput.size());
+  _tailPrecalculated.resize(other._tailPrecalculated.size());
+  _backgroundProcessingInput.resize(other._backgroundProcessingInput.size());
+  _tailInput.resize(other._tailInput.size());
+  _morphWeights.assign(other._morphWeights.size(), Sample(0.0));
+  if (!_morphWeights.empty())
+  {
+    _morphWeights[0] = Sample(1.0);
+  }
+  _backgroundMorphWeights = _morphWeights;
+  _tailInputFill = 0;
+  _precalculatedPos = 0;
+  setDecay(_decay);
+
+  return true;
+}
+
+
+void TwoStageFFTConvolver::setMorphWeights(const Sample* weights, size_t count)
+{
+  const size_t n = std::min(count, _morphWeights.size());
+  for (size_t i=0; i<n; ++i)
+  {
+    _morphWeights[i] = weights[i];
+  }
+  _headConvolver.setMorphWeights(weights, count);
+  _tailConvolver0.setMorphWeights(weights, count);
+}
+
+
+void TwoStageFFTConvolver::setDecay(Sample gainPerSample)
+{
+  _decay = gainPerSample;
+  const Sample headBlock = static_cast<Sample>(_headBlockSize);
+  const Sample tailBlock = static_cast<Sample>(_tailBlockSize);
+  const Sample headRatio = std::pow(gainPerSample, headBlock);
+  _headConvolver.setSegmentDecay(std::pow(gainPerSample, Sample(0.5) * headBlock), headRatio);
+  _tailConvolver0.setSegmentDecay(std::pow(gainPerSample, tailBlock + Sample(0.5) * headBlock), headRatio);
+}
+
 
+bool TwoStageFFTConvolver::canFadeTo(const TwoStageFFTConvolver& other) const
+{
+  return !isFading() && !other.isFading() &&
+         _headBlockSize == other._headBlockSize &&
+         _tailBlockSize == other._tailBlockSize &&
+         _headConvolver.canFadeTo(other._headConvolver) &&
+         _tailConvolver0.canFadeTo(other._tailConvolver0) &&
+         _tailConvolver.canFadeTo(other._tailConvolver);
+}
+
+
+bool TwoStageFFTConvolver::beginFade(TwoStageFFTConvolver& other)
+{
+  if (!canFadeTo(other))
+  {
+    return false;
+  }
+  _fadePosition = Sample(0.0);
+  _headConvolver.beginFade(other._headConvolver);
+  _tailConvolver0.beginFade(other._tailConvolver0);
+  if (_tailPrecalculated.size() > 0)
+  {
+    // The background stage may be running, it joins at the next hand-over
+    _tailFadeSource = &other._tailConvolver;
+    _tailFading = true;
+  }
   return true;
 }
 
 
+void TwoStageFFTConvolver::setFadePosition(Sample position)
+{
+  _fadePosition = position;
+  _headConvolver.setFadePosition(position);
+  _tailConvolver0.setFadePosition(position);
+}
+
+
+void TwoStageFFTConvolver::endFade()
+{
+  _fadePosition = Sample(1.0);
+  _headConvolver.endFade();
+  _tailConvolver0.endFade();
+  if (_tailFading)
+  {
+    _tailFadeEnd = true;
+  }
+}
+
+
+bool TwoStageFFTConvolver::isFading() const
+{
+  return _headConvolver.isFading() || _tailConvolver0.isFading() || _tailFading;
+}
+
+
+void TwoStageFFTConvolver::updateTailFade()
+{
+  // Called between two background runs, the tail convolver isn't in use
+  _tailFading = _tailConvolver.isFading();
+  if (_tailFadeSource)
+  {
+    _tailConvolver.beginFade(*_tailFadeSource);
+    _tailFadeSource = nullptr;
+    _tailFading = true;
+  }
+  if (_tailFading)
+  {
+    _tailConvolver.setFadePosition(_fadePosition);
+    if (_tailFadeEnd)
+    {
+      _tailConvolver.endFade();
+      _tailFadeEnd = false;
+    }
+  }
+}
+
+
 void TwoStageFFTConvolver::process(const Sample* input, Sample* output, size_t len)
 {
+  assert(_routeCount == 1);
+  processRoutes(input, &output, len);
+}
+
+
+size_t TwoStageFFTConvolver::getRouteCount() const
+{
+  return _routeCount;
+}
+
+
+void TwoStageFFTConvolver::processRoutes(const Sample* input, Sample* const* outputs, size_t len)
+{
+  if (_headBlockSize == 0)
+  {
+    // Nothing loaded, the stages don't know the routes
+    for (size_t route=0; route<_routeCount; ++route)
+    {
+      ::memset(outputs[route], 0, len * sizeof(Sample));
+    }
+    return;
+  }
+
   // Head
-  _headConvolver.process(input, output, len);
+  _headConvolver.processRoutes(input, outputs, len);
 
   // Tail
   if (_tailInput.size() > 0)
@@ -163,14 +446,18 @@ void TwoStageFFTConvolver::process(const Sample* input, Sample* output, size_t l
       const size_t processing = std::min(remaining, _headBlockSize - (_tailInputFill % _headBlockSize));
       assert(_tailInputFill + processing <= _tailBlockSize);
 
-      // Sum head and tail
+      // Sum head and tail, each route has its own block in the tail buffers
       const size_t sumBegin = processed;
       const size_t sumEnd = processed + processing;
+      for (size_t route=0; route<_routeCount; ++route)
       {
+        Sample* output = outputs[route];
+        const size_t routeOffset = route * _tailBlockSize;
+
         // Sum: 1st tail block
         if (_tailPrecalculated0.size() > 0)
         {      
-          size_t precalculatedPos = _precalculatedPos;
+          size_t precalculatedPos = routeOffset + _precalculatedPos;
           for (size_t i=sumBegin; i<sumEnd; ++i)
           {
             output[i] += _tailPrecalculated0[precalculatedPos];
@@ -181,16 +468,15 @@ void TwoStageFFTConvolver::process(const Sample* input, Sample* output, size_t l
         // Sum: 2nd-Nth tail block
         if (_tailPrecalculated.size() > 0)
         {      
-          size_t precalculatedPos = _precalculatedPos;
+          size_t precalculatedPos = routeOffset + _precalculatedPos;
           for (size_t i=sumBegin; i<sumEnd; ++i)
           {
             output[i] += _tailPrecalculated[precalculatedPos];
             ++precalculatedPos;
           }
         }
-
-        _precalculatedPos += processing;
       }
+      _precalculatedPos += processing;
 
       // Fill input buffer for tail convolution
       ::memcpy(_tailInput.data()+_tailInputFill, input+processed, processing * sizeof(Sample));
@@ -202,7 +488,11 @@ void TwoStageFFTConvolver::process(const Sample* input, Sample* output, size_t l
       {
         assert(_tailInputFill >= _headBlockSize);
         const size_t blockOffset = _tailInputFill - _headBlockSize;
-        _tailConvolver0.process(_tailInput.data()+blockOffset, _tailOutput0.data()+blockOffset, _headBlockSize);
+        for (size_t route=0; route<_routeCount; ++route)
+        {
+          _routeOutputs[route] = _tailOutput0.data() + route * _tailBlockSize + blockOffset;
+        }
+        _tailConvolver0.processRoutes(_tailInput.data()+blockOffset, _routeOutputs.data(), _headBlockSize);
         if (_tailInputFill == _tailBlockSize)
         {          
           SampleBuffer::Swap(_tailPrecalculated0, _tailOutput0);
@@ -213,11 +503,21 @@ void TwoStageFFTConvolver::process(const Sample* input, Sample* output, size_t l
       if (_tailPrecalculated.size() > 0 &&
           _tailInputFill == _tailBlockSize &&
           _backgroundProcessingInput.size() == _tailBlockSize &&
-          _tailOutput.size() == _tailBlockSize)
+          _tailOutput.size() == _tailBlockSize * _routeCount)
       {
         waitForBackgroundProcessing();
         SampleBuffer::Swap(_tailPrecalculated, _tailOutput);
+        if (_tailClearPending)
+        {
+          // Result of input from before clear()
+          _tailPrecalculated.setZero();
+          _tailConvolver.clear();
+          _tailClearPending = false;
+        }
         _backgroundProcessingInput.copyFrom(_tailInput);
+        std::copy(_morphWeights.begin(), _morphWeights.end(), _backgroundMorphWeights.begin());
+        _backgroundDecay = _decay;
+        updateTailFade();
         startBackgroundProcessing();
       }
         
@@ -246,7 +546,15 @@ void TwoStageFFTConvolver::waitForBackgroundProcessing()
 
 void TwoStageFFTConvolver::doBackgroundProcessing()
 {
-  _tailConvolver.process(_backgroundProcessingInput.data(), _tailOutput.data(), _tailBlockSize);
+  // Weights handed over with the input, the processing thread doesn't touch them meanwhile
+  _tailConvolver.setMorphWeights(_backgroundMorphWeights.data(), _backgroundMorphWeights.size());
+  const Sample tailBlock = static_cast<Sample>(_tailBlockSize);
+  _tailConvolver.setSegmentDecay(std::pow(_backgroundDecay, Sample(2.5) * tailBlock), std::pow(_backgroundDecay, tailBlock));
+  for (size_t route=0; route<_routeCount; ++route)
+  {
+    _backgroundRouteOutputs[route] = _tailOutput.data() + route * _tailBlockSize;
+  }
+  _tailConvolver.processRoutes(_backgroundProcessingInput.data(), _backgroundRouteOutputs.data(), _tailBlockSize);
 }
     
 } // End of namespace fftconvolver
@@ -64,6 +64,101 @@ public:
   */
   bool init(size_t headBlockSize, size_t tailBlockSize, const Sample* ir, size_t irLen);
 
+  /**
+  * @brief Initializes the convolver with several impulse responses to morph between
+  *
+  * See FFTConvolver::initMorph(), all stages blend the same impulse responses.
+  *
+  * @param headBlockSize The head block size
+  * @param tailBlockSize the tail block size
+  * @param irs The impulse responses
+  * @param irCount Number of impulse responses
+  * @param irLen Length of each impulse response in samples (shorter ones have to be zero padded)
+  * @return true: Success - false: Failed
+  */
+  bool initMorph(size_t headBlockSize, size_t tailBlockSize, const Sample* const* irs, size_t irCount, size_t irLen);
+
+  /**
+  * @brief Initializes the convolver with several impulse responses each convolved into its own output
+  *
+  * See FFTConvolver::initRoutes(), every stage transforms its input once for all
+  * impulse responses. The outputs are produced by processRoutes().
+  *
+  * @param headBlockSize The head block size
+  * @param tailBlockSize the tail block size
+  * @param irs The impulse responses
+  * @param irCount Number of impulse responses (and outputs)
+  * @param irLen Length of each impulse response in samples (shorter ones have to be zero padded)
+  * @return true: Success - false: Failed
+  */
+  bool initRoutes(size_t headBlockSize, size_t tailBlockSize, const Sample* const* irs, size_t irCount, size_t irLen);
+
+  /**
+  * @brief Sets the weights of the impulse responses loaded with initMorph()
+  *
+  * The head stages pick up new weights at their next block, the background tail
+  * stage at the start of its next background processing (up to one tail block later).
+  */
+  void setMorphWeights(const Sample* weights, size_t count);
+
+  /**
+  * @brief Imposes an exponential decay on the impulse response without recomputing its spectra
+  *
+  * Every segment of every stage is weighted by the decay gain at its center (see
+  * FFTConvolver::setSegmentDecay()), so the decay follows the curve in steps of
+  * the segment sizes. Like the morph weights, the head stages pick up the decay at
+  * their next block and the background tail stage at its next background processing.
+  *
+  * @param gainPerSample Gain per sample of impulse response time (1: no decay)
+  */
+  void setDecay(Sample gainPerSample);
+
+  /**
+  * @brief Returns whether beginFade() would accept the given convolver, see FFTConvolver::canFadeTo()
+  */
+  bool canFadeTo(const TwoStageFFTConvolver& other) const;
+
+  /**
+  * @brief Starts crossfading all stages to the impulse response of another convolver
+  *
+  * See FFTConvolver::beginFade(), the other convolver must have the same block
+  * sizes and is not processed. The background tail stage joins at its next
+  * background processing, so it follows the fade position up to one tail block later.
+  *
+  * @param other The convolver holding the new impulse response
+  * @return true: Success - false: Incompatible convolver, nothing changed
+  */
+  bool beginFade(TwoStageFFTConvolver& other);
+
+  /**
+  * @brief Sets the crossfade position of all stages (0: current - 1: new impulse response)
+  */
+  void setFadePosition(Sample position);
+
+  /**
+  * @brief Ends the crossfade, every stage takes over the new impulse response at its next block
+  *
+  * The other convolver holds the old impulse response once isFading() returns false.
+  */
+  void endFade();
+
+  /**
+  * @brief Returns whether any stage still uses the impulse response of the other convolver
+  */
+  bool isFading() const;
+
+  /**
+  * @brief Initializes the convolver with the impulse response of another convolver
+  *
+  * All stages share the impulse response spectra of the other convolver, e.g. to
+  * convolve two channels with the same impulse response using the memory of one.
+  * See FFTConvolver::initFrom().
+  *
+  * @param other The convolver whose impulse response is shared
+  * @return true: Success - false: Failed
+  */
+  bool initFrom(const TwoStageFFTConvolver& other);
+
   /**
   * @brief Convolves the the given input samples and immediately outputs the result
   * @param input The input samples
@@ -72,15 +167,60 @@ public:
   */
   void process(const Sample* input, Sample* output, size_t len);
 
+  /**
+  * @brief Convolves the given input samples with every impulse response loaded with initRoutes()
+  * @param input The input samples
+  * @param outputs One output per impulse response
+  * @param len Number of input/output samples
+  */
+  void processRoutes(const Sample* input, Sample* const* outputs, size_t len);
+
+  /**
+  * @brief Returns the number of outputs written by processRoutes()
+  */
+  size_t getRouteCount() const;
+
   /**
   * @brief Resets the convolver and discards the set impulse response
   */
   void reset();
 
-  /*
-  * Clears the reverb and its tail while keeping the impulse response
+  /**
+  * @brief Clears the reverb and its tail while keeping the impulse response
+  *
+  * Runs in constant time, see FFTConvolver::clear(). The background tail stage
+  * is not touched while it may be processing, its output is discarded and its
+  * input history cleared at the next hand-over instead.
   */
   void clear();
+
+  /**
+  * @brief Stores the impulse response spectra of all stages in half precision
+  *
+  * Takes effect on the next call of init(), see FFTConvolver::setHalfPrecision().
+  */
+  void setHalfPrecision(bool enabled);
+
+  /**
+  * @brief Lays out all stages for at least len samples of impulse response
+  *
+  * Takes effect on the next call of init(), see FFTConvolver::setInputHistory().
+  */
+  void setInputHistory(size_t len);
+
+  /**
+  * @brief Returns the number of bytes used by the impulse response spectra of all stages
+  */
+  size_t getIRMemoryUsage() const;
+
+  /**
+  * @brief Moves the far tail impulse response segments exceeding a memory budget into a pager
+  *
+  * Only the background tail stage is paged, its segments are consumed outside of
+  * the real-time processing call. Takes effect on the next call of init(), see
+  * FFTConvolver::setSpectraPager().
+  */
+  void setTailSpectraPager(SpectraPager* pager, size_t residentBytes);
   
 protected:
   /**
@@ -106,6 +246,9 @@ protected:
   void doBackgroundProcessing();
 
 private:
+  bool initSets(size_t headBlockSize, size_t tailBlockSize, const Sample* const* irs, size_t irCount, size_t irLen, bool routed);
+  void updateTailFade();
+
   size_t _headBlockSize;
   size_t _tailBlockSize;
   FFTConvolver _headConvolver;
@@ -119,6 +262,20 @@ private:
   size_t _tailInputFill;
   size_t _precalculatedPos;
   SampleBuffer _backgroundProcessingInput;
+  std::vector<Sample> _morphWeights;
+  std::vector<Sample> _backgroundMorphWeights;
+  Sample _decay;
+  Sample _backgroundDecay;
+  Sample _fadePosition;
+  FFTConvolver* _tailFadeSource;
+  bool _tailFadeEnd;
+  bool _tailFading;
+  bool _tailClearPending;
+  size_t _historyLength;
+  bool _routed;
+  size_t _routeCount;
+  std::vector<Sample*> _routeOutputs;
+  std::vector<Sample*> _backgroundRouteOutputs;
 
   // Prevent uncontrolled usage
   TwoStageFFTConvolver(const TwoStageFFTConvolver&);
@@ -17,6 +17,8 @@
 
 #include "Utilities.h"
 
+#include <cmath>
+
 
 namespace fftconvolver
 {
@@ -31,6 +33,184 @@ bool SSEEnabled()
 }
 
 
+bool F16CEnabled()
+{
+#if defined(FFTCONVOLVER_USE_F16C)
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+namespace
+{
+
+HalfSample FloatToHalfScalar(Sample value)
+{
+  uint32_t f;
+  ::memcpy(&f, &value, sizeof(f));
+  const uint32_t sign = (f >> 16) & 0x8000u;
+  const uint32_t absF = f & 0x7FFFFFFFu;
+
+  if (absF >= 0x7F800000u) // Inf or NaN
+  {
+    return static_cast<HalfSample>(sign | 0x7C00u | ((absF > 0x7F800000u) ? 0x200u : 0u));
+  }
+  if (absF >= 0x477FF000u) // Rounds to a value beyond the half range
+  {
+    return static_cast<HalfSample>(sign | 0x7C00u);
+  }
+  if (absF < 0x38800000u) // Subnormal half or zero
+  {
+    if (absF < 0x33000000u)
+    {
+      return static_cast<HalfSample>(sign);
+    }
+    const uint32_t exponent = absF >> 23;
+    const uint32_t mantissa = (absF & 0x7FFFFFu) | 0x800000u;
+    const uint32_t shift = 126u - exponent;
+    uint32_t half = mantissa >> shift;
+    const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+    const uint32_t halfway = 1u << (shift - 1u);
+    if (remainder > halfway || (remainder == halfway && (half & 1u)))
+    {
+      ++half;
+    }
+    return static_cast<HalfSample>(sign | half);
+  }
+
+  uint32_t half = ((absF - 0x38000000u) >> 13);
+  const uint32_t remainder = absF & 0x1FFFu;
+  if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+  {
+    ++half;
+  }
+  return static_cast<HalfSample>(sign | half);
+}
+
+
+Sample HalfToFloatScalar(HalfSample value)
+{
+  const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1Fu;
+  uint32_t mantissa = value & 0x3FFu;
+  uint32_t f;
+
+  if (exponent == 0)
+  {
+    if (mantissa == 0)
+    {
+      f = sign;
+    }
+    else // Subnormal half, normalize
+    {
+      uint32_t e = 113;
+      while ((mantissa & 0x400u) == 0)
+      {
+        mantissa <<= 1;
+        --e;
+      }
+      f = sign | (e << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+  }
+  else if (exponent == 0x1F)
+  {
+    f = sign | 0x7F800000u | (mantissa << 13);
+  }
+  else
+  {
+    f = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+  }
+
+  Sample result;
+  ::memcpy(&result, &f, sizeof(result));
+  return result;
+}
+
+} // End of anonymous namespace
+
+
+void FloatToHalf(HalfSample* FFTCONVOLVER_RESTRICT dest, const Sample* FFTCONVOLVER_RESTRICT src, size_t len)
+{
+#if defined(FFTCONVOLVER_USE_F16C)
+  const size_t end4 = 4 * (len / 4);
+  for (size_t i=0; i<end4; i+=4)
+  {
+    const __m128i half = _mm_cvtps_ph(_mm_loadu_ps(&src[i]), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&dest[i]), half);
+  }
+  for (size_t i=end4; i<len; ++i)
+  {
+    dest[i] = FloatToHalfScalar(src[i]);
+  }
+#else
+  for (size_t i=0; i<len; ++i)
+  {
+    dest[i] = FloatToHalfScalar(src[i]);
+  }
+#endif
+}
+
+
+void HalfToFloat(Sample* FFTCONVOLVER_RESTRICT dest, const HalfSample* FFTCONVOLVER_RESTRICT src, size_t len)
+{
+#if defined(FFTCONVOLVER_USE_F16C)
+  const size_t end4 = 4 * (len / 4);
+  for (size_t i=0; i<end4; i+=4)
+  {
+    const __m128i half = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&src[i]));
+    _mm_storeu_ps(&dest[i], _mm_cvtph_ps(half));
+  }
+  for (size_t i=end4; i<len; ++i)
+  {
+    dest[i] = HalfToFloatScalar(src[i]);
+  }
+#else
+  for (size_t i=0; i<len; ++i)
+  {
+    dest[i] = HalfToFloatScalar(src[i]);
+  }
+#endif
+}
+
+
+void HalfSplitComplex::copyFrom(const SplitComplex& other)
+{
+  assert(_size == other.size());
+  Sample peak = 0;
+  for (size_t i=0; i<_size; ++i)
+  {
+    peak = std::max(peak, std::max(std::fabs(other.re()[i]), std::fabs(other.im()[i])));
+  }
+  _scale = peak;
+  if (peak <= Sample(0))
+  {
+    _re.setZero();
+    _im.setZero();
+    return;
+  }
+
+  // Normalize in chunks so no temporary allocation is required
+  const Sample norm = Sample(1) / peak;
+  Sample chunk[64];
+  for (size_t offset=0; offset<_size; offset+=64)
+  {
+    const size_t len = std::min(size_t(64), _size - offset);
+    for (size_t i=0; i<len; ++i)
+    {
+      chunk[i] = other.re()[offset+i] * norm;
+    }
+    FloatToHalf(_re.data()+offset, chunk, len);
+    for (size_t i=0; i<len; ++i)
+    {
+      chunk[i] = other.im()[offset+i] * norm;
+    }
+    FloatToHalf(_im.data()+offset, chunk, len);
+  }
+}
+
+
 void Sum(Sample* FFTCONVOLVER_RESTRICT result,
          const Sample* FFTCONVOLVER_RESTRICT a,
          const Sample* FFTCONVOLVER_RESTRICT b,
@@ -51,6 +231,22 @@ void Sum(Sample* FFTCONVOLVER_RESTRICT result,
 }
 
 
+void ScaleAccumulate(SplitComplex& result, const SplitComplex& a, Sample scale)
+{
+  assert(result.size() == a.size());
+  Sample* FFTCONVOLVER_RESTRICT re = result.re();
+  Sample* FFTCONVOLVER_RESTRICT im = result.im();
+  const Sample* FFTCONVOLVER_RESTRICT reA = a.re();
+  const Sample* FFTCONVOLVER_RESTRICT imA = a.im();
+  const size_t len = result.size();
+  for (size_t i=0; i<len; ++i)
+  {
+    re[i] += reA[i] * scale;
+    im[i] += imA[i] * scale;
+  }
+}
+
+
 void ComplexMultiplyAccumulate(SplitComplex& result, const SplitComplex& a, const SplitComplex& b)
 {
   assert(result.size() == a.size());
@@ -110,4 +306,96 @@ void ComplexMultiplyAccumulate(Sample* FFTCONVOLVER_RESTRICT re,
 #endif
 }
 
+
+void ComplexMultiplyAccumulate(SplitComplex& result, const SplitComplex& a, const SplitComplex& b, Sample gain)
+{
+  assert(result.size() == a.size());
+  assert(result.size() == b.size());
+  ComplexMultiplyAccumulate(result.re(), result.im(), a.re(), a.im(), b.re(), b.im(), result.size(), gain);
+}
+
+
+void ComplexMultiplyAccumulate(Sample* FFTCONVOLVER_RESTRICT re,
+                               Sample* FFTCONVOLVER_RESTRICT im,
+                               const Sample* FFTCONVOLVER_RESTRICT reA,
+                               const Sample* FFTCONVOLVER_RESTRICT imA,
+                               const Sample* FFTCONVOLVER_RESTRICT reB,
+                               const Sample* FFTCONVOLVER_RESTRICT imB,
+                               const size_t len,
+                               Sample gain)
+{
+  if (gain == Sample(1.0))
+  {
+    ComplexMultiplyAccumulate(re, im, reA, imA, reB, imB, len);
+    return;
+  }
+  for (size_t i=0; i<len; ++i)
+  {
+    const Sample ra = gain * reA[i];
+    const Sample ia = gain * imA[i];
+    re[i] += ra * reB[i] - ia * imB[i];
+    im[i] += ra * imB[i] + ia * reB[i];
+  }
+}
+
+
+void ComplexMultiplyAccumulate(SplitComplex& result, const HalfSplitComplex& a, const SplitComplex& b, Sample gain)
+{
+  assert(result.size() == a.size());
+  assert(result.size() == b.size());
+  Sample* FFTCONVOLVER_RESTRICT re = result.re();
+  Sample* FFTCONVOLVER_RESTRICT im = result.im();
+  const HalfSample* FFTCONVOLVER_RESTRICT reA = a.re();
+  const HalfSample* FFTCONVOLVER_RESTRICT imA = a.im();
+  const Sample* FFTCONVOLVER_RESTRICT reB = b.re();
+  const Sample* FFTCONVOLVER_RESTRICT imB = b.im();
+  const Sample scale = a.scale() * gain;
+  const size_t len = result.size();
+
+#if defined(FFTCONVOLVER_USE_F16C)
+  const __m128 s = _mm_set1_ps(scale);
+  const size_t end4 = 4 * (len / 4);
+  for (size_t i=0; i<end4; i+=4)
+  {
+    const __m128 ra = _mm_mul_ps(s, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&reA[i]))));
+    const __m128 ia = _mm_mul_ps(s, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&imA[i]))));
+    const __m128 rb = _mm_load_ps(&reB[i]);
+    const __m128 ib = _mm_load_ps(&imB[i]);
+    __m128 real = _mm_load_ps(&re[i]);
+    __m128 imag = _mm_load_ps(&im[i]);
+    real = _mm_add_ps(real, _mm_mul_ps(ra, rb));
+    real = _mm_sub_ps(real, _mm_mul_ps(ia, ib));
+    _mm_store_ps(&re[i], real);
+    imag = _mm_add_ps(imag, _mm_mul_ps(ra, ib));
+    imag = _mm_add_ps(imag, _mm_mul_ps(ia, rb));
+    _mm_store_ps(&im[i], imag);
+  }
+  for (size_t i=end4; i<len; ++i)
+  {
+    const Sample ra = scale * HalfToFloatScalar(reA[i]);
+    const Sample ia = scale * HalfToFloatScalar(imA[i]);
+    re[i] += ra * reB[i] - ia * imB[i];
+    im[i] += ra * imB[i] + ia * reB[i];
+  }
+#else
+  // Convert in small chunks that stay in L1 and reuse the full precision kernel
+  Sample chunkRe[64];
+  Sample chunkIm[64];
+  for (size_t offset=0; offset<len; offset+=64)
+  {
+    const size_t n = std::min(size_t(64), len - offset);
+    for (size_t i=0; i<n; ++i)
+    {
+      chunkRe[i] = scale * HalfToFloatScalar(reA[offset+i]);
+      chunkIm[i] = scale * HalfToFloatScalar(imA[offset+i]);
+    }
+    for (size_t i=0; i<n; ++i)
+    {
+      re[offset+i] += chunkRe[i] * reB[offset+i] - chunkIm[i] * imB[offset+i];
+      im[offset+i] += chunkRe[i] * imB[offset+i] + chunkIm[i] * reB[offset+i];
+    }
+  }
+#endif
+}
+
 } // End of namespace fftconvolver
@@ -35,6 +35,18 @@
   #include <xmmintrin.h>
 #endif
 
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+  #if !defined(FFTCONVOLVER_USE_F16C) && !defined(FFTCONVOLVER_DONT_USE_F16C)
+    #define FFTCONVOLVER_USE_F16C
+  #endif
+#endif
+
+#if defined (FFTCONVOLVER_USE_F16C)
+  #include <immintrin.h>
+#endif
+
+#include <cstdint>
+
 namespace fftconvolver
 {
 #if defined(__GNUC__)
@@ -51,6 +63,13 @@ namespace fftconvolver
 bool SSEEnabled();
 
 
+/**
+* @brief Returns whether F16C conversions are used for half precision buffers
+* @return true: Enabled - false: Disabled (portable scalar conversion is used)
+*/
+bool F16CEnabled();
+
+
 /**
 * @class Buffer
 * @brief Simple buffer implementation (uses 16-byte alignment if SSE optimization is enabled)
@@ -272,6 +291,102 @@ private:
 };
 
 
+/**
+* @brief Type of one half precision (IEEE 754 binary16) sample
+*/
+typedef uint16_t HalfSample;
+
+
+/**
+* @brief Buffer for half precision samples
+*/
+typedef Buffer<HalfSample> HalfSampleBuffer;
+
+
+/**
+* @class HalfSplitComplex
+* @brief Half precision storage of a split-complex buffer
+*
+* Values are stored normalized to the peak magnitude of the buffer together with
+* a single float scale (block floating point), so the 11 bit mantissa of the
+* half type is always used at full range regardless of the spectrum level.
+*/
+class HalfSplitComplex
+{
+public:
+  explicit HalfSplitComplex(size_t initialSize = 0) :
+    _size(0),
+    _scale(0),
+    _re(),
+    _im()
+  {
+    resize(initialSize);
+  }
+
+  void resize(size_t newSize)
+  {
+    _re.resize(newSize);
+    _im.resize(newSize);
+    _size = newSize;
+    _scale = 0;
+  }
+
+  /**
+  * @brief Stores a full precision split-complex buffer
+  * @param other The buffer to convert, must have the same size
+  */
+  void copyFrom(const SplitComplex& other);
+
+  const HalfSample* re() const
+  {
+    return _re.data();
+  }
+
+  const HalfSample* im() const
+  {
+    return _im.data();
+  }
+
+  Sample scale() const
+  {
+    return _scale;
+  }
+
+  size_t size() const
+  {
+    return _size;
+  }
+
+private:
+  size_t _size;
+  Sample _scale;
+  HalfSampleBuffer _re;
+  HalfSampleBuffer _im;
+
+  // Prevent uncontrolled usage
+  HalfSplitComplex(const HalfSplitComplex&);
+  HalfSplitComplex& operator=(const HalfSplitComplex&);
+};
+
+
+/**
+* @brief Converts full precision samples to half precision (round to nearest even)
+* @param dest The half precision destination array
+* @param src The full precision source array
+* @param len The length of the arrays
+*/
+void FloatToHalf(HalfSample* FFTCONVOLVER_RESTRICT dest, const Sample* FFTCONVOLVER_RESTRICT src, size_t len);
+
+
+/**
+* @brief Converts half precision samples to full precision
+* @param dest The full precision destination array
+* @param src The half precision source array
+* @param len The length of the arrays
+*/
+void HalfToFloat(Sample* FFTCONVOLVER_RESTRICT dest, const HalfSample* FFTCONVOLVER_RESTRICT src, size_t len);
+
+
 /**
 * @brief Returns the next power of 2 of a given number
 * @param val The number
@@ -302,6 +417,15 @@ void Sum(Sample* FFTCONVOLVER_RESTRICT result,
          size_t len);
 
 
+/**
+* @brief Adds a scaled split-complex buffer to a result buffer (result += a * scale)
+* @param result The result buffer
+* @param a The buffer to add
+* @param scale The real valued factor applied to a
+*/
+void ScaleAccumulate(SplitComplex& result, const SplitComplex& a, Sample scale);
+
+
 /**
 * @brief Copies a source array into a destination buffer and pads the destination buffer with zeros
 * @param dest The destination buffer
@@ -326,6 +450,30 @@ void CopyAndPad(Buffer<T>& dest, const T* src, size_t srcSize)
 void ComplexMultiplyAccumulate(SplitComplex& result, const SplitComplex& a, const SplitComplex& b);
 
 
+/**
+* @brief Adds the scaled complex product of two split-complex buffers to a result buffer
+* @param result The result buffer
+* @param a The 1st factor of the complex product
+* @param b The 2nd factor of the complex product
+* @param gain Real valued factor applied to the product
+*/
+void ComplexMultiplyAccumulate(SplitComplex& result, const SplitComplex& a, const SplitComplex& b, Sample gain);
+
+
+/**
+* @brief Adds the complex product of a half precision and a full precision buffer to a result buffer
+*
+* The half precision factor is converted on the fly (F16C if available) and
+* multiplied by its block scale, no temporary full precision copy is needed.
+*
+* @param result The result buffer
+* @param a The half precision factor of the complex product
+* @param b The full precision factor of the complex product
+* @param gain Real valued factor applied to the product
+*/
+void ComplexMultiplyAccumulate(SplitComplex& result, const HalfSplitComplex& a, const SplitComplex& b, Sample gain = Sample(1.0));
+
+
 /**
 * @brief Adds the complex product of two split-complex arrays to a result array
 * @param re The real part of the result buffer
@@ -343,6 +491,21 @@ void ComplexMultiplyAccumulate(Sample* FFTCONVOLVER_RESTRICT re,
                                const Sample* FFTCONVOLVER_RESTRICT imB,
                                const size_t len);
 
+
+/**
+* @brief Adds the scaled complex product of two split-complex arrays to a result array
+*
+* Same as the unscaled version with every product multiplied by gain.
+*/
+void ComplexMultiplyAccumulate(Sample* FFTCONVOLVER_RESTRICT re,
+                               Sample* FFTCONVOLVER_RESTRICT im,
+                               const Sample* FFTCONVOLVER_RESTRICT reA,
+                               const Sample* FFTCONVOLVER_RESTRICT imA,
+                               const Sample* FFTCONVOLVER_RESTRICT reB,
+                               const Sample* FFTCONVOLVER_RESTRICT imB,
+                               const size_t len,
+                               Sample gain);
+
 } // End of namespace fftconvolver
 
 #endif // Header guard
@@ -243,11 +243,693 @@ static bool TestTwoStageConvolver(size_t inputSize,
 }
 
 
+static bool TestHalfPrecisionConvolver(size_t inputSize,
+                                       size_t irSize,
+                                       size_t blockSize,
+                                       size_t blockSizeHead,
+                                       size_t blockSizeTail)
+{
+  // Noise input and an exponentially decaying noise IR (-60dB over its length)
+  std::vector<fftconvolver::Sample> in(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    in[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+
+  std::vector<fftconvolver::Sample> ir(irSize);
+  for (size_t i=0; i<irSize; ++i)
+  {
+    const double env = ::pow(10.0, -3.0 * static_cast<double>(i) / static_cast<double>(irSize));
+    const double noise = 2.0 * static_cast<double>(rand()) / static_cast<double>(RAND_MAX) - 1.0;
+    ir[i] = static_cast<fftconvolver::Sample>(0.1 * env * noise);
+  }
+
+  std::vector<fftconvolver::Sample> outFull(in.size() + ir.size() - 1, fftconvolver::Sample(0.0));
+  std::vector<fftconvolver::Sample> outHalf(in.size() + ir.size() - 1, fftconvolver::Sample(0.0));
+  std::vector<fftconvolver::Sample> inBuf(blockSize);
+  size_t memoryFull = 0;
+  size_t memoryHalf = 0;
+
+  for (int pass=0; pass<2; ++pass)
+  {
+    const bool half = (pass == 1);
+    std::vector<fftconvolver::Sample>& out = half ? outHalf : outFull;
+    fftconvolver::TwoStageFFTConvolver convolver;
+    convolver.setHalfPrecision(half);
+    convolver.init(blockSizeHead, blockSizeTail, &ir[0], ir.size());
+    (half ? memoryHalf : memoryFull) = convolver.getIRMemoryUsage();
+
+    size_t processed = 0;
+    while (processed < out.size())
+    {
+      const size_t processing = std::min(blockSize, out.size() - processed);
+      memset(&inBuf[0], 0, inBuf.size() * sizeof(fftconvolver::Sample));
+      if (processed < in.size())
+      {
+        memcpy(&inBuf[0], &in[processed], std::min(processing, in.size() - processed) * sizeof(fftconvolver::Sample));
+      }
+      convolver.process(&inBuf[0], &out[processed], processing);
+      processed += processing;
+    }
+  }
+
+  double peak = 0.0;
+  double maxError = 0.0;
+  double signalEnergy = 0.0;
+  double errorEnergy = 0.0;
+  for (size_t i=0; i<outFull.size(); ++i)
+  {
+    const double a = static_cast<double>(outFull[i]);
+    const double e = static_cast<double>(outHalf[i]) - a;
+    peak = std::max(peak, ::fabs(a));
+    maxError = std::max(maxError, ::fabs(e));
+    signalEnergy += a * a;
+    errorEnergy += e * e;
+  }
+
+  const double maxErrorDb = 20.0 * ::log10(std::max(maxError, 1e-30) / std::max(peak, 1e-30));
+  const double snrDb = 10.0 * ::log10(std::max(signalEnergy, 1e-30) / std::max(errorEnergy, 1e-30));
+  const bool ok = (maxErrorDb < -60.0 && snrDb > 60.0);
+  printf("Half Precision Accuracy (IR %d, blocksize %d, head %d, tail %d) => peak error %.1fdB, SNR %.1fdB, IR memory %d -> %d bytes %s\n",
+         static_cast<int>(irSize), static_cast<int>(blockSize), static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail),
+         maxErrorDb, snrDb, static_cast<int>(memoryFull), static_cast<int>(memoryHalf), ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
+// Spectra pager keeping the paged segments in one aligned buffer, checks the fetch order
+class TestSpectraPager : public fftconvolver::SpectraPager
+{
+public:
+  TestSpectraPager() : _complexSize(0), _first(0), _count(0), _expected(0), _fetches(0), _orderOk(true), _data() {}
+
+  virtual bool beginStore(size_t complexSize, size_t firstSegment, size_t segmentCount)
+  {
+    _complexSize = complexSize;
+    _first = firstSegment;
+    _count = segmentCount;
+    _expected = firstSegment;
+    _data.resize(2 * Stride() * segmentCount);
+    return true;
+  }
+
+  virtual void store(size_t segment, const fftconvolver::Sample* re, const fftconvolver::Sample* im)
+  {
+    fftconvolver::Sample* dest = _data.data() + 2 * Stride() * (segment - _first);
+    memcpy(dest, re, _complexSize * sizeof(fftconvolver::Sample));
+    memcpy(dest + Stride(), im, _complexSize * sizeof(fftconvolver::Sample));
+  }
+
+  virtual bool endStore()
+  {
+    return true;
+  }
+
+  virtual bool fetch(size_t segment, const fftconvolver::Sample*& re, const fftconvolver::Sample*& im)
+  {
+    _orderOk = _orderOk && (segment == _expected);
+    _expected = (segment + 1 < _first + _count) ? (segment + 1) : _first;
+    ++_fetches;
+    re = _data.data() + 2 * Stride() * (segment - _first);
+    im = re + Stride();
+    return true;
+  }
+
+  virtual void release(size_t)
+  {
+  }
+
+  size_t pagedSegments() const { return _count; }
+  size_t fetches() const { return _fetches; }
+  bool orderOk() const { return _orderOk; }
+
+private:
+  size_t Stride() const { return 4 * ((_complexSize + 3) / 4); }
+
+  size_t _complexSize;
+  size_t _first;
+  size_t _count;
+  size_t _expected;
+  size_t _fetches;
+  bool _orderOk;
+  fftconvolver::SampleBuffer _data;
+};
+
+
+static bool TestPagedConvolver(size_t inputSize,
+                               size_t irSize,
+                               size_t blockSize,
+                               size_t blockSizeHead,
+                               size_t blockSizeTail,
+                               size_t residentBytes,
+                               bool halfPrecision)
+{
+  std::vector<fftconvolver::Sample> in(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    in[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+
+  std::vector<fftconvolver::Sample> ir(irSize);
+  for (size_t i=0; i<irSize; ++i)
+  {
+    ir[i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+  }
+
+  std::vector<fftconvolver::Sample> outMemory(in.size() + ir.size() - 1, fftconvolver::Sample(0.0));
+  std::vector<fftconvolver::Sample> outPaged(in.size() + ir.size() - 1, fftconvolver::Sample(0.0));
+  std::vector<fftconvolver::Sample> inBuf(blockSize);
+  TestSpectraPager pager;
+  size_t memoryFull = 0;
+  size_t memoryPaged = 0;
+
+  for (int pass=0; pass<2; ++pass)
+  {
+    const bool paged = (pass == 1);
+    std::vector<fftconvolver::Sample>& out = paged ? outPaged : outMemory;
+    fftconvolver::TwoStageFFTConvolver convolver;
+    convolver.setHalfPrecision(halfPrecision);
+    convolver.setTailSpectraPager(paged ? &pager : nullptr, residentBytes);
+    convolver.init(blockSizeHead, blockSizeTail, &ir[0], ir.size());
+    (paged ? memoryPaged : memoryFull) = convolver.getIRMemoryUsage();
+
+    size_t processed = 0;
+    while (processed < out.size())
+    {
+      const size_t processing = std::min(blockSize, out.size() - processed);
+      memset(&inBuf[0], 0, inBuf.size() * sizeof(fftconvolver::Sample));
+      if (processed < in.size())
+      {
+        memcpy(&inBuf[0], &in[processed], std::min(processing, in.size() - processed) * sizeof(fftconvolver::Sample));
+      }
+      convolver.process(&inBuf[0], &out[processed], processing);
+      processed += processing;
+    }
+  }
+
+  // Paging must not change a single bit of the output
+  const bool identical = (memcmp(&outMemory[0], &outPaged[0], outMemory.size() * sizeof(fftconvolver::Sample)) == 0);
+  const bool ok = identical && pager.orderOk() && pager.pagedSegments() > 0 && pager.fetches() > 0 && memoryPaged <= memoryFull;
+  printf("Paged Spectra (IR %d, blocksize %d, head %d, tail %d, %s) => %d segments paged, resident IR memory %d -> %d bytes %s\n",
+         static_cast<int>(irSize), static_cast<int>(blockSize), static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail),
+         halfPrecision ? "half" : "full", static_cast<int>(pager.pagedSegments()),
+         static_cast<int>(memoryFull), static_cast<int>(memoryPaged), ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
+static bool TestSharedConvolver(size_t inputSize,
+                                size_t irSize,
+                                size_t blockSize,
+                                size_t blockSizeHead,
+                                size_t blockSizeTail)
+{
+  std::vector<fftconvolver::Sample> inL(inputSize);
+  std::vector<fftconvolver::Sample> inR(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    inL[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+    inR[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+
+  std::vector<fftconvolver::Sample> ir(irSize);
+  for (size_t i=0; i<irSize; ++i)
+  {
+    ir[i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+  }
+
+  // Right channel once with its own IR spectra and once sharing the spectra of the left channel
+  fftconvolver::TwoStageFFTConvolver left;
+  fftconvolver::TwoStageFFTConvolver rightOwn;
+  fftconvolver::TwoStageFFTConvolver rightShared;
+  left.init(blockSizeHead, blockSizeTail, &ir[0], ir.size());
+  rightOwn.init(blockSizeHead, blockSizeTail, &ir[0], ir.size());
+  const bool shared = rightShared.initFrom(left);
+
+  std::vector<fftconvolver::Sample> outL(blockSize);
+  std::vector<fftconvolver::Sample> outOwn(inputSize);
+  std::vector<fftconvolver::Sample> outShared(inputSize);
+  size_t processed = 0;
+  while (processed < inputSize)
+  {
+    const size_t processing = std::min(blockSize, inputSize - processed);
+    left.process(&inL[processed], &outL[0], processing);
+    rightOwn.process(&inR[processed], &outOwn[processed], processing);
+    rightShared.process(&inR[processed], &outShared[processed], processing);
+    processed += processing;
+  }
+
+  const bool identical = (memcmp(&outOwn[0], &outShared[0], inputSize * sizeof(fftconvolver::Sample)) == 0);
+  const bool ok = shared && identical && rightShared.getIRMemoryUsage() == 0;
+  printf("Shared Spectra (IR %d, blocksize %d, head %d, tail %d) => IR memory %d + %d bytes %s\n",
+         static_cast<int>(irSize), static_cast<int>(blockSize), static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail),
+         static_cast<int>(left.getIRMemoryUsage()), static_cast<int>(rightShared.getIRMemoryUsage()), ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
+static bool TestMorphConvolver(size_t inputSize,
+                               size_t irSize,
+                               size_t irCount,
+                               size_t blockSize,
+                               size_t blockSizeHead,
+                               size_t blockSizeTail)
+{
+  std::vector<fftconvolver::Sample> in(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    in[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+
+  // Impulse responses of different lengths, zero padded to the longest one
+  std::vector<std::vector<fftconvolver::Sample>> irs(irCount, std::vector<fftconvolver::Sample>(irSize, fftconvolver::Sample(0.0)));
+  std::vector<const fftconvolver::Sample*> irPtrs(irCount);
+  std::vector<fftconvolver::Sample> weights(irCount);
+  for (size_t k=0; k<irCount; ++k)
+  {
+    const size_t len = irSize - k * (irSize / (2 * irCount));
+    for (size_t i=0; i<len; ++i)
+    {
+      irs[k][i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+    }
+    irPtrs[k] = &irs[k][0];
+    weights[k] = (k == 1) ? fftconvolver::Sample(0.0) : static_cast<fftconvolver::Sample>(k+1);
+  }
+
+  // Reference: one convolver per impulse response, outputs summed with the weights
+  std::vector<fftconvolver::Sample> outRef(inputSize, fftconvolver::Sample(0.0));
+  std::vector<fftconvolver::Sample> outSingle(inputSize);
+  for (size_t k=0; k<irCount; ++k)
+  {
+    fftconvolver::TwoStageFFTConvolver single;
+    single.init(blockSizeHead, blockSizeTail, irPtrs[k], irSize);
+    for (size_t processed=0; processed<inputSize; processed+=blockSize)
+    {
+      single.process(&in[processed], &outSingle[processed], std::min(blockSize, inputSize - processed));
+    }
+    for (size_t i=0; i<inputSize; ++i)
+    {
+      outRef[i] += weights[k] * outSingle[i];
+    }
+  }
+
+  // Morphing convolver, default weights first must be identical to the first impulse response alone
+  fftconvolver::TwoStageFFTConvolver morph;
+  fftconvolver::TwoStageFFTConvolver first;
+  morph.initMorph(blockSizeHead, blockSizeTail, &irPtrs[0], irCount, irSize);
+  first.init(blockSizeHead, blockSizeTail, irPtrs[0], irSize);
+  std::vector<fftconvolver::Sample> outMorph(inputSize);
+  std::vector<fftconvolver::Sample> outFirst(inputSize);
+  const size_t half = (inputSize / 2 / blockSize) * blockSize;
+  for (size_t processed=0; processed<half; processed+=blockSize)
+  {
+    morph.process(&in[processed], &outMorph[processed], blockSize);
+    first.process(&in[processed], &outFirst[processed], blockSize);
+  }
+  const bool defaultIdentical = (memcmp(&outMorph[0], &outFirst[0], half * sizeof(fftconvolver::Sample)) == 0);
+
+  // Then the weighted blend, compared after the weights reached all stages
+  morph.clear();
+  morph.setMorphWeights(&weights[0], weights.size());
+  for (size_t processed=0; processed<inputSize; processed+=blockSize)
+  {
+    morph.process(&in[processed], &outMorph[processed], std::min(blockSize, inputSize - processed));
+  }
+  double maxError = 0.0;
+  double peak = 0.0;
+  for (size_t i=2*blockSizeTail; i<inputSize; ++i)
+  {
+    maxError = std::max(maxError, ::fabs(static_cast<double>(outMorph[i]) - static_cast<double>(outRef[i])));
+    peak = std::max(peak, ::fabs(static_cast<double>(outRef[i])));
+  }
+
+  const bool ok = defaultIdentical && maxError < 1e-4 * peak;
+  printf("Morph Test (IRs %d x %d, blocksize %d, head %d, tail %d) => max error %.3g, IR memory %d bytes %s\n",
+         static_cast<int>(irCount), static_cast<int>(irSize), static_cast<int>(blockSize), static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail),
+         peak > 0.0 ? maxError / peak : 0.0, static_cast<int>(morph.getIRMemoryUsage()), ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
+static bool TestDecayConvolver(size_t inputSize,
+                               size_t irSize,
+                               size_t blockSize,
+                               size_t blockSizeHead,
+                               size_t blockSizeTail,
+                               double decaySeconds)
+{
+  std::vector<fftconvolver::Sample> in(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    in[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+
+  // -60dB after decaySeconds at 44.1kHz
+  const fftconvolver::Sample gain = static_cast<fftconvolver::Sample>(::pow(10.0, -3.0 / (decaySeconds * 44100.0)));
+
+  // Reference: impulse response weighted with the stepped gains of the segments
+  std::vector<fftconvolver::Sample> ir(irSize);
+  std::vector<fftconvolver::Sample> irWeighted(irSize);
+  for (size_t i=0; i<irSize; ++i)
+  {
+    ir[i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+    double center = 0.0;
+    if (i < blockSizeTail)
+    {
+      center = (static_cast<double>(i / blockSizeHead) + 0.5) * blockSizeHead;
+    }
+    else if (i < 2 * blockSizeTail)
+    {
+      center = blockSizeTail + (static_cast<double>((i - blockSizeTail) / blockSizeHead) + 0.5) * blockSizeHead;
+    }
+    else
+    {
+      center = 2.0 * blockSizeTail + (static_cast<double>((i - 2 * blockSizeTail) / blockSizeTail) + 0.5) * blockSizeTail;
+    }
+    irWeighted[i] = ir[i] * static_cast<fftconvolver::Sample>(::pow(static_cast<double>(gain), center));
+  }
+  std::vector<fftconvolver::Sample> outRef(inputSize + irSize - 1);
+  SimpleConvolve(&in[0], in.size(), &irWeighted[0], irWeighted.size(), &outRef[0]);
+
+  fftconvolver::TwoStageFFTConvolver convolver;
+  convolver.init(blockSizeHead, blockSizeTail, &ir[0], ir.size());
+  convolver.setDecay(gain);
+  std::vector<fftconvolver::Sample> out(inputSize);
+  for (size_t processed=0; processed<inputSize; processed+=blockSize)
+  {
+    convolver.process(&in[processed], &out[processed], std::min(blockSize, inputSize - processed));
+  }
+
+  double maxError = 0.0;
+  double peak = 0.0;
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    maxError = std::max(maxError, ::fabs(static_cast<double>(out[i]) - static_cast<double>(outRef[i])));
+    peak = std::max(peak, ::fabs(static_cast<double>(outRef[i])));
+  }
+
+  const bool ok = maxError < 1e-4 * peak;
+  printf("Decay Test (IR %d, blocksize %d, head %d, tail %d, decay %.2fs) => max error %.3g %s\n",
+         static_cast<int>(irSize), static_cast<int>(blockSize), static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail),
+         decaySeconds, peak > 0.0 ? maxError / peak : 0.0, ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
+static bool TestFadeConvolver(size_t inputSize,
+                              size_t irSize,
+                              size_t newIrSize,
+                              size_t blockSize,
+                              size_t blockSizeHead,
+                              size_t blockSizeTail)
+{
+  std::vector<fftconvolver::Sample> in(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    in[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+  std::vector<fftconvolver::Sample> ir(irSize);
+  for (size_t i=0; i<irSize; ++i)
+  {
+    ir[i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+  }
+  std::vector<fftconvolver::Sample> newIr(newIrSize);
+  for (size_t i=0; i<newIrSize; ++i)
+  {
+    newIr[i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+  }
+
+  // References: each impulse response over the whole input
+  std::vector<fftconvolver::Sample> outOld(inputSize + irSize - 1);
+  std::vector<fftconvolver::Sample> outNew(inputSize + newIrSize - 1);
+  SimpleConvolve(&in[0], in.size(), &ir[0], ir.size(), &outOld[0]);
+  SimpleConvolve(&in[0], in.size(), &newIr[0], newIr.size(), &outNew[0]);
+
+  fftconvolver::TwoStageFFTConvolver convolver;
+  fftconvolver::TwoStageFFTConvolver loader;
+  convolver.setInputHistory(newIrSize); // Longer impulse responses need the input history
+  convolver.init(blockSizeHead, blockSizeTail, &ir[0], ir.size());
+  loader.init(blockSizeHead, blockSizeTail, &newIr[0], newIr.size());
+  const size_t oldMemory = convolver.getIRMemoryUsage();
+  const size_t newMemory = loader.getIRMemoryUsage();
+
+  // Old impulse response, then a fade of 8 blocks, then the new one only
+  const size_t fadeStart = (inputSize / 4 / blockSize) * blockSize;
+  const size_t fadeLen = 8 * blockSize;
+  std::vector<fftconvolver::Sample> out(inputSize);
+  size_t fadeEnd = inputSize;
+  bool started = false;
+  for (size_t processed=0; processed<inputSize; processed+=blockSize)
+  {
+    if (processed == fadeStart)
+    {
+      started = convolver.beginFade(loader);
+    }
+    if (processed >= fadeStart && processed < fadeStart + fadeLen)
+    {
+      convolver.setFadePosition(static_cast<fftconvolver::Sample>(processed + blockSize - fadeStart) / static_cast<fftconvolver::Sample>(fadeLen));
+    }
+    if (processed == fadeStart + fadeLen)
+    {
+      convolver.endFade();
+    }
+    if (processed > fadeStart + fadeLen && fadeEnd == inputSize && !convolver.isFading())
+    {
+      fadeEnd = processed;
+      loader.reset(); // Releases the old impulse response
+    }
+    convolver.process(&in[processed], &out[processed], std::min(blockSize, inputSize - processed));
+  }
+
+  double errorBefore = 0.0;
+  double errorAfter = 0.0;
+  double peak = 0.0;
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    peak = std::max(peak, ::fabs(static_cast<double>(outOld[i])));
+    if (i < fadeStart)
+    {
+      errorBefore = std::max(errorBefore, ::fabs(static_cast<double>(out[i]) - static_cast<double>(outOld[i])));
+    }
+    else if (i >= fadeEnd + blockSizeTail)
+    {
+      errorAfter = std::max(errorAfter, ::fabs(static_cast<double>(out[i]) - static_cast<double>(outNew[i])));
+    }
+  }
+
+  const bool ok = started && fadeEnd < inputSize && errorBefore < 1e-4 * peak && errorAfter < 1e-4 * peak && convolver.getIRMemoryUsage() == newMemory;
+  printf("Fade Test (IR %d -> %d, blocksize %d, head %d, tail %d) => error before %.3g, after %.3g, IR memory %d -> %d bytes %s\n",
+         static_cast<int>(irSize), static_cast<int>(newIrSize), static_cast<int>(blockSize), static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail),
+         peak > 0.0 ? errorBefore / peak : 0.0, peak > 0.0 ? errorAfter / peak : 0.0,
+         static_cast<int>(oldMemory), static_cast<int>(convolver.getIRMemoryUsage()), ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
+static bool TestClearConvolver(size_t inputSize,
+                               size_t irSize,
+                               size_t blockSize,
+                               size_t blockSizeHead,
+                               size_t blockSizeTail)
+{
+  std::vector<fftconvolver::Sample> in(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    in[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+  std::vector<fftconvolver::Sample> ir(irSize);
+  for (size_t i=0; i<irSize; ++i)
+  {
+    ir[i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+  }
+
+  // Cleared in the middle of the head and tail blocks, afterwards only the new input is heard
+  const size_t clearPos = (inputSize / 3 / blockSize) * blockSize;
+  const size_t remaining = inputSize - clearPos;
+  std::vector<fftconvolver::Sample> outRef(remaining + irSize - 1);
+  SimpleConvolve(&in[clearPos], remaining, &ir[0], ir.size(), &outRef[0]);
+
+  fftconvolver::TwoStageFFTConvolver convolver;
+  convolver.init(blockSizeHead, blockSizeTail, &ir[0], ir.size());
+  std::vector<fftconvolver::Sample> out(inputSize);
+  for (size_t processed=0; processed<inputSize; processed+=blockSize)
+  {
+    if (processed == clearPos)
+    {
+      convolver.clear();
+    }
+    convolver.process(&in[processed], &out[processed], std::min(blockSize, inputSize - processed));
+  }
+
+  double maxError = 0.0;
+  double peak = 0.0;
+  for (size_t i=0; i<remaining; ++i)
+  {
+    maxError = std::max(maxError, ::fabs(static_cast<double>(out[clearPos+i]) - static_cast<double>(outRef[i])));
+    peak = std::max(peak, ::fabs(static_cast<double>(outRef[i])));
+  }
+
+  const bool ok = maxError < 1e-4 * peak;
+  printf("Clear Test (IR %d, blocksize %d, head %d, tail %d, cleared at %d) => max error %.3g %s\n",
+         static_cast<int>(irSize), static_cast<int>(blockSize), static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail),
+         static_cast<int>(clearPos), peak > 0.0 ? maxError / peak : 0.0, ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
+static bool TestRoutedConvolver(size_t inputSize,
+                                size_t irSize,
+                                size_t routeCount,
+                                size_t blockSize,
+                                size_t blockSizeHead,
+                                size_t blockSizeTail)
+{
+  std::vector<fftconvolver::Sample> in(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    in[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+
+  // Routes of different lengths, the last one is silent
+  std::vector<std::vector<fftconvolver::Sample>> irs(routeCount, std::vector<fftconvolver::Sample>(irSize, 0.0f));
+  std::vector<const fftconvolver::Sample*> irPtrs(routeCount);
+  for (size_t r=0; r<routeCount; ++r)
+  {
+    const size_t len = (r + 1 == routeCount) ? 0 : irSize / (r + 1);
+    for (size_t i=0; i<len; ++i)
+    {
+      irs[r][i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+    }
+    irPtrs[r] = irs[r].data();
+  }
+
+  fftconvolver::TwoStageFFTConvolver convolver;
+  convolver.initRoutes(blockSizeHead, blockSizeTail, irPtrs.data(), routeCount, irSize);
+
+  std::vector<std::vector<fftconvolver::Sample>> out(routeCount, std::vector<fftconvolver::Sample>(inputSize));
+  std::vector<fftconvolver::Sample*> outPtrs(routeCount);
+  for (size_t processed=0; processed<inputSize; processed+=blockSize)
+  {
+    for (size_t r=0; r<routeCount; ++r)
+    {
+      outPtrs[r] = &out[r][processed];
+    }
+    convolver.processRoutes(&in[processed], outPtrs.data(), std::min(blockSize, inputSize - processed));
+  }
+
+  // Every route against its own reference
+  double maxError = 0.0;
+  double peak = 0.0;
+  std::vector<fftconvolver::Sample> outRef(inputSize + irSize - 1);
+  for (size_t r=0; r<routeCount; ++r)
+  {
+    SimpleConvolve(&in[0], in.size(), &irs[r][0], irs[r].size(), &outRef[0]);
+    for (size_t i=0; i<inputSize; ++i)
+    {
+      maxError = std::max(maxError, ::fabs(static_cast<double>(out[r][i]) - static_cast<double>(outRef[i])));
+      peak = std::max(peak, ::fabs(static_cast<double>(outRef[i])));
+    }
+  }
+
+  const bool ok = convolver.getRouteCount() == routeCount && maxError < 1e-4 * peak;
+  printf("Routed Test (IR %d, routes %d, blocksize %d, head %d, tail %d) => max error %.3g %s\n",
+         static_cast<int>(irSize), static_cast<int>(routeCount), static_cast<int>(blockSize), static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail),
+         peak > 0.0 ? maxError / peak : 0.0, ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
+static bool TestSparseTaps(size_t inputSize,
+                           size_t irSize,
+                           size_t sparseSize,
+                           size_t tapCount,
+                           size_t blockSize,
+                           size_t blockSizeHead,
+                           size_t blockSizeTail)
+{
+  std::vector<fftconvolver::Sample> in(inputSize);
+  for (size_t i=0; i<inputSize; ++i)
+  {
+    in[i] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+  }
+
+  // Discrete taps in the first sparseSize samples followed by a dense tail
+  std::vector<fftconvolver::Sample> ir(irSize, fftconvolver::Sample(0.0));
+  std::vector<size_t> tapDelays;
+  for (size_t t=0; t<tapCount; ++t)
+  {
+    const size_t delay = static_cast<size_t>(rand()) % sparseSize;
+    ir[delay] = 2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f;
+    tapDelays.push_back(delay);
+  }
+  for (size_t i=sparseSize; i<irSize; ++i)
+  {
+    ir[i] = 0.1f * (2.0f * static_cast<fftconvolver::Sample>(rand()) / static_cast<fftconvolver::Sample>(RAND_MAX) - 1.0f);
+  }
+
+  std::vector<fftconvolver::Sample> outSimple(in.size() + ir.size() - 1, fftconvolver::Sample(0.0));
+  SimpleConvolve(&in[0], in.size(), &ir[0], ir.size(), &outSimple[0]);
+
+  // Taps rendered as a multi-tap delay, the convolver only gets the dense remainder
+  std::vector<fftconvolver::Sample> remainder(ir);
+  std::fill(remainder.begin(), remainder.begin() + sparseSize, fftconvolver::Sample(0.0));
+  std::sort(tapDelays.begin(), tapDelays.end());
+  tapDelays.erase(std::unique(tapDelays.begin(), tapDelays.end()), tapDelays.end());
+
+  std::vector<fftconvolver::Sample> out(outSimple.size(), fftconvolver::Sample(0.0));
+  fftconvolver::TwoStageFFTConvolver convolver;
+  convolver.init(blockSizeHead, blockSizeTail, &remainder[0], remainder.size());
+  std::vector<fftconvolver::Sample> inBuf(blockSize);
+  size_t processed = 0;
+  while (processed < out.size())
+  {
+    const size_t processing = std::min(blockSize, out.size() - processed);
+    memset(&inBuf[0], 0, inBuf.size() * sizeof(fftconvolver::Sample));
+    if (processed < in.size())
+    {
+      memcpy(&inBuf[0], &in[processed], std::min(processing, in.size() - processed) * sizeof(fftconvolver::Sample));
+    }
+    convolver.process(&inBuf[0], &out[processed], processing);
+    processed += processing;
+  }
+  for (size_t t=0; t<tapDelays.size(); ++t)
+  {
+    const size_t delay = tapDelays[t];
+    for (size_t i=0; i<in.size(); ++i)
+    {
+      out[i+delay] += ir[delay] * in[i];
+    }
+  }
+
+  double peak = 0.0;
+  double maxError = 0.0;
+  for (size_t i=0; i<out.size(); ++i)
+  {
+    peak = std::max(peak, ::fabs(static_cast<double>(outSimple[i])));
+    maxError = std::max(maxError, ::fabs(static_cast<double>(out[i]) - static_cast<double>(outSimple[i])));
+  }
+  const bool ok = maxError <= 1e-5 * peak;
+  printf("Sparse Taps (IR %d, %d taps in %d samples, blocksize %d, head %d, tail %d) => max error %.2e %s\n",
+         static_cast<int>(irSize), static_cast<int>(tapDelays.size()), static_cast<int>(sparseSize), static_cast<int>(blockSize),
+         static_cast<int>(blockSizeHead), static_cast<int>(blockSizeTail), maxError / std::max(peak, 1e-30), ok ? "[OK]" : "[FAILED]");
+  return ok;
+}
+
+
 #define TEST_CORRECTNESS
 //#define TEST_PERFORMANCE
 
 #define TEST_FFTCONVOLVER
 #define TEST_TWOSTAGEFFTCONVOLVER
+#define TEST_HALFPRECISION
+#define TEST_PAGING
+#define TEST_SHARING
+#define TEST_SPARSE
+#define TEST_MORPH
+#define TEST_DECAY
+#define TEST_FADE
+#define TEST_CLEAR
+#define TEST_ROUTES
 
 
 int main()
@@ -330,6 +1012,65 @@ int main()
 #endif
 
 
+#if defined(TEST_CORRECTNESS) && defined(TEST_HALFPRECISION)
+  printf("F16C conversions: %s\n", fftconvolver::F16CEnabled() ? "enabled" : "disabled");
+  TestHalfPrecisionConvolver(44100, 4321, 128, 128, 4096);
+  TestHalfPrecisionConvolver(44100, 44100, 256, 256, 8192);
+  TestHalfPrecisionConvolver(44100, 3*44100, 512, 512, 8192);
+#endif
+
+
+#if defined(TEST_CORRECTNESS) && defined(TEST_PAGING)
+  TestPagedConvolver(44100, 44100, 100, 128, 1024, 0, false);
+  TestPagedConvolver(44100, 3*44100, 256, 256, 4096, 64*1024, false);
+  TestPagedConvolver(44100, 3*44100, 512, 512, 8192, 256*1024, false);
+#endif
+
+
+#if defined(TEST_CORRECTNESS) && defined(TEST_SHARING)
+  TestSharedConvolver(44100, 1234, 100, 128, 1024);
+  TestSharedConvolver(44100, 3*44100, 256, 256, 8192);
+#endif
+
+
+#if defined(TEST_CORRECTNESS) && defined(TEST_SPARSE)
+  TestSparseTaps(10000, 12000, 4410, 24, 64, 64, 1024);
+  TestSparseTaps(10000, 20000, 4800, 40, 100, 128, 4096);
+  TestSparseTaps(10000, 6000, 6000, 16, 128, 128, 8192);
+#endif
+
+
+#if defined(TEST_CORRECTNESS) && defined(TEST_MORPH)
+  TestMorphConvolver(44100, 12000, 3, 64, 64, 1024);
+  TestMorphConvolver(3*44100, 2*44100, 4, 256, 256, 8192);
+#endif
+
+
+#if defined(TEST_CORRECTNESS) && defined(TEST_DECAY)
+  TestDecayConvolver(44100, 12000, 64, 64, 1024, 0.1);
+  TestDecayConvolver(3*44100, 2*44100, 256, 256, 8192, 0.5);
+#endif
+
+
+#if defined(TEST_CORRECTNESS) && defined(TEST_FADE)
+  TestFadeConvolver(44100, 12000, 9000, 64, 64, 1024);
+  TestFadeConvolver(44100, 1500, 12000, 64, 64, 1024);
+  TestFadeConvolver(3*44100, 2*44100, 2*44100, 256, 256, 8192);
+#endif
+
+
+#if defined(TEST_CORRECTNESS) && defined(TEST_CLEAR)
+  TestClearConvolver(44100, 12000, 100, 128, 1024);
+  TestClearConvolver(3*44100, 2*44100, 256, 256, 8192);
+#endif
+
+
+#if defined(TEST_CORRECTNESS) && defined(TEST_ROUTES)
+  TestRoutedConvolver(44100, 12000, 3, 100, 128, 1024);
+  TestRoutedConvolver(44100, 20000, 4, 256, 256, 4096);
+#endif
+
+
 #if defined(TEST_PERFORMANCE) && defined(TEST_TWOSTAGEFFTCONVOLVER)
   TestTwoStageConvolver(3*60*44100, 20*44100, 50, 100, 100, 2*8192, false);
 #endif
@@ -7,6 +7,16 @@ namespace globals {
 	inline unsigned int CONV_XFADE = 50;
 	inline unsigned int CONV_LOAD_COOLDOWN = 250;
 	inline unsigned int CONV_CLEAR_TAILS_COOLDOWN = 5;
+	inline const int MULTIRATE_SPLIT_MS = 200; // IR section kept at full rate by the multirate tail
+	inline const int MULTIRATE_XFADE_MS = 20;
+	inline const int MORPH_MAX_IRS = 4; // main IR plus morph IRs
+	inline const int MORPH_SMOOTH_MS = 50; // morph position smoothing time constant
+	inline const double TAIL_DECAY_MAX_DB_S = 240.0; // imposed tail decay at full amount, -60dB in 250ms
+	inline const int TAIL_DECAY_SMOOTH_MS = 50;
+	inline const int HYBRID_XFADE_MS = 100; // convolution to FDN crossfade, also the level calibration window
+	inline const int DRAFT_IR_MS = 1500; // IR length built while a parameter is dragged
+	inline const int DRAFT_DECIMATION = 2; // multirate factor of draft IR tails
+	inline const int IR_SLOTS = 12; // slot 0 is the main IR, MIDI notes select slots like patterns (note % 12)
 
 	// filter consts
 	inline unsigned int F_LERP_MILLIS = 50;
@@ -41,7 +51,12 @@ namespace globals {
 	inline const int AUDIO_DRUMSBUF_MILLIS = 20;
 	inline const int AUDIO_NOTE_LENGTH_MILLIS = 100;
 	inline const int MAX_UNDO = 100;
+	inline const int MAX_PREDELAY_MS = 3000; // longest synced predelay, a quarter note at 20 bpm
+	inline const int PREDELAY_GLIDE_MS = 50; // predelay changes glide instead of jumping
+	inline const int MAX_MIDI_EVENTS = 1024; // queued midi in and out messages, further events are dropped
 	inline const int EQ_FFT_ORDER = 12;
+	inline const int EQ_FFT_OVERLAP = 4; // analyzer FFTs per window length
+	inline const float EQ_FFT_SMOOTHING = 0.2f; // weight of the previous analyzer frame
 
 	// view consts
 	inline const int PLUG_WIDTH = 690;
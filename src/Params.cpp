@@ -0,0 +1,29 @@
+#include "Params.h"
+
+juce::String Param::getID(int index)
+{
+    if (index < posteq)
+        return names[index];
+
+    static const char* fields[EQ_FIELDS] = { "_mode", "_freq", "_q", "_gain", "_bypass" };
+    const int type = index >= decayeq ? 1 : 0;
+    const int i = index - (type == 0 ? posteq : decayeq);
+    return (type == 0 ? "posteq_band" : "decayeq_band") + String(i / EQ_FIELDS + 1) + fields[i % EQ_FIELDS];
+}
+
+void ParamRegistry::init(AudioProcessorValueTreeState& apvts)
+{
+    for (int i = 0; i < Param::NUM_PARAMS; ++i) {
+        auto id = Param::getID(i);
+        values[i] = apvts.getRawParameterValue(id);
+        parameters[i] = apvts.getParameter(id);
+        jassert(values[i] != nullptr); // registry out of sync with createParameterLayout
+        jassert(parameters[i]->getParameterIndex() == i);
+    }
+}
+
+void ParamRegistry::snapshot(Snapshot& dest) const
+{
+    for (int i = 0; i < Param::NUM_PARAMS; ++i)
+        dest[i] = values[i]->load(std::memory_order_relaxed);
+}
@@ -0,0 +1,142 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include "Globals.h"
+
+using namespace globals;
+
+/*
+    Parameter indices in layout order, see REEVRAudioProcessor::createParameterLayout.
+    The enumerators are named after the parameter IDs, EQ parameters are addressed with Param::eq.
+*/
+namespace Param
+{
+    enum EQField : int {
+        eqmode,
+        eqfreq,
+        eqq,
+        eqgain,
+        eqbypass,
+        EQ_FIELDS
+    };
+
+    enum ID : int {
+        showviewport,
+        tsenabled,
+        pattern,
+        irslot,
+        patsync,
+        trigger,
+        sync,
+        rate,
+        phase,
+        min,
+        max,
+        smooth,
+        attack,
+        release,
+        tension,
+        tensionatk,
+        tensionrel,
+        snap,
+        grid,
+        seqstep,
+        reverb,
+        send,
+        sendoffset,
+        revoffset,
+        predelay,
+        predelaysync,
+        predelayusesync,
+        width,
+        irdecayrate,
+        irattack,
+        irdecay,
+        irtrimleft,
+        irtrimright,
+        irstretch,
+        irgain,
+        irreverse,
+        irlowcut,
+        irhighcut,
+        irlowcutslope,
+        irhighcutslope,
+        irmorph,
+        irmorphsrc,
+        taildecay,
+        taildecaysrc,
+        drywet,
+        algo,
+        threshold,
+        sense,
+        lowcut,
+        highcut,
+        offset,
+        sendenvon,
+        sendenvthresh,
+        sendenvamt,
+        sendenvatk,
+        sendenvrel,
+        sendenvhold,
+        sendenvlowcut,
+        sendenvhighcut,
+        revenvon,
+        revenvthresh,
+        revenvamt,
+        revenvatk,
+        revenvrel,
+        revenvhold,
+        revenvlowcut,
+        revenvhighcut,
+        posteq, // first post EQ param, followed by EQ_FIELDS params per band
+        decayeq = posteq + EQ_BANDS * EQ_FIELDS,
+        NUM_PARAMS = decayeq + EQ_BANDS * EQ_FIELDS
+    };
+
+    // type is SVF::EQType, 0 post EQ and 1 decay EQ
+    constexpr ID eq(int type, int band, EQField field)
+    {
+        return ID((type == 0 ? posteq : decayeq) + band * EQ_FIELDS + field);
+    }
+
+    // IDs of the non EQ params, indexed by ID
+    inline constexpr const char* names[posteq] = {
+        "showviewport", "tsenabled", "pattern", "irslot", "patsync", "trigger", "sync", "rate", "phase",
+        "min", "max", "smooth", "attack", "release", "tension", "tensionatk", "tensionrel", "snap", "grid",
+        "seqstep", "reverb", "send", "sendoffset", "revoffset", "predelay", "predelaysync", "predelayusesync",
+        "width", "irdecayrate", "irattack", "irdecay", "irtrimleft", "irtrimright", "irstretch", "irgain",
+        "irreverse", "irlowcut", "irhighcut", "irlowcutslope", "irhighcutslope", "irmorph", "irmorphsrc",
+        "taildecay", "taildecaysrc", "drywet", "algo", "threshold", "sense", "lowcut", "highcut", "offset",
+        "sendenvon", "sendenvthresh", "sendenvamt", "sendenvatk", "sendenvrel", "sendenvhold", "sendenvlowcut",
+        "sendenvhighcut", "revenvon", "revenvthresh", "revenvamt", "revenvatk", "revenvrel", "revenvhold",
+        "revenvlowcut", "revenvhighcut"
+    };
+    static_assert(names[posteq - 1] != nullptr, "every non EQ param needs a name");
+
+    juce::String getID(int index); // builds EQ IDs, not for the audio thread
+}
+
+/*
+    Caches the APVTS value and parameter pointers by index so parameters are accessed without hashing strings.
+    The audio thread takes one Snapshot per block, code outside processBlock reads single values with get.
+*/
+class ParamRegistry
+{
+public:
+    using Snapshot = std::array<float, Param::NUM_PARAMS>;
+
+    void init(AudioProcessorValueTreeState& apvts); // after the layout is created
+
+    float get(Param::ID id) const { return values[id]->load(std::memory_order_relaxed); }
+    std::atomic<float>* getRaw(Param::ID id) const { return values[id]; }
+    RangedAudioParameter* getParameter(Param::ID id) const { return parameters[id]; }
+    void snapshot(Snapshot& dest) const;
+
+private:
+    std::array<std::atomic<float>*, Param::NUM_PARAMS> values{};
+    std::array<RangedAudioParameter*, Param::NUM_PARAMS> parameters{};
+};
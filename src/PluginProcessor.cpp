@@ -4,6 +4,37 @@
 #include "PluginEditor.h"
 #include <ctime>
 
+// the load state machine queues one task at a time, the audio thread hands it over
+// with an atomic flag and a notify so queueing never allocates or waits on a pool lock
+class REEVRAudioProcessor::LoadThread : public Thread
+{
+public:
+    LoadThread(REEVRAudioProcessor& p) : Thread("IRLoad"), processor(p) {}
+    ~LoadThread() override { stopThread(-1); } // a running load is never interrupted
+
+    void queue(LoadTask t)
+    {
+        task = t;
+        pending.store(true, std::memory_order_release);
+        notify();
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit()) {
+            if (pending.exchange(false, std::memory_order_acquire))
+                (processor.*task)();
+            else
+                wait(-1);
+        }
+    }
+
+private:
+    REEVRAudioProcessor& processor;
+    LoadTask task = nullptr;
+    std::atomic<bool> pending = false;
+};
+
 AudioProcessorValueTreeState::ParameterLayout REEVRAudioProcessor::createParameterLayout()
 {
     AudioProcessorValueTreeState::ParameterLayout layout;
@@ -11,6 +42,7 @@ AudioProcessorValueTreeState::ParameterLayout REEVRAudioProcessor::createParamet
     layout.add(std::make_unique<juce::AudioParameterBool>("showviewport", "Show Viewport", true));
     layout.add(std::make_unique<juce::AudioParameterBool>("tsenabled", "TrueStereo Enabled", true));
     layout.add(std::make_unique<juce::AudioParameterInt>("pattern", "Pattern", 1, 12, 1));
+    layout.add(std::make_unique<juce::AudioParameterInt>("irslot", "IR Slot", 0, IR_SLOTS - 1, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>("patsync", "Pattern Sync", StringArray{ "Off", "1/4 Beat", "1/2 Beat", "1 Beat", "2 Beats", "4 Beats" }, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>("trigger", "Trigger", StringArray{ "Sync", "MIDI", "Audio", "Free" }, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>("sync", "Sync", StringArray{ "Rate Hz", "1/256", "1/128", "1/64", "1/32", "1/16", "1/8", "1/4", "1/2", "1/1", "2/1", "4/1", "1/16t", "1/8t", "1/4t", "1/2t", "1/1t", "1/16.", "1/8.", "1/4.", "1/2.", "1/1." }, 9));
@@ -49,6 +81,10 @@ AudioProcessorValueTreeState::ParameterLayout REEVRAudioProcessor::createParamet
     layout.add(std::make_unique<juce::AudioParameterFloat>("irhighcut", "IR HighCut", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.3f), 20000.f));
     layout.add(std::make_unique<juce::AudioParameterChoice>("irlowcutslope", "IR Lowcut Slope", StringArray{ "6dB", "12dB", "24dB" }, 0));
     layout.add(std::make_unique<juce::AudioParameterChoice>("irhighcutslope", "IR Highcut Slope", StringArray{ "6dB", "12dB", "24dB" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("irmorph", "IR Morph", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("irmorphsrc", "IR Morph Source", StringArray{ "Knob", "Reverb Env" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("taildecay", "Tail Decay", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("taildecaysrc", "Tail Decay Source", StringArray{ "Knob", "Reverb Env", "Rev Follower" }, 0));
     layout.add(std::make_unique<juce::AudioParameterFloat>("drywet", "DryWet Mix", juce::NormalisableRange<float>(0.f, 1.0f), 0.25f));
 
     // audio trigger params
@@ -136,7 +172,14 @@ REEVRAudioProcessor::REEVRAudioProcessor()
         param->addListener(this);
     }
 
+    registry.init(params);
+    loadThread = std::make_unique<LoadThread>(*this);
+    loadThread->startThread();
+    decayEQBands.reserve(EQ_BANDS);
+    paramEQBands.reserve(EQ_BANDS);
+
     params.addParameterListener("pattern", this);
+    params.addParameterListener("irslot", this);
 
     // init patterns
     for (int i = 0; i < 12; ++i) {
@@ -170,9 +213,6 @@ REEVRAudioProcessor::REEVRAudioProcessor()
     sendpattern = sendpatterns[0];
     viewPattern = pattern;
     viewSubPattern = sendpattern;
-    preSamples.resize(MAX_PLUG_WIDTH, 0); // samples array size must be >= viewport width
-    postSamples.resize(MAX_PLUG_WIDTH, 0);
-    monSamples.resize(MAX_PLUG_WIDTH, 0); // samples array size must be >= audio monitor width
     revvalue = new RCSmoother();
     sendvalue = new RCSmoother();
 
@@ -186,7 +226,11 @@ REEVRAudioProcessor::REEVRAudioProcessor()
 
 REEVRAudioProcessor::~REEVRAudioProcessor()
 {
+    // finish the jobs before the weak reference master goes, load tasks may still queue benchmarks
+    loadThread = nullptr;
+    tunerPool.removeAllJobs(true, -1);
     params.removeParameterListener("pattern", this);
+    params.removeParameterListener("irslot", this);
 }
 
 void REEVRAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
@@ -197,6 +241,9 @@ void REEVRAudioProcessor::parameterChanged (const juce::String& parameterID, flo
             queuePattern(pat);
         }
     }
+    else if (parameterID == "irslot") {
+        queueSlot((int)newValue);
+    }
 }
 
 void REEVRAudioProcessor::parameterValueChanged (int parameterIndex, float newValue)
@@ -206,22 +253,38 @@ void REEVRAudioProcessor::parameterValueChanged (int parameterIndex, float newVa
     paramChanged = true;
 }
 
+// IR parameters being dragged build draft IRs, see Impulse::draft
 void REEVRAudioProcessor::parameterGestureChanged (int parameterIndex, bool gestureIsStarting)
 {
-    (void)parameterIndex;
-    (void)gestureIsStarting;
+    bool isIRParam = parameterIndex == Param::irattack || parameterIndex == Param::irdecay
+        || parameterIndex == Param::irtrimleft || parameterIndex == Param::irtrimright
+        || parameterIndex == Param::irstretch || parameterIndex == Param::irdecayrate
+        || parameterIndex == Param::irgain
+        || (parameterIndex >= Param::posteq && parameterIndex < Param::NUM_PARAMS);
+    if (!isIRParam) return;
+
+    if (gestureIsStarting)
+        irGestures.fetch_add(1);
+    else if (irGestures.fetch_sub(1) <= 0)
+        irGestures.store(0); // unbalanced end from the host
 }
 
 std::vector<SVF::EQBand> REEVRAudioProcessor::getEqualizer(SVF::EQType type) const
 {
     std::vector<SVF::EQBand> bands;
+    getEqualizer(type, bands);
+    return bands;
+}
+
+void REEVRAudioProcessor::getEqualizer(SVF::EQType type, std::vector<SVF::EQBand>& bands) const
+{
+    bands.clear();
 
-    String pre = type == 0 ? "posteq_" : "decayeq_";
     for (int i = 0; i < EQ_BANDS; i++) {
         SVF::EQBand band{};
         band.mode = SVF::PK;
 
-        auto filterOrShelf = (int)params.getRawParameterValue(pre + "band" + String(i + 1) + "_mode")->load();
+        auto filterOrShelf = (int)registry.get(Param::eq(type, i, Param::eqmode));
         if (i == 0 && filterOrShelf == 0) band.mode = SVF::HP;
         else if (i == 0 && filterOrShelf == 1) band.mode = SVF::LS;
         else if (i == 0 && filterOrShelf == 2) band.mode = SVF::HP6;
@@ -232,11 +295,11 @@ std::vector<SVF::EQBand> REEVRAudioProcessor::getEqualizer(SVF::EQType type) con
         else if (filterOrShelf == 1) band.mode = SVF::PK;
         else band.mode = SVF::Off;
 
-        band.freq = params.getRawParameterValue(pre + "band" + String(i + 1) + "_freq")->load();
-        band.gain = params.getRawParameterValue(pre + "band" + String(i + 1) + "_gain")->load();
+        band.freq = registry.get(Param::eq(type, i, Param::eqfreq));
+        band.gain = registry.get(Param::eq(type, i, Param::eqgain));
         band.gain = std::exp(band.gain * DB2LOG);
-        band.q = params.getRawParameterValue(pre + "band" + String(i + 1) + "_q")->load();
-        bool bypass = params.getRawParameterValue(pre + "band" + String(i + 1) + "_bypass")->load();
+        band.q = registry.get(Param::eq(type, i, Param::eqq));
+        bool bypass = (bool)registry.get(Param::eq(type, i, Param::eqbypass));
         if (bypass) continue;
 
         if (band.mode == SVF::LP || band.mode == SVF::LP6 ||
@@ -246,16 +309,277 @@ std::vector<SVF::EQBand> REEVRAudioProcessor::getEqualizer(SVF::EQType type) con
             bands.push_back(band);
         }
     }
-
-    return bands;
 }
 
 void REEVRAudioProcessor::loadImpulse(String path)
 {
-    irFile = path;
+    {
+        const ScopedLock lock(irFilesLock);
+        irFile = path;
+    }
     irDirty = true;
 }
 
+void REEVRAudioProcessor::addMorphImpulse(String path)
+{
+    {
+        const ScopedLock lock(irFilesLock);
+        if (morphFiles.size() >= MORPH_MAX_IRS - 1) return;
+        morphFiles.add(path);
+    }
+    irDirty = true;
+}
+
+void REEVRAudioProcessor::clearMorphImpulses()
+{
+    {
+        const ScopedLock lock(irFilesLock);
+        morphFiles.clear();
+    }
+    irDirty = true;
+}
+
+StringArray REEVRAudioProcessor::getMorphFiles() const
+{
+    const ScopedLock lock(irFilesLock);
+    return morphFiles;
+}
+
+String REEVRAudioProcessor::getSlotFile(int slot) const
+{
+    const ScopedLock lock(irFilesLock);
+    if (slot == 0) return irFile;
+    return slot > 0 && slot <= slotFiles.size() ? slotFiles[slot - 1] : String();
+}
+
+void REEVRAudioProcessor::setSlotFile(int slot, String path)
+{
+    if (slot < 1 || slot >= IR_SLOTS) return;
+    {
+        const ScopedLock lock(irFilesLock);
+        while (slotFiles.size() < IR_SLOTS - 1)
+            slotFiles.add("");
+        slotFiles.set(slot - 1, path);
+        hasSlotFiles = true;
+    }
+    slotsDirty = true;
+}
+
+void REEVRAudioProcessor::clearSlots()
+{
+    {
+        const ScopedLock lock(irFilesLock);
+        slotFiles.clear();
+        hasSlotFiles = false;
+    }
+    slotsDirty = true;
+}
+
+void REEVRAudioProcessor::queueSlot(int slot)
+{
+    if (slot >= 0 && slot < IR_SLOTS)
+        queuedSlot.store(slot);
+}
+
+// loads and partitions every slot IR except the active one into pendingSlots, runs on the thread pool
+// all engines get the same partitions and input history so a slot switch can fade inside the current convolver
+void REEVRAudioProcessor::loadSlotBank()
+{
+    // file list snapshot, the message thread may edit the slots while the bank loads
+    std::array<String, IR_SLOTS> files;
+    for (int i = 0; i < IR_SLOTS; ++i)
+        files[i] = getSlotFile(i);
+
+    std::array<std::unique_ptr<Impulse>, IR_SLOTS> imps;
+    size_t maxLength = impulse->bufferLL.size();
+    for (int i = 0; i < IR_SLOTS; ++i) {
+        auto& file = files[i];
+        if (i == activeSlot || file.isEmpty()) continue;
+        imps[i] = std::make_unique<Impulse>();
+        imps[i]->copySettings(*impulse);
+        imps[i]->load(file);
+        maxLength = std::max(maxLength, imps[i]->bufferLL.size());
+    }
+
+    const size_t budget = (size_t)slotBudgetMB << 20;
+    size_t used = 0;
+    int skipped = 0;
+    for (int i = 0; i < IR_SLOTS; ++i) {
+        if (!imps[i] || imps[i]->bufferLL.empty()) continue;
+        auto conv = std::make_unique<StereoConvolver>();
+        conv->setSynchronous(offline);
+        conv->prepare(convolver->size);
+        conv->halfPrecision = halfPrecisionIR;
+        conv->multirate = tailDecimation;
+        conv->hybridTailMs = hybridTailMs;
+        conv->matrixChannels = matrixChannels;
+        conv->inputHistory = maxLength;
+        tuneConvolver(*conv, maxLength);
+        conv->loadImpulse(*imps[i]);
+        const size_t mem = conv->getIRMemoryUsage();
+        if (used + mem > budget) {
+            skipped++;
+            continue;
+        }
+        used += mem;
+        pendingSlots[i] = std::move(conv);
+    }
+
+    slotHistory = maxLength;
+    slotMemory.store(used);
+    slotsOverBudget.store(skipped);
+    loadState.store(kSlotsReady);
+}
+
+// frees the IRs replaced by a crossfade or a slot bank rebuild off the audio thread
+void REEVRAudioProcessor::releaseOldImpulses()
+{
+    loadState.store(kReleasing);
+    runLoadJob(&REEVRAudioProcessor::releaseImpulsesTask);
+}
+
+void REEVRAudioProcessor::releaseImpulsesTask()
+{
+    loadConvolver->releaseImpulse();
+    for (auto& slot : pendingSlots)
+        slot = nullptr;
+    loadState.store(kIdle);
+}
+
+// loads or recalculates the IR into the load convolver, queued by processChunk when the IR is dirty
+void REEVRAudioProcessor::loadImpulseTask()
+{
+    const bool draft = loadDraft;
+    impulse->draft = draft;
+    // IR edits apply to the active slot
+    auto mainFile = getSlotFile(0);
+    auto slotFile = activeSlot > 0 ? getSlotFile(activeSlot) : String();
+    auto file = slotFile.isNotEmpty() ? slotFile : mainFile;
+    if (impulse->path != file.toStdString()) {
+        impulse->load(file);
+        if (file == mainFile) {
+            const ScopedLock lock(irFilesLock);
+            if (irFile == mainFile) // unless a new IR was picked meanwhile
+                irFile = String(impulse->path);
+        }
+    }
+    else {
+        impulse->recalcImpulse();
+    }
+    sendChangeMessage();
+    loadConvolver->halfPrecision = halfPrecisionIR;
+    loadConvolver->outOfCoreBudget = (size_t)outOfCoreMB << 20;
+    // draft tails are decimated on top of the truncation so they load faster
+    loadConvolver->multirate = draft ? std::max(tailDecimation, DRAFT_DECIMATION) : tailDecimation;
+    loadConvolver->hybridTailMs = hybridTailMs;
+    loadConvolver->matrixChannels = matrixChannels;
+    loadConvolver->inputHistory = slotHistory;
+    tuneConvolver(*loadConvolver, std::max(impulse->bufferLL.size(), slotHistory));
+    loadMorphImpulses(*loadConvolver);
+    loadConvolver->loadImpulse(*impulse);
+    if (!draft)
+        tailDecimationErrorDb.store(loadConvolver->getMultirateErrorDb());
+    loadState.store(kReady);
+}
+
+void REEVRAudioProcessor::processConvolver(StereoConvolver& conv, const AudioBuffer<float>& input, int numSamples, bool force2Chans)
+{
+    if (conv.isMatrix())
+        conv.processMatrix(input.getArrayOfReadPointers(), numSamples);
+    else
+        conv.process(input.getReadPointer(0), input.getReadPointer(1), numSamples, force2Chans);
+}
+
+void REEVRAudioProcessor::addWetSignal(StereoConvolver& conv, int numSamples, bool trueStereo, int fade, bool fadeIn)
+{
+    // the crossfade gain ramp is built once and shared by every channel
+    auto ramp = scratch.getBuffer(1, fade < 0 ? 0 : numSamples, false);
+    if (ramp.getNumChannels() == 0)
+        fade = -1; // arena exhausted, prepareToPlay sizes it so this never happens
+    auto* gains = ramp.getWritePointer(0);
+    for (int i = 0; fade >= 0 && i < ramp.getNumSamples(); ++i) {
+        float alpha = std::clamp((1.f - (float)(fade - i) / (float)xfadelen), 0.f, 1.f);
+        gains[i] = fadeIn ? alpha : 1.f - alpha;
+    }
+
+    auto add = [&](int channel, const float* data) {
+        auto* wet = wetBuffer.getWritePointer(channel);
+        if (fade < 0)
+            FloatVectorOperations::add(wet, data, numSamples);
+        else
+            FloatVectorOperations::addWithMultiply(wet, data, gains, numSamples);
+    };
+
+    if (conv.isMatrix()) {
+        for (int ch = 0; ch < std::min(wetBuffer.getNumChannels(), conv.matrixChannels); ++ch)
+            add(ch, conv.getMatrixOutput(ch));
+        return;
+    }
+    add(0, conv.bufferLL.data());
+    add(1, conv.bufferRR.data());
+    if (conv.isQuad && trueStereo) {
+        add(0, conv.bufferRL.data());
+        add(1, conv.bufferLR.data());
+    }
+}
+
+// IR loads run on the load thread, offline renders run them inline so IR changes apply on the block they arrive
+void REEVRAudioProcessor::runLoadJob(LoadTask task)
+{
+    if (offline)
+        (this->*task)();
+    else
+        loadThread->queue(task);
+}
+
+// called on the audio thread with no IR load in flight
+void REEVRAudioProcessor::setOffline(bool isOffline)
+{
+    offline = isOffline;
+    convolver->setSynchronous(offline);
+    loadConvolver->setSynchronous(offline);
+    for (auto& slot : slots)
+        if (slot) slot->setSynchronous(offline);
+}
+
+// called on the audio thread once a crossfade completed, the load convolver holds the previous IR
+void REEVRAudioProcessor::finishCrossfade()
+{
+    if (fadingSlot < 0) {
+        releaseOldImpulses();
+        if (hasSlotFiles.load() || activeSlot != 0)
+            slotsDirty = true; // IR settings changed, the bank follows
+        return;
+    }
+
+    // slot switch, the previous IR stays in the bank and the spare convolver becomes the load convolver
+    slots[activeSlot] = std::move(loadConvolver);
+    loadConvolver = std::move(slots[fadingSlot]);
+    activeSlot = fadingSlot;
+    fadingSlot = -1;
+    loadState.store(kIdle);
+}
+
+// loads the morph IRs with the main impulse settings and hands them to the convolver
+void REEVRAudioProcessor::loadMorphImpulses(StereoConvolver& conv)
+{
+    const auto files = getMorphFiles(); // snapshot, the message thread may edit the list while the job runs
+    const int count = std::min(files.size(), MORPH_MAX_IRS - 1);
+    morphImpulses.resize(count);
+    conv.morphImpulses.clear();
+    for (int i = 0; i < count; ++i) {
+        if (!morphImpulses[i])
+            morphImpulses[i] = std::make_unique<Impulse>();
+        auto& imp = *morphImpulses[i];
+        imp.copySettings(*impulse);
+        if (imp.path != files[i].toStdString())
+            imp.load(files[i]);
+        else
+            imp.recalcImpulse();
+        conv.morphImpulses.push_back(&imp);
+    }
+}
+
 void REEVRAudioProcessor::loadSettings ()
 {
     settings.closeFiles(); // FIX files changed by other plugin instances not loading
@@ -263,6 +587,9 @@ void REEVRAudioProcessor::loadSettings ()
         scale = (float)file->getDoubleValue("scale", 1.0f);
         plugWidth = file->getIntValue("width", PLUG_WIDTH);
         plugHeight = file->getIntValue("height", PLUG_HEIGHT);
+        outOfCoreMB = file->getIntValue("outofcoremb", 0);
+        slotBudgetMB = file->getIntValue("slotbudgetmb", 256);
+        convolverTuner.fromString(file->getValue("convwisdom", ""));
         if (!file->getValue("irdir", "").isEmpty()) {
             irDir = file->getValue("irdir");
         }
@@ -278,9 +605,9 @@ void REEVRAudioProcessor::loadSettings ()
                 irDir = impulsesDir.getFullPathName();
             }
         }
-        auto tensionparam = (double)params.getRawParameterValue("tension")->load();
-        auto tensionatk = (double)params.getRawParameterValue("tensionatk")->load();
-        auto tensionrel = (double)params.getRawParameterValue("tensionrel")->load();
+        auto tensionparam = (double)registry.get(Param::tension);
+        auto tensionatk = (double)registry.get(Param::tensionatk);
+        auto tensionrel = (double)registry.get(Param::tensionrel);
 
         for (int i = 0; i < PAINT_PATS; ++i) {
             auto str = file->getValue("paintpat" + String(i),"").toStdString();
@@ -308,6 +635,9 @@ void REEVRAudioProcessor::saveSettings ()
         file->setValue("width", plugWidth);
         file->setValue("height", plugHeight);
         file->setValue("irdir", irDir);
+        file->setValue("outofcoremb", outOfCoreMB);
+        file->setValue("slotbudgetmb", slotBudgetMB);
+        file->setValue("convwisdom", convolverTuner.toString());
         for (int i = 0; i < PAINT_PATS; ++i) {
             std::ostringstream oss;
             auto points = paintPatterns[i]->points;
@@ -320,6 +650,28 @@ void REEVRAudioProcessor::saveSettings ()
     settings.saveIfNeeded();
 }
 
+// picks measured head and tail partition sizes for the IR length and block size
+// the first use of a configuration keeps the default partitions and queues the benchmark on the tuner pool,
+// later loads use the result, it never runs inside prepareToPlay or processBlock nor delays the IR load jobs
+void REEVRAudioProcessor::tuneConvolver(StereoConvolver& conv, size_t irLength)
+{
+    auto key = ConvolverTuner::getKey(conv.size, irLength, offline);
+    ConvolverTuner::Partitions partitions;
+    if (!convolverTuner.lookup(key, partitions)) {
+        partitions = ConvolverTuner::getDefault(conv.size);
+        if (convolverTuner.beginMeasure(key)) {
+            tunerPool.addJob([this, key, blockSize = conv.size, irLength, isOffline = offline]() {
+                convolverTuner.store(key, ConvolverTuner::measure(blockSize, irLength, isOffline));
+                MessageManager::callAsync([self = WeakReference<REEVRAudioProcessor>(this)]() {
+                    if (self != nullptr) // the plugin may have been closed meanwhile
+                        self->saveSettings();
+                });
+            });
+        }
+    }
+    conv.setPartitions(partitions.head, partitions.tail);
+}
+
 void REEVRAudioProcessor::setScale(float s)
 {
     scale = s;
@@ -328,13 +680,13 @@ void REEVRAudioProcessor::setScale(float s)
 
 int REEVRAudioProcessor::getCurrentGrid()
 {
-    auto gridIndex = (int)params.getRawParameterValue("grid")->load();
+    auto gridIndex = (int)registry.get(Param::grid);
     return GRID_SIZES[gridIndex];
 }
 
 int REEVRAudioProcessor::getCurrentSeqStep()
 {
-    auto gridIndex = (int)params.getRawParameterValue("seqstep")->load();
+    auto gridIndex = (int)registry.get(Param::seqstep);
     return GRID_SIZES[gridIndex];
 }
 
@@ -395,7 +747,7 @@ void REEVRAudioProcessor::setSendEditMode(bool isSend)
 
 int REEVRAudioProcessor::getPredelaySync()
 {
-    int predelaySync = (int)params.getRawParameterValue("predelaysync")->load();
+    int predelaySync = (int)registry.get(Param::predelaysync);
     double noteLength = 0.0;
     if (predelaySync == 1) noteLength = 0.0625; // 1/64
     else if (predelaySync == 2) noteLength = 0.125; // 1/32
@@ -410,7 +762,7 @@ int REEVRAudioProcessor::getPredelaySync()
 
 void REEVRAudioProcessor::startMidiTrigger()
 {
-    double phase = (double)params.getRawParameterValue("phase")->load();
+    double phase = (double)registry.get(Param::phase);
     clearWaveBuffers();
     midiTrigger = !alwaysPlaying;
     trigpos = 0.0;
@@ -607,7 +959,18 @@ void REEVRAudioProcessor::changeProgramName (int index, const juce::String& newN
 void REEVRAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     srate = sampleRate;
-    warmer.setSize(2, (int)std::ceil(sampleRate) / 4); // 0.25 seconds of warmup samples
+    // surround and ambisonic buses convolve every channel through the IR matrix
+    const int busChannels = getMainBusNumOutputChannels();
+    matrixChannels = busChannels > 2 ? busChannels : 0;
+    const int numChannels = std::max(2, matrixChannels);
+    convolver->matrixChannels = matrixChannels;
+    loadConvolver->matrixChannels = matrixChannels;
+    impulse->matrixChannels = matrixChannels;
+    irLowcutS.assign(numChannels - 2, Filter{FilterSlope::k6dB, FilterMode::HP});
+    irHighcutS.assign(numChannels - 2, Filter{FilterSlope::k6dB, FilterMode::LP});
+    setOffline(isNonRealtime()); // offline renders tune the partitions for throughput
+
+    warmer.setSize(numChannels, (int)std::ceil(sampleRate) / 4); // 0.25 seconds of warmup samples
     warmwritepos = 0;
     warmer.clear();
     convolver->prepare(samplesPerBlock);
@@ -615,30 +978,53 @@ void REEVRAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     yrevBuffer.resize(samplesPerBlock, 0.0f);
     ysendBuffer.resize(samplesPerBlock, 0.0f);
     xposBuffer.resize(samplesPerBlock, 0.0f);
-    wetBuffer.setSize(2, samplesPerBlock);
-    sendBuffer.setSize(2, samplesPerBlock);
+    wetBuffer.setSize(numChannels, samplesPerBlock);
+    sendBuffer.setSize(numChannels, samplesPerBlock);
 
     impulse->prepare(sampleRate);
+    impulse->draft = false;
+    irDraftLoaded = false;
     if (!init) {
-        impulse->attack = params.getRawParameterValue("irattack")->load();
-        impulse->decay = params.getRawParameterValue("irdecay")->load();
-        impulse->trimLeft = params.getRawParameterValue("irtrimleft")->load();
-        impulse->trimRight = params.getRawParameterValue("irtrimright")->load();
-        impulse->stretch = params.getRawParameterValue("irstretch")->load();
-        impulse->decayRate = params.getRawParameterValue("irdecayrate")->load();
-        impulse->gain = exp(params.getRawParameterValue("irgain")->load() * DB2LOG);
+        impulse->attack = registry.get(Param::irattack);
+        impulse->decay = registry.get(Param::irdecay);
+        impulse->trimLeft = registry.get(Param::irtrimleft);
+        impulse->trimRight = registry.get(Param::irtrimright);
+        impulse->stretch = registry.get(Param::irstretch);
+        impulse->decayRate = registry.get(Param::irdecayrate);
+        impulse->gain = exp(registry.get(Param::irgain) * DB2LOG);
         impulse->paramEQ = getEqualizer(SVF::ParamEQ);
         impulse->decayEQ = getEqualizer(SVF::DecayEQ);
-        impulse->load(irFile);
+        impulse->load(getSlotFile(0));
     }
     else {
-        impulse->load(irFile); // reload IR file
+        impulse->load(getSlotFile(0)); // reload IR file
     }
 
+    convolver->halfPrecision = halfPrecisionIR;
+    convolver->outOfCoreBudget = (size_t)outOfCoreMB << 20;
+    convolver->multirate = tailDecimation;
+    convolver->hybridTailMs = hybridTailMs;
+    convolver->inputHistory = slotHistory;
+    tuneConvolver(*convolver, std::max(impulse->bufferLL.size(), slotHistory));
+    loadMorphImpulses(*convolver);
     convolver->loadImpulse(*impulse);
-
-    delayBuffer.setSize(2, int(2.0f * sampleRate));
-    delayBuffer.clear();
+    tailDecimationErrorDb.store(convolver->getMultirateErrorDb());
+
+    // the bank is rebuilt for the new block size, the main IR is active again
+    for (auto& slot : slots)
+        slot = nullptr;
+    activeSlot = 0;
+    fadingSlot = -1;
+    slotsDirty = hasSlotFiles.load();
+
+    // audio thread buffers are sized for one chunk of at most samplesPerBlock, processBlock never allocates
+    preparedBlockSize = std::max(1, samplesPerBlock);
+    chunkMidi.ensureSize(MAX_MIDI_EVENTS * 16);
+    chunkMidiOut.ensureSize(MAX_MIDI_EVENTS * 16);
+    predelayLine.prepare(numChannels, (int)std::ceil(MAX_PREDELAY_MS / 1000.0 * sampleRate), samplesPerBlock, sampleRate);
+    scratch.prepare((2 * (size_t)numChannels + 2) * (samplesPerBlock * sizeof(float) + sizeof(float*)) + 8 * ScratchArena::ALIGNMENT); // predelayed send, warmup chunk and two fade ramps
+    midiIn.prepare(MAX_MIDI_EVENTS);
+    midiOut.reserve(MAX_MIDI_EVENTS);
 
     updatePatternFromReverb();
     updatePatternFromSend();
@@ -651,12 +1037,16 @@ void REEVRAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     audioLowcutR.reset(0.0f);
     transDetectorL.clear(sampleRate);
     transDetectorR.clear(sampleRate);
-    irLowcutL.reset(0.0f);
-    irLowcutR.reset(0.0f);
-    irHighcutL.reset(0.0f);
-    irHighcutR.reset(0.0f);
-    std::fill(monSamples.begin(), monSamples.end(), 0.0f);
+    irLowcutLR.reset(0.0f);
+    irHighcutLR.reset(0.0f);
+    monitorTap.clear();
+    const auto maxLatency = (size_t)std::ceil(sampleRate * LATENCY_MILLIS / 1000.0);
+    latBufferL.reserve(maxLatency);
+    latBufferR.reserve(maxLatency);
+    monLatBufferL.reserve(maxLatency);
+    monLatBufferR.reserve(maxLatency);
     clearLatencyBuffers();
+    ltrigger = -1; // the latency depends on the sample rate, recompute it
     onSlider(); // sets latency
     sendChangeMessage();
     init = true;
@@ -675,12 +1065,15 @@ bool REEVRAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // mono and stereo use the stereo engine, surround and first order ambisonic
+    // buses convolve every channel through the IR matrix
+    const auto& out = layouts.getMainOutputChannelSet();
+    if (out != juce::AudioChannelSet::mono()
+     && out != juce::AudioChannelSet::stereo()
+     && out != juce::AudioChannelSet::quadraphonic()
+     && out != juce::AudioChannelSet::create5point1()
+     && out != juce::AudioChannelSet::create7point1()
+     && out != juce::AudioChannelSet::ambisonic(1))
         return false;
 
     // This checks if the input layout matches the output layout
@@ -698,7 +1091,7 @@ void REEVRAudioProcessor::onSlider()
 {
     onSmoothChange();
 
-    int trigger = (int)params.getRawParameterValue("trigger")->load();
+    int trigger = (int)registry.get(Param::trigger);
     if (trigger != ltrigger) {
         auto latency = getLatencySamples();
         setLatencySamples(trigger == Trigger::Audio
@@ -707,7 +1100,7 @@ void REEVRAudioProcessor::onSlider()
         );
         if (getLatencySamples() != latency && playing) {
             showLatencyWarning = true;
-            MessageManager::callAsync([this]() { sendChangeMessage(); });
+            sendChangeMessage(); // async, posts the broadcaster's preallocated message
         }
         clearLatencyBuffers();
         ltrigger = trigger;
@@ -724,9 +1117,9 @@ void REEVRAudioProcessor::onSlider()
     if (trigger != Trigger::Audio && useMonitor)
         useMonitor = false;
 
-    auto tension = (double)params.getRawParameterValue("tension")->load();
-    auto tensionatk = (double)params.getRawParameterValue("tensionatk")->load();
-    auto tensionrel = (double)params.getRawParameterValue("tensionrel")->load();
+    auto tension = (double)registry.get(Param::tension);
+    auto tensionatk = (double)registry.get(Param::tensionatk);
+    auto tensionrel = (double)registry.get(Param::tensionrel);
     if (tension != ltension || tensionatk != ltensionatk || tensionrel != ltensionrel) {
         onTensionChange();
         ltensionatk = tensionatk;
@@ -734,7 +1127,7 @@ void REEVRAudioProcessor::onSlider()
         ltension = tension;
     }
 
-    auto sync = (int)params.getRawParameterValue("sync")->load();
+    auto sync = (int)registry.get(Param::sync);
     if (sync == 0) syncQN = 1.; // not used
     else if (sync == 1) syncQN = 1. / 64.; // 1/256
     else if (sync == 2) syncQN = 1. / 32.; // 1/128
@@ -758,8 +1151,8 @@ void REEVRAudioProcessor::onSlider()
     else if (sync == 20) syncQN = 2. / 1. * 1.5; // 1/2.
     else if (sync == 21) syncQN = 4. / 1. * 1.5; // 1/1.
 
-    auto highcut = params.getRawParameterValue("highcut")->load();
-    auto lowcut = params.getRawParameterValue("lowcut")->load();
+    auto highcut = registry.get(Param::highcut);
+    auto lowcut = registry.get(Param::lowcut);
     audioHighcutL.lp((float)srate, highcut, 0.707f);
     audioHighcutR.lp((float)srate, highcut, 0.707f);
     audioLowcutL.hp((float)srate, lowcut, 0.707f);
@@ -767,10 +1160,10 @@ void REEVRAudioProcessor::onSlider()
 
     if (reverbDirty) {
         float avg = (float)pattern->getavgY();
-        float rev = params.getParameter("reverb")->getValue();
-        if (avg != rev) {
-            params.getParameter("reverb")->setValueNotifyingHost(avg);
-            lreverb = (double)params.getRawParameterValue("reverb")->load();
+        auto param = registry.getParameter(Param::reverb);
+        if (avg != param->getValue()) {
+            param->setValueNotifyingHost(avg);
+            lreverb = (double)registry.get(Param::reverb);
         }
         reverbDirty = false;
         reverbDirtyCooldown = 5; // ignore reverb updates for 5 blocks
@@ -778,17 +1171,17 @@ void REEVRAudioProcessor::onSlider()
 
     if (sendDirty) {
         float avg = (float)sendpattern->getavgY();
-        float snd = params.getParameter("send")->getValue();
-        if (avg != snd) {
-            params.getParameter("send")->setValueNotifyingHost(avg);
-            lsend = (double)params.getRawParameterValue("send")->load();
+        auto param = registry.getParameter(Param::send);
+        if (avg != param->getValue()) {
+            param->setValueNotifyingHost(avg);
+            lsend = (double)registry.get(Param::send);
         }
         sendDirty = false;
         sendDirtyCooldown = 5;
     }
 
-    double reverb = (double)params.getRawParameterValue("reverb")->load();
-    double send = (double)params.getRawParameterValue("send")->load();
+    double reverb = (double)registry.get(Param::reverb);
+    double send = (double)registry.get(Param::send);
 
     // Ignores DAW updates for reverb which was changed internally
     // DAW param updates are not reliable, on standalone works fine
@@ -808,60 +1201,66 @@ void REEVRAudioProcessor::onSlider()
         lsend = send;
     }
 
-    bool sendenvOn = (bool)params.getRawParameterValue("sendenvon")->load();
-    bool revenvOn = (bool)params.getRawParameterValue("revenvon")->load();
+    bool sendenvOn = (bool)registry.get(Param::sendenvon);
+    bool revenvOn = (bool)registry.get(Param::revenvon);
 
     if (revenvOn) {
-        float thresh = params.getRawParameterValue("revenvthresh")->load();
-        float attack = params.getRawParameterValue("revenvatk")->load();
-        float hold = params.getRawParameterValue("revenvhold")->load();
-        float release = params.getRawParameterValue("revenvrel")->load();
-        float revenvLowCut = params.getRawParameterValue("revenvlowcut")->load();
-        float revenvHighCut = params.getRawParameterValue("revenvhighcut")->load();
+        float thresh = registry.get(Param::revenvthresh);
+        float attack = registry.get(Param::revenvatk);
+        float hold = registry.get(Param::revenvhold);
+        float release = registry.get(Param::revenvrel);
+        float revenvLowCut = registry.get(Param::revenvlowcut);
+        float revenvHighCut = registry.get(Param::revenvhighcut);
         revenv.prepare((float)srate, thresh, revenvAutoRel, attack, hold, release, revenvLowCut, revenvHighCut);
     }
 
     if (sendenvOn) {
-        float thresh = params.getRawParameterValue("sendenvthresh")->load();
-        float attack = params.getRawParameterValue("sendenvatk")->load();
-        float hold = params.getRawParameterValue("sendenvhold")->load();
-        float release = params.getRawParameterValue("sendenvrel")->load();
-        float sendenvLowCut = params.getRawParameterValue("sendenvlowcut")->load();
-        float sendenvHighCut = params.getRawParameterValue("sendenvhighcut")->load();
+        float thresh = registry.get(Param::sendenvthresh);
+        float attack = registry.get(Param::sendenvatk);
+        float hold = registry.get(Param::sendenvhold);
+        float release = registry.get(Param::sendenvrel);
+        float sendenvLowCut = registry.get(Param::sendenvlowcut);
+        float sendenvHighCut = registry.get(Param::sendenvhighcut);
         sendenv.prepare((float)srate, thresh, resenvAutoRel, attack, hold, release, sendenvLowCut, sendenvHighCut);
     }
 
     //
     updateImpulse();
 
-    auto irlowcut = params.getRawParameterValue("irlowcut")->load();
-    auto irhighcut = params.getRawParameterValue("irhighcut")->load();
-    auto irlowcutSlope = (int)params.getRawParameterValue("irlowcutslope")->load();
-    auto irhighcutSlope = (int)params.getRawParameterValue("irhighcutslope")->load();
-    irLowcutL.setSlope((FilterSlope)irlowcutSlope);
-    irLowcutR.setSlope((FilterSlope)irlowcutSlope);
-    irHighcutL.setSlope((FilterSlope)irhighcutSlope);
-    irHighcutR.setSlope((FilterSlope)irhighcutSlope);
-    irLowcutL.init((float)srate, irlowcut, irLowcutL.slope == k24dB ? 0.0765f : 0.2929f);
-    irLowcutR.init((float)srate, irlowcut, irLowcutR.slope == k24dB ? 0.0765f : 0.2929f);
-    irHighcutL.init((float)srate, irhighcut, irHighcutL.slope == k24dB ? 0.0765f : 0.2929f);
-    irHighcutR.init((float)srate, irhighcut, irHighcutL.slope == k24dB ? 0.0765f : 0.2929f);
+    auto irlowcut = registry.get(Param::irlowcut);
+    auto irhighcut = registry.get(Param::irhighcut);
+    auto irlowcutSlope = (int)registry.get(Param::irlowcutslope);
+    auto irhighcutSlope = (int)registry.get(Param::irhighcutslope);
+    irLowcutLR.setSlope((FilterSlope)irlowcutSlope);
+    irHighcutLR.setSlope((FilterSlope)irhighcutSlope);
+    irLowcutLR.init((float)srate, irlowcut, irLowcutLR.slope == k24dB ? 0.0765f : 0.2929f);
+    irHighcutLR.init((float)srate, irhighcut, irHighcutLR.slope == k24dB ? 0.0765f : 0.2929f);
+    for (auto& filter : irLowcutS) {
+        filter.setSlope((FilterSlope)irlowcutSlope);
+        filter.init((float)srate, irlowcut, filter.slope == k24dB ? 0.0765f : 0.2929f);
+    }
+    for (auto& filter : irHighcutS) {
+        filter.setSlope((FilterSlope)irhighcutSlope);
+        filter.init((float)srate, irhighcut, filter.slope == k24dB ? 0.0765f : 0.2929f);
+    }
 }
 
 void REEVRAudioProcessor::updateImpulse()
 {
-    float irattack = params.getRawParameterValue("irattack")->load();
-    float irdecay = params.getRawParameterValue("irdecay")->load();
-    float irtrimleft = params.getRawParameterValue("irtrimleft")->load();
-    float irtrimright = params.getRawParameterValue("irtrimright")->load();
-    float irstretch = params.getRawParameterValue("irstretch")->load();
-    float irdecayrate = params.getRawParameterValue("irdecayrate")->load();
-    float irgain = std::exp(params.getRawParameterValue("irgain")->load() * DB2LOG);
-    bool irreverse = (bool)params.getRawParameterValue("irreverse")->load();
-    auto decayEQ = getEqualizer(SVF::DecayEQ);
-    auto paramEQ = getEqualizer(SVF::ParamEQ);
-
-    auto compareEQs = [this](std::vector<SVF::EQBand> e1, std::vector<SVF::EQBand> e2)
+    float irattack = registry.get(Param::irattack);
+    float irdecay = registry.get(Param::irdecay);
+    float irtrimleft = registry.get(Param::irtrimleft);
+    float irtrimright = registry.get(Param::irtrimright);
+    float irstretch = registry.get(Param::irstretch);
+    float irdecayrate = registry.get(Param::irdecayrate);
+    float irgain = std::exp(registry.get(Param::irgain) * DB2LOG);
+    bool irreverse = (bool)registry.get(Param::irreverse);
+    auto& decayEQ = decayEQBands;
+    auto& paramEQ = paramEQBands;
+    getEqualizer(SVF::DecayEQ, decayEQ);
+    getEqualizer(SVF::ParamEQ, paramEQ);
+
+    auto compareEQs = [](const std::vector<SVF::EQBand>& e1, const std::vector<SVF::EQBand>& e2)
         {
             if (e1.size() != e2.size()) return false;
             for (int i = 0; i < e1.size(); ++i) {
@@ -877,7 +1276,7 @@ void REEVRAudioProcessor::updateImpulse()
         };
 
     if (irtrimleft > 1.0f - irtrimright) {
-        params.getParameter("irtrimleft")->setValueNotifyingHost(1.0f-irtrimright);
+        registry.getParameter(Param::irtrimleft)->setValueNotifyingHost(1.0f-irtrimright);
     }
     else if (irattack != impulse->attack
         || irdecay != impulse->decay
@@ -906,13 +1305,13 @@ void REEVRAudioProcessor::updateImpulse()
 
 void REEVRAudioProcessor::updatePatternFromReverb()
 {
-    float revnorm = params.getParameter("reverb")->getValue();
+    float revnorm = registry.getParameter(Param::reverb)->getValue();
     pattern->transform(revnorm);
 }
 
 void REEVRAudioProcessor::updatePatternFromSend()
 {
-    float sendnorm = params.getParameter("send")->getValue();
+    float sendnorm = registry.getParameter(Param::send)->getValue();
     sendpattern->transform(sendnorm);
 }
 
@@ -930,9 +1329,9 @@ void REEVRAudioProcessor::updateSendFromPattern()
 
 void REEVRAudioProcessor::onTensionChange()
 {
-    auto tension = (double)params.getRawParameterValue("tension")->load();
-    auto tensionatk = (double)params.getRawParameterValue("tensionatk")->load();
-    auto tensionrel = (double)params.getRawParameterValue("tensionrel")->load();
+    auto tension = (double)registry.get(Param::tension);
+    auto tensionatk = (double)registry.get(Param::tensionatk);
+    auto tensionrel = (double)registry.get(Param::tensionrel);
     pattern->setTension(tension, tensionatk, tensionrel, dualTension);
     sendpattern->setTension(tension, tensionatk, tensionrel, dualTension);
     pattern->buildSegments();
@@ -952,20 +1351,19 @@ void REEVRAudioProcessor::onPlay()
     sendenv.clear();
     revenv.clear();
     warmer.clear();
-    int trigger = (int)params.getRawParameterValue("trigger")->load();
-    double ratehz = (double)params.getRawParameterValue("rate")->load();
-    double phase = (double)params.getRawParameterValue("phase")->load();
+    int trigger = (int)registry.get(Param::trigger);
+    double ratehz = (double)registry.get(Param::rate);
+    double phase = (double)registry.get(Param::phase);
 
     if (trigger == Trigger::Free)
         return;
 
-    irLowcutL.reset(0.0f);
-    irLowcutR.reset(0.0f);
-    irHighcutL.reset(0.0f);
-    irHighcutR.reset(0.0f);
+    irLowcutLR.reset(0.0f);
+    irHighcutLR.reset(0.0f);
+    for (auto& filter : irLowcutS) filter.reset(0.0f);
+    for (auto& filter : irHighcutS) filter.reset(0.0f);
 
-    delayBuffer.clear();
-    delaypos = 0;
+    predelayLine.clear();
 
     clearTails = false;
     clearTailsCooldown = 0;
@@ -991,12 +1389,12 @@ void REEVRAudioProcessor::onPlay()
 
 void REEVRAudioProcessor::restartEnv(bool fromZero)
 {
-    int sync = (int)params.getRawParameterValue("sync")->load();
-    double min = (double)params.getRawParameterValue("min")->load();
-    double max = (double)params.getRawParameterValue("max")->load();
-    double phase = (double)params.getRawParameterValue("phase")->load();
-    double revoffset = (double)params.getRawParameterValue("revoffset")->load();
-    double sendoffset = (double)params.getRawParameterValue("sendoffset")->load();
+    int sync = (int)registry.get(Param::sync);
+    double min = (double)registry.get(Param::min);
+    double max = (double)registry.get(Param::max);
+    double phase = (double)registry.get(Param::phase);
+    double revoffset = (double)registry.get(Param::revoffset);
+    double sendoffset = (double)registry.get(Param::sendoffset);
 
     if (fromZero) { // restart from phase
         xpos = phase;
@@ -1009,59 +1407,64 @@ void REEVRAudioProcessor::restartEnv(bool fromZero)
 
         revvalue->reset(getYRev(xpos, min, max, revoffset));
         sendvalue->reset(getYSend(xpos, min, max, sendoffset));
+        revtarget.reset(revvalue->output);
+        sendtarget.reset(sendvalue->output);
     }
+    envPhase = 0;
 }
 
 void REEVRAudioProcessor::onStop()
 {
     if (showLatencyWarning) {
         showLatencyWarning = false;
-        MessageManager::callAsync([this]() { sendChangeMessage(); });
+        sendChangeMessage();
     }
 }
 
 void REEVRAudioProcessor::clearWaveBuffers()
 {
-    std::fill(preSamples.begin(), preSamples.end(), 0.0f);
-    std::fill(postSamples.begin(), postSamples.end(), 0.0f);
+    viewTap.clear();
 }
 
 void REEVRAudioProcessor::clearLatencyBuffers()
 {
-    int trigger = (int)params.getRawParameterValue("trigger")->load();
+    int trigger = (int)registry.get(Param::trigger);
     auto latency = trigger == Trigger::Audio
         ? (int)std::ceil(getSampleRate() * LATENCY_MILLIS / 1000.0)
         : 0;
-    latBufferL.resize(latency, 0.0f); // these are latency buffers for audio trigger only
-    latBufferR.resize(latency, 0.0f);
-    monLatBufferL.resize(getLatencySamples(), 0.0f);
-    monLatBufferR.resize(getLatencySamples(), 0.0f);
+    // these are latency buffers for audio trigger only, reserved in prepareToPlay so resizing never allocates
+    latBufferL.assign(latency, 0.0f);
+    latBufferR.assign(latency, 0.0f);
+    monLatBufferL.assign(getLatencySamples(), 0.0f);
+    monLatBufferR.assign(getLatencySamples(), 0.0f);
     latpos = 0;
     monWritePos = 0;
 }
 
 double inline REEVRAudioProcessor::getYRev(double x, double min, double max, double offset)
 {
-    return std::clamp(min + (max - min) * (1 - pattern->get_y_at(x, true)) + offset, 0.0, 1.0);
+    pattern->try_get_y_at(x, revPatternY, true); // keeps the last value while the UI rebuilds segments
+    return std::clamp(min + (max - min) * (1 - revPatternY) + offset, 0.0, 1.0);
 }
 
 double inline REEVRAudioProcessor::getYSend(double x, double min, double max, double offset)
 {
-    return std::clamp(min + (max - min) * (1 - sendpattern->get_y_at(x)) + offset, 0.0, 1.0);
+    sendpattern->try_get_y_at(x, sendPatternY);
+    return std::clamp(min + (max - min) * (1 - sendPatternY) + offset, 0.0, 1.0);
 }
 
 void REEVRAudioProcessor::onSmoothChange()
 {
     if (dualSmooth) {
-        double attack = (double)params.getRawParameterValue("attack")->load();
-        double release = (double)params.getRawParameterValue("release")->load();
+        double attack = (double)registry.get(Param::attack);
+        double release = (double)registry.get(Param::release);
         attack *= attack;
         release *= release;
         revvalue->setup(attack * 0.25, release * 0.25, srate);
         sendvalue->setup(attack * 0.25, release * 0.25, srate);
     }
     else {
-        double lfosmooth = (double)params.getRawParameterValue("smooth")->load();
+        double lfosmooth = (double)registry.get(Param::smooth);
         lfosmooth *= lfosmooth * 0.25;
         revvalue->setup(lfosmooth * 0.25, lfosmooth * 0.25, srate);
         sendvalue->setup(lfosmooth * 0.25, lfosmooth * 0.25, srate);
@@ -1072,7 +1475,7 @@ void REEVRAudioProcessor::queuePattern(int patidx)
 {
     queuedPattern = patidx;
     queuedPatternCountdown = 0;
-    int patsync = (int)params.getRawParameterValue("patsync")->load();
+    int patsync = (int)registry.get(Param::patsync);
 
     if (playing && patsync != PatSync::Off) {
         int interval = samplesPerBeat;
@@ -1093,9 +1496,41 @@ bool REEVRAudioProcessor::supportsDoublePrecisionProcessing() const
     return false;
 }
 
+// hosts may send blocks longer than the samplesPerBlock given to prepareToPlay
+// those are processed in chunks so every buffer sized in prepareToPlay covers the chunk
 void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals disableDenormals;
+    RT_AUDIT_SCOPE(!isNonRealtime());
+
+    const int numSamples = buffer.getNumSamples();
+    if (numSamples <= preparedBlockSize) {
+        processChunk(buffer, midiMessages, 0);
+        return;
+    }
+
+    chunkMidiOut.clear();
+    for (int start = 0; start < numSamples; start += preparedBlockSize) {
+        const int count = std::min(preparedBlockSize, numSamples - start);
+        AudioBuffer<float> chunk(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, count);
+
+        chunkMidi.clear();
+        for (const auto metadata : midiMessages)
+            if (metadata.samplePosition >= start && metadata.samplePosition < start + count)
+                chunkMidi.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition - start);
+
+        processChunk(chunk, chunkMidi, start);
+
+        for (const auto metadata : chunkMidi)
+            chunkMidiOut.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition + start);
+    }
+    midiMessages.clear();
+    midiMessages.addEvents(chunkMidiOut, 0, -1, 0);
+}
+
+void REEVRAudioProcessor::processChunk(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages, int hostOffset)
+{
+    scratch.reset();
     int samplesPerBlock = getBlockSize();
     bool looping = false;
     double loopStart = 0.0;
@@ -1112,6 +1547,8 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
                 samplesPerBeat = (int)((60.0 / *tempo) * srate);
                 secondsPerBeat = 60.0 / *tempo;
             }
+            if (hostOffset > 0 && pos->getPpqPosition()) // chunks after the first start later than the playhead
+                ppqPosition += hostOffset * beatsPerSample;
             if (auto timeSig = pos->getTimeSignature()) {
                 secondsPerBar = secondsPerBeat * (*timeSig).numerator * (4.0 / (*timeSig).denominator);
             }
@@ -1132,7 +1569,7 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
             playing = play;
             if (playing) {
                 if (auto samples = pos->getTimeInSamples()) {
-                    timeInSamples = *samples;
+                    timeInSamples = *samples + hostOffset;
                 }
             }
         }
@@ -1147,32 +1584,37 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
     if (!audioInputs || !audioOutputs)
         return;
 
-    // load params
-    bool tsenabled = (bool)params.getRawParameterValue("tsenabled")->load();
-    int trigger = (int)params.getRawParameterValue("trigger")->load();
-    int sync = (int)params.getRawParameterValue("sync")->load();
-    float min = params.getRawParameterValue("min")->load();
-    float max = params.getRawParameterValue("max")->load();
-    float ratehz = params.getRawParameterValue("rate")->load();
-    float phase = params.getRawParameterValue("phase")->load();
-    float lowcut = params.getRawParameterValue("lowcut")->load();
-    float highcut = params.getRawParameterValue("highcut")->load();
-    int algo = (int)params.getRawParameterValue("algo")->load();
-    float threshold = params.getRawParameterValue("threshold")->load();
-    float sense = 1.0f - params.getRawParameterValue("sense")->load();
-    float revoffset = params.getRawParameterValue("revoffset")->load();
-    float sendoffset = params.getRawParameterValue("sendoffset")->load();
-    bool revenvon = (bool)params.getRawParameterValue("revenvon")->load();
-    bool sendenvon = (bool)params.getRawParameterValue("sendenvon")->load();
-    float revenvamt = params.getRawParameterValue("revenvamt")->load();
-    float sendenvamt = params.getRawParameterValue("sendenvamt")->load();
-    float drywet = params.getRawParameterValue("drywet")->load();
-    float width = params.getRawParameterValue("width")->load();
-    float irLowcut = params.getRawParameterValue("irlowcut")->load();
-    float irHighcut = params.getRawParameterValue("irhighcut")->load();
-    int predelay = (bool)params.getRawParameterValue("predelayusesync")->load()
+    if (isNonRealtime() != offline && loadState.load() == kIdle)
+        setOffline(isNonRealtime());
+
+    // load params, one snapshot per block so the loop never touches the atomics
+    registry.snapshot(paramBlock);
+    const auto& p = paramBlock;
+    bool tsenabled = (bool)p[Param::tsenabled];
+    int trigger = (int)p[Param::trigger];
+    int sync = (int)p[Param::sync];
+    float min = p[Param::min];
+    float max = p[Param::max];
+    float ratehz = p[Param::rate];
+    float phase = p[Param::phase];
+    float lowcut = p[Param::lowcut];
+    float highcut = p[Param::highcut];
+    int algo = (int)p[Param::algo];
+    float threshold = p[Param::threshold];
+    float sense = 1.0f - p[Param::sense];
+    float revoffset = p[Param::revoffset];
+    float sendoffset = p[Param::sendoffset];
+    bool revenvon = (bool)p[Param::revenvon];
+    bool sendenvon = (bool)p[Param::sendenvon];
+    float revenvamt = p[Param::revenvamt];
+    float sendenvamt = p[Param::sendenvamt];
+    float drywet = p[Param::drywet];
+    float width = p[Param::width];
+    float irLowcut = p[Param::irlowcut];
+    float irHighcut = p[Param::irhighcut];
+    int predelay = (bool)p[Param::predelayusesync]
         ? getPredelaySync()
-        : (int)(params.getRawParameterValue("predelay")->load() / 1000.f * srate);
+        : (int)(p[Param::predelay] / 1000.f * srate);
 
     if (ldrywet != drywet) {
         ldrywet = drywet;
@@ -1181,50 +1623,27 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
         wetgain = std::sin(theta);
     }
 
-    if (predelay > delayBuffer.getNumSamples()) {
-        delayBuffer.setSize(2, predelay * 2);
-        delayBuffer.clear();
-        delaypos = 0;
-    }
+    predelayLine.setDelay((float)predelay);
 
     sense *= sense; // make audio trigger sensitivity more responsive
 
-    // process viewport background display wave samples
+    // process viewport background display wave samples, only while the view is attached
+    bool drawDisplay = !offline && viewTap.isActive();
     auto processDisplaySample = [&](double xpos, float prelsamp, float prersamp, float postlsamp, float postrsamp) {
         auto preamp = std::max(std::fabs(prelsamp), std::fabs(prersamp));
         auto postamp = std::max(std::fabs(postlsamp), std::fabs(postrsamp));
-        winpos = (int)std::floor(xpos * viewW);
-        if (lwinpos != winpos) {
-            preSamples[winpos] = 0.0;
-            postSamples[winpos] = 0.0;
-        }
-        lwinpos = winpos;
-        if (preSamples[winpos] < preamp)
-            preSamples[winpos] = preamp;
-        if (postSamples[winpos] < postamp)
-            postSamples[winpos] = postamp;
+        viewTap.process((float)xpos, preamp, postamp);
     };
 
     // process audio monitor samples
-    float monIncrementPerSample = 1.0f / float((srate * 4) / monW); // 2 seconds of audio displayed on monitor
+    bool drawMonitor = !offline && monitorTap.isActive();
+    double monIncrementPerSample = 1.0 / (srate * 4); // 4 seconds of audio displayed on monitor
     auto processMonitorSample = [&](float lsamp, float rsamp, bool hit) {
-        float indexd = monpos.load();
-        indexd += monIncrementPerSample;
-
-        if (indexd >= monW)
-            indexd -= monW;
-
-        int index = (int)indexd;
-        if (lmonpos != index)
-            monSamples[index] = 0.0;
-        lmonpos = index;
-
-        float maxamp = std::max(std::fabs(lsamp), std::fabs(rsamp));
-        if (hit || monSamples[index] >= 10.0)
-            maxamp = std::max(maxamp + 10.0f, lastHitAmplitude + 10.0f); // encode hits by adding +10 to amp
-
-        monSamples[index] = std::max(monSamples[index], maxamp);
-        monpos.store(indexd);
+        if (!drawMonitor) return;
+        monPhase += monIncrementPerSample;
+        if (monPhase >= 1.0)
+            monPhase -= 1.0;
+        monitorTap.process((float)monPhase, std::max(std::fabs(lsamp), std::fabs(rsamp)), 0.f, hit);
     };
 
     if (paramChanged) {
@@ -1241,7 +1660,7 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
     for (const auto metadata : midiMessages) {
         juce::MidiMessage message = metadata.getMessage();
         if (message.isNoteOn() || message.isNoteOff()) {
-            midiIn.push_back({ // queue midi message
+            midiIn.push({ // queue midi message, dropped if the queue is full
                 metadata.samplePosition,
                 message.isNoteOn(),
                 message.getNoteNumber(),
@@ -1253,22 +1672,17 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
     midiMessages.clear();
 
     // Process midi out queue
-    for (auto it = midiOut.begin(); it != midiOut.end();) {
-        auto& [msg, offset] = *it;
-        if (offset < samplesPerBlock) {
-            midiMessages.addEvent(msg, offset);
-            it = midiOut.erase(it);
+    size_t pending = 0;
+    for (auto& out : midiOut) {
+        if (out.offset < samplesPerBlock) {
+            midiMessages.addEvent(out.msg, out.offset);
         }
         else {
-            offset -= samplesPerBlock;
-            ++it;
+            out.offset -= samplesPerBlock;
+            midiOut[pending++] = out; // compact in place
         }
     }
-
-    // remove midi in messages that have been processed
-    midiIn.erase(std::remove_if(midiIn.begin(), midiIn.end(), [](const MidiInMsg& msg) {
-        return msg.offset < 0;
-    }), midiIn.end());
+    midiOut.erase(midiOut.begin() + pending, midiOut.end());
 
     // update outputs with last block information at the start of the new block
     if (outputCC > 0) {
@@ -1321,7 +1735,7 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
             {
                 transDetectorL.startCooldown();
                 transDetectorR.startCooldown();
-                int offset = (int)(params.getRawParameterValue("offset")->load() * LATENCY_MILLIS / 1000.f * srate);
+                int offset = (int)(p[Param::offset] * LATENCY_MILLIS / 1000.f * srate);
                 audioTriggerCountdown = (sample + std::max(0, getLatencySamples() + offset));
                 lastHitAmplitude = transDetectorL.hit ? std::fabs(monSampleL) : std::fabs(monSampleR);
                 processMonitorSample(monSampleL, monSampleR, true);
@@ -1391,279 +1805,296 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
         }
     }
 
-    // ================================================= MAIN PROCESSING LOOP
+    // pattern envelopes are read every envRate samples and interpolated in between, the smoothers run per sample
+    // patterns with clear tails points are read per sample so the crossings stay sample accurate
+    auto processEnvelopes = [&](int sample) {
+        const int envStep = pattern->hasClearTails.load(std::memory_order_relaxed) ? 1 : envRate;
+        if (envPhase % envStep == 0) {
+            // read envelope follower offset contribution
+            auto roffset = revoffset;
+            auto soffset = sendoffset;
+            if (revenvon)
+                roffset += revenvBuffer[sample] * revenvamt;
+            if (sendenvon)
+                soffset += sendenvBuffer[sample] * sendenvamt;
 
-    for (int sample = 0; sample < numSamples; ++sample) {
-        if (playing && looping && beatPos >= loopEnd && trigger != Trigger::Free) {
-            beatPos = loopStart + (beatPos - loopEnd);
-            ratePos = beatPos * secondsPerBeat * ratehz;
+            double ypos = getYRev(xpos, min, max, roffset);
+            double ysendpos = getYSend(xpos, min, max, soffset);
+            if (envStep == 1) {
+                revtarget.reset(ypos);
+                sendtarget.reset(ysendpos);
+            }
+            else {
+                revtarget.push(ypos);
+                sendtarget.push(ysendpos);
+            }
+            envPhase = 0;
         }
 
-        // process midi in queue
-        for (auto& msg : midiIn) {
-            if (msg.offset == 0) {
-                if (msg.isNoteon) {
-                    if (msg.channel == triggerChn || triggerChn == 16) {
-                        auto patidx = msg.note % 12;
-                        queuePattern(patidx + 1);
+        double t = (double)envPhase / envStep;
+        double newypos = revtarget.at(t, envCubic);
+        yrev = revvalue->process(newypos, newypos > yrev);
+        double newysend = sendtarget.at(t, envCubic);
+        ysend = sendvalue->process(newysend, newysend > ysend);
+        envPhase = (envPhase + 1) % envStep;
+    };
+
+    // ================================================= MAIN PROCESSING LOOP
+
+    for (int sample = 0; sample < numSamples;) {
+        // midi events due at this sample, the block is split at every event boundary
+        midiIn.dispatch(sample, [&](const MidiInMsg& msg) {
+            if (msg.isNoteon) {
+                if (msg.channel == triggerChn || triggerChn == 16) {
+                    auto patidx = msg.note % 12;
+                    queuePattern(patidx + 1);
+                }
+                if (msg.channel == slotChn || slotChn == 16) {
+                    queueSlot(msg.note % IR_SLOTS);
+                }
+                if (trigger == Trigger::MIDI && (msg.channel == midiTriggerChn || midiTriggerChn == 16)) {
+                    if (queuedPattern) {
+                        queuedMidiTrigger = true;
                     }
-                    if (trigger == Trigger::MIDI && (msg.channel == midiTriggerChn || midiTriggerChn == 16)) {
-                        if (queuedPattern) {
-                            queuedMidiTrigger = true;
-                        }
-                        else {
-                            startMidiTrigger();
-                        }
+                    else {
+                        startMidiTrigger();
                     }
                 }
             }
-            msg.offset -= 1;
-        }
+        });
 
         // process queued pattern
-        if (queuedPattern) {
-            if (!playing || queuedPatternCountdown == 0) {
-                if (sequencer->isOpen) {
-                    sequencer->close(); // sync call (required)
-                    setUIMode(UIMode::Normal); // async call
-                }
-                pattern->shouldClearTails = false;
-                pattern = patterns[queuedPattern - 1];
-                sendpattern = sendpatterns[queuedPattern - 1];
-                viewPattern = sendEditMode ? sendpattern : pattern;
-                viewSubPattern = sendEditMode ? pattern : sendpattern;
-                auto tension = (double)params.getRawParameterValue("tension")->load();
-                auto tensionatk = (double)params.getRawParameterValue("tensionatk")->load();
-                auto tensionrel = (double)params.getRawParameterValue("tensionrel")->load();
-                pattern->setTension(tension, tensionatk, tensionrel, dualTension);
-                pattern->buildSegments();
-                sendpattern->setTension(tension, tensionatk, tensionrel, dualTension);
-                sendpattern->buildSegments();
-                updateReverbFromPattern();
-                updateSendFromPattern();
-                MessageManager::callAsync([this]() { sendChangeMessage();});
-                queuedPattern = 0;
-                if (queuedMidiTrigger) {
-                    queuedMidiTrigger = false;
-                    startMidiTrigger();
-                }
+        if (queuedPattern && (!playing || queuedPatternCountdown <= 0)) {
+            if (sequencer->isOpen) {
+                RT_AUDIT_BLOCKING("Sequencer::close");
+                sequencer->close(); // sync call (required)
+                setUIMode(UIMode::Normal); // async call
             }
-            if (queuedPatternCountdown > 0) {
-                queuedPatternCountdown -= 1;
+            pattern->shouldClearTails = false;
+            pattern = patterns[queuedPattern - 1];
+            sendpattern = sendpatterns[queuedPattern - 1];
+            viewPattern = sendEditMode ? sendpattern : pattern;
+            viewSubPattern = sendEditMode ? pattern : sendpattern;
+            auto tension = (double)p[Param::tension];
+            auto tensionatk = (double)p[Param::tensionatk];
+            auto tensionrel = (double)p[Param::tensionrel];
+            pattern->setTension(tension, tensionatk, tensionrel, dualTension);
+            pattern->buildSegments();
+            sendpattern->setTension(tension, tensionatk, tensionrel, dualTension);
+            sendpattern->buildSegments();
+            updateReverbFromPattern();
+            updateSendFromPattern();
+            sendChangeMessage();
+            queuedPattern = 0;
+            if (queuedMidiTrigger) {
+                queuedMidiTrigger = false;
+                startMidiTrigger();
             }
         }
 
-        // Sync mode
-        if (trigger == Trigger::Sync || trigger == Trigger::Free) {
-            xpos = sync > 0
-                ? beatPos / syncQN + phase
-                : ratePos + phase;
-            xpos -= std::floor(xpos);
-
-            // read envelope follower offset contribution
-            auto roffset = revoffset;
-            auto soffset = sendoffset;
-            if (revenvon)
-                roffset += revenvBuffer[sample] * revenvamt;
-            if (sendenvon)
-                soffset += sendenvBuffer[sample] * sendenvamt;
+        // the sub range runs until the next midi event or the queued pattern switch
+        int end = midiIn.nextOffset(numSamples);
+        if (queuedPattern)
+            end = (int)std::min((int64_t)end, sample + queuedPatternCountdown);
+        end = std::max(end, sample + 1);
+        if (queuedPattern) // floored, the sub range is at least one sample long even when the switch is due now
+            queuedPatternCountdown = std::max((int64_t)0, queuedPatternCountdown - (end - sample));
+
+        for (; sample < end; ++sample) {
+            if (playing && looping && beatPos >= loopEnd && trigger != Trigger::Free) {
+                beatPos = loopStart + (beatPos - loopEnd);
+                ratePos = beatPos * secondsPerBeat * ratehz;
+            }
 
+            // Sync mode
+            if (trigger == Trigger::Sync || trigger == Trigger::Free) {
+                xpos = sync > 0
+                    ? beatPos / syncQN + phase
+                    : ratePos + phase;
+                xpos -= std::floor(xpos);
 
-            double newypos = getYRev(xpos, min, max, roffset);
-            yrev = revvalue->process(newypos, newypos > yrev);
-            double newysend = getYSend(xpos, min, max, soffset);
-            ysend = sendvalue->process(newysend, newysend > ysend);
+                processEnvelopes(sample);
 
-            yrevBuffer[sample] = (float)yrev;
-            ysendBuffer[sample] = (float)ysend;
-            xposBuffer[sample] = (float)xpos;
-            //processDisplaySample(sample, xpos, lsample, rsample);
-        }
+                yrevBuffer[sample] = (float)yrev;
+                ysendBuffer[sample] = (float)ysend;
+                xposBuffer[sample] = (float)xpos;
+                //processDisplaySample(sample, xpos, lsample, rsample);
+            }
 
-        // MIDI mode
-        else if (trigger == Trigger::MIDI) {
-            auto inc = sync > 0
-                ? beatsPerSample / syncQN
-                : 1 / srate * ratehz;
-            xpos += inc;
-            trigpos += inc;
-            xpos -= std::floor(xpos);
-
-            if (!alwaysPlaying) {
-                if (midiTrigger) {
-                    if (trigpos >= 1.0) { // envelope finished, stop midiTrigger
-                        midiTrigger = false;
-                        xpos = phase ? phase : 1.0;
+            // MIDI mode
+            else if (trigger == Trigger::MIDI) {
+                auto inc = sync > 0
+                    ? beatsPerSample / syncQN
+                    : 1 / srate * ratehz;
+                xpos += inc;
+                trigpos += inc;
+                xpos -= std::floor(xpos);
+
+                if (!alwaysPlaying) {
+                    if (midiTrigger) {
+                        if (trigpos >= 1.0) { // envelope finished, stop midiTrigger
+                            midiTrigger = false;
+                            xpos = phase ? phase : 1.0;
+                        }
+                    }
+                    else {
+                        xpos = phase ? phase : 1.0; // midiTrigger is stopped, hold last position
                     }
                 }
-                else {
-                    xpos = phase ? phase : 1.0; // midiTrigger is stopped, hold last position
-                }
-            }
 
-            // read envelope follower offset contribution
-            auto roffset = revoffset;
-            auto soffset = sendoffset;
-            if (revenvon)
-                roffset += revenvBuffer[sample] * revenvamt;
-            if (sendenvon)
-                soffset += sendenvBuffer[sample] * sendenvamt;
-
-            double newypos = getYRev(xpos, min, max, roffset);
-            yrev = revvalue->process(newypos, newypos > yrev);
-            double newysend = getYSend(xpos, min, max, soffset);
-            ysend = sendvalue->process(newysend, newysend > ysend);
-            double viewx = (alwaysPlaying || midiTrigger) ? xpos : (trigpos + trigphase) - std::floor(trigpos + trigphase);
+                processEnvelopes(sample);
+                double viewx = (alwaysPlaying || midiTrigger) ? xpos : (trigpos + trigphase) - std::floor(trigpos + trigphase);
 
-            yrevBuffer[sample] = (float)yrev;
-            ysendBuffer[sample] = (float)ysend;
-            xposBuffer[sample] = (float)viewx;
-        }
-
-        // Audio mode
-        else if (trigger == Trigger::Audio) {
-            // read the sample 'latency' samples ago
-            int latency = (int)latBufferL.size();
-            int readPos = (latpos + latency - 1) % latency;
-            latBufferL[latpos] = buffer.getSample(0, sample);
-            latBufferR[latpos] = buffer.getSample(1, sample);
-            auto lsample = latBufferL[readPos];
-            auto rsample = latBufferR[readPos];
-
-            // write delayed samples to buffer to later apply dry/wet mix
-            for (int channel = 0; channel < 2; ++channel) {
-                buffer.setSample(channel, sample, channel == 0 ? lsample : rsample);
+                yrevBuffer[sample] = (float)yrev;
+                ysendBuffer[sample] = (float)ysend;
+                xposBuffer[sample] = (float)viewx;
             }
 
-            auto hit = audioTriggerCountdown == 0; // there was an audio transient trigger in this sample
-
-            // envelope processing
-            auto inc = sync > 0
-                ? beatsPerSample / syncQN
-                : 1 / srate * ratehz;
-            xpos += inc;
-            trigpos += inc;
-            trigposSinceHit += inc;
-            xpos -= std::floor(xpos);
+            // Audio mode
+            else if (trigger == Trigger::Audio) {
+                // read the sample 'latency' samples ago
+                int latency = (int)latBufferL.size();
+                int readPos = (latpos + latency - 1) % latency;
+                latBufferL[latpos] = buffer.getSample(0, sample);
+                latBufferR[latpos] = buffer.getSample(1, sample);
+                auto lsample = latBufferL[readPos];
+                auto rsample = latBufferR[readPos];
+
+                // write delayed samples to buffer to later apply dry/wet mix
+                for (int channel = 0; channel < 2; ++channel) {
+                    buffer.setSample(channel, sample, channel == 0 ? lsample : rsample);
+                }
 
-            // send output midi notes on audio trigger hit
-            if (hit && outputATMIDI > 0) {
-                auto noteOn = MidiMessage::noteOn(1, outputATMIDI - 1, (float)lastHitAmplitude);
-                midiMessages.addEvent(noteOn, sample);
+                auto hit = audioTriggerCountdown == 0; // there was an audio transient trigger in this sample
 
-                auto offnoteDelay = static_cast<int>(srate * AUDIO_NOTE_LENGTH_MILLIS / 1000.0);
-                int noteOffSample = sample + offnoteDelay;
-                auto noteOff = MidiMessage::noteOff(1, outputATMIDI - 1);
+                // envelope processing
+                auto inc = sync > 0
+                    ? beatsPerSample / syncQN
+                    : 1 / srate * ratehz;
+                xpos += inc;
+                trigpos += inc;
+                trigposSinceHit += inc;
+                xpos -= std::floor(xpos);
 
-                if (noteOffSample < samplesPerBlock) {
-                    midiMessages.addEvent(noteOff, noteOffSample);
-                }
-                else {
-                    int offset = noteOffSample - samplesPerBlock;
-                    midiOut.push_back({ noteOff, offset });
-                }
-            }
+                // send output midi notes on audio trigger hit
+                if (hit && outputATMIDI > 0) {
+                    auto noteOn = MidiMessage::noteOn(1, outputATMIDI - 1, (float)lastHitAmplitude);
+                    midiMessages.addEvent(noteOn, sample);
 
-            if (hit && (alwaysPlaying || !audioIgnoreHitsWhilePlaying || trigposSinceHit > 0.98)) {
-                clearWaveBuffers();
-                audioTrigger = !alwaysPlaying;
-                trigpos = 0.0;
-                trigphase = phase;
-                trigposSinceHit = 0.0;
-                restartEnv(true);
-            }
+                    auto offnoteDelay = static_cast<int>(srate * AUDIO_NOTE_LENGTH_MILLIS / 1000.0);
+                    int noteOffSample = sample + offnoteDelay;
+                    auto noteOff = MidiMessage::noteOff(1, outputATMIDI - 1);
 
-            if (!alwaysPlaying) {
-                if (audioTrigger) {
-                    if (trigpos >= 1.0) { // envelope finished, stop trigger
-                        audioTrigger = false;
-                        xpos = phase ? phase : 1.0;
+                    if (noteOffSample < samplesPerBlock) {
+                        midiMessages.addEvent(noteOff, noteOffSample);
+                    }
+                    else if (midiOut.size() < midiOut.capacity()) {
+                        int offset = noteOffSample - samplesPerBlock;
+                        midiOut.push_back({ noteOff, offset });
                     }
                 }
-                else {
-                    xpos = phase ? phase : 1.0; // audioTrigger is stopped, hold last position
+
+                if (hit && (alwaysPlaying || !audioIgnoreHitsWhilePlaying || trigposSinceHit > 0.98)) {
+                    clearWaveBuffers();
+                    audioTrigger = !alwaysPlaying;
+                    trigpos = 0.0;
+                    trigphase = phase;
+                    trigposSinceHit = 0.0;
+                    restartEnv(true);
                 }
-            }
 
-            // read envelope follower offset contribution
-            auto roffset = revoffset;
-            auto soffset = sendoffset;
-            if (revenvon)
-                roffset += revenvBuffer[sample] * revenvamt;
-            if (sendenvon)
-                soffset += sendenvBuffer[sample] * sendenvamt;
+                if (!alwaysPlaying) {
+                    if (audioTrigger) {
+                        if (trigpos >= 1.0) { // envelope finished, stop trigger
+                            audioTrigger = false;
+                            xpos = phase ? phase : 1.0;
+                        }
+                    }
+                    else {
+                        xpos = phase ? phase : 1.0; // audioTrigger is stopped, hold last position
+                    }
+                }
 
-            double newypos = getYRev(xpos, min, max, roffset);
-            yrev = revvalue->process(newypos, newypos > yrev);
-            double newysend = getYSend(xpos, min, max, soffset);
-            ysend = sendvalue->process(newysend, newysend > ysend);
-            double viewx = (alwaysPlaying || audioTrigger) ? xpos : (trigpos + trigphase) - std::floor(trigpos + trigphase);
+                processEnvelopes(sample);
+                double viewx = (alwaysPlaying || audioTrigger) ? xpos : (trigpos + trigphase) - std::floor(trigpos + trigphase);
 
-            yrevBuffer[sample] = (float)yrev;
-            ysendBuffer[sample] = (float)ysend;
-            xposBuffer[sample] = (float)viewx;
+                yrevBuffer[sample] = (float)yrev;
+                ysendBuffer[sample] = (float)ysend;
+                xposBuffer[sample] = (float)viewx;
 
-            latpos = (latpos + 1) % latency;
+                latpos = (latpos + 1) % latency;
 
-            if (audioTriggerCountdown > -1)
-                audioTriggerCountdown -= 1;
-        }
+                if (audioTriggerCountdown > -1)
+                    audioTriggerCountdown -= 1;
+            }
 
-        xenv.store(xpos);
-        yenv.store(sendEditMode ? ysend : yrev);
-        beatPos += beatsPerSample;
-        ratePos += 1 / srate * ratehz;
-        if (playing)
-            timeInSamples += 1;
+            xenv.store(xpos);
+            yenv.store(sendEditMode ? ysend : yrev);
+            beatPos += beatsPerSample;
+            ratePos += 1 / srate * ratehz;
+            if (playing)
+                timeInSamples += 1;
 
-        if (pattern->shouldClearTails) {
-            if (clearTailsCooldown == 0) {
-                clearTails = true;
+            if (pattern->shouldClearTails) {
+                if (clearTailsCooldown == 0) {
+                    clearTails = true;
+                }
+                clearTailsCooldown = int(CONV_CLEAR_TAILS_COOLDOWN / 1000.0 * srate);
+            }
+            if (clearTailsCooldown > 0) {
+                clearTailsCooldown -= 1;
             }
-            clearTailsCooldown = int(CONV_CLEAR_TAILS_COOLDOWN / 1000.0 * srate);
-        }
-        if (clearTailsCooldown > 0) {
-            clearTailsCooldown -= 1;
         }
-
     } // ============================================== END OF SAMPLES PROCESSING
+    midiIn.endBlock(numSamples);
 
     drawSeek.store(playing && (trigger == Trigger::Sync || midiTrigger || audioTrigger)); // informs UI if it should seek or not, typically only during play
 
     // with the envelopes processed, mix the envelope signals into wet and finally dry wet signal
     wetBuffer.clear();
-    sendBuffer.clear();
     auto lchannel = buffer.getReadPointer(0);
     auto rchannel = buffer.getReadPointer(audioInputs > 1 ? 1 : 0);
 
-    // process send envelope
-    for (int sample = 0; sample < numSamples; ++sample) {
-        auto lin = lchannel[sample] * ysendBuffer[sample];
-        auto rin = rchannel[sample] * ysendBuffer[sample];
+    // process send envelope, the gain is one vector pass and the recursive IR filters run in place
+    const int sendChannels = std::max(2, std::min(sendBuffer.getNumChannels(), audioInputs));
+    auto* lsend = sendBuffer.getWritePointer(0);
+    auto* rsend = sendBuffer.getWritePointer(1);
+    FloatVectorOperations::multiply(lsend, lchannel, ysendBuffer.data(), numSamples);
+    FloatVectorOperations::multiply(rsend, rchannel, ysendBuffer.data(), numSamples);
+    if (irLowcut > 20.f)
+        irLowcutLR.process(lsend, rsend, numSamples);
+    if (irHighcut < 20000.f)
+        irHighcutLR.process(lsend, rsend, numSamples);
+    for (int ch = 2; ch < sendChannels; ++ch) {
+        auto* send = sendBuffer.getWritePointer(ch);
+        auto& lowcut = irLowcutS[ch - 2];
+        auto& highcut = irHighcutS[ch - 2];
+        FloatVectorOperations::multiply(send, buffer.getReadPointer(ch), ysendBuffer.data(), numSamples);
         if (irLowcut > 20.f) {
-            lin = irLowcutL.eval(lin);
-            rin = irLowcutR.eval(rin);
+            for (int sample = 0; sample < numSamples; ++sample)
+                send[sample] = lowcut.eval(send[sample]);
         }
         if (irHighcut < 20000.f) {
-            lin = irHighcutL.eval(lin);
-            rin = irHighcutR.eval(rin);
+            for (int sample = 0; sample < numSamples; ++sample)
+                send[sample] = highcut.eval(send[sample]);
         }
-        sendBuffer.setSample(0, sample, lin);
-        sendBuffer.setSample(1, sample, rin);
+    }
+    for (int ch = sendChannels; ch < sendBuffer.getNumChannels(); ++ch) {
+        sendBuffer.clear(ch, 0, numSamples);
     }
 
     // process convolver warmer
     // warmer is a simple circular buffer that stores the last second of audio
     int spaceToEnd = warmer.getNumSamples() - warmwritepos;
-    if (numSamples <= spaceToEnd) {
-        warmer.copyFrom(0, warmwritepos, sendBuffer, 0, 0, numSamples);
-        warmer.copyFrom(1, warmwritepos, sendBuffer, audioInputs > 1 ? 1 : 0, 0, numSamples);
-    }
-    else {
-        warmer.copyFrom(0, warmwritepos, sendBuffer, 0, 0, spaceToEnd);
-        warmer.copyFrom(0, 0, sendBuffer, 0, spaceToEnd, numSamples - spaceToEnd);
-        warmer.copyFrom(1, warmwritepos, sendBuffer, audioInputs > 1 ? 1 : 0, 0, spaceToEnd);
-        warmer.copyFrom(1, 0, sendBuffer, audioInputs > 1 ? 1 : 0, spaceToEnd, numSamples - spaceToEnd);
+    for (int ch = 0; ch < warmer.getNumChannels(); ++ch) {
+        int src = ch == 1 && audioInputs < 2 ? 0 : ch;
+        if (numSamples <= spaceToEnd) {
+            warmer.copyFrom(ch, warmwritepos, sendBuffer, src, 0, numSamples);
+        }
+        else {
+            warmer.copyFrom(ch, warmwritepos, sendBuffer, src, 0, spaceToEnd);
+            warmer.copyFrom(ch, 0, sendBuffer, src, spaceToEnd, numSamples - spaceToEnd);
+        }
     }
     warmwritepos = (warmwritepos + numSamples) %  warmer.getNumSamples();
 
@@ -1672,80 +2103,118 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
 
     // IR load state machine
     // if loadstate is idle and there is an update reload the IR into the load convolver
+    // a draft IR is replaced by the full build once the gestures end, offline renders never keep drafts
+    if (irDraftLoaded && (irGestures.load() == 0 || isNonRealtime())) {
+        irDraftLoaded = false;
+        irDirty = true;
+    }
+
     if (irDirty && loadState.load() == kIdle && loadCooldown <= 0 && !isLoadingPluginState) {
-        loadCooldown = (int)(CONV_LOAD_COOLDOWN / 1000.0 * srate);
+        loadCooldown = offline ? 0 : (int)(CONV_LOAD_COOLDOWN / 1000.0 * srate);
         irDirty = false;
         loadState.store(kLoading);
+        bool draft = irGestures.load() > 0 && !isNonRealtime();
+        irDraftLoaded = draft;
 
-        threadPool.addJob([this, numSamples]() {
-            if (impulse->path != irFile.toStdString()) {
-                impulse->load(irFile);
-                irFile = String(impulse->path);
-            }
-            else {
-                impulse->recalcImpulse();
-            }
-            sendChangeMessage();
-            loadConvolver->loadImpulse(*impulse);
+        loadDraft = draft;
+        runLoadJob(&REEVRAudioProcessor::loadImpulseTask);
+    }
+
+    // rebuild the IR slot bank once the IR settings settled
+    if (!irDirty && !irDraftLoaded && loadState.load() == kIdle && loadCooldown <= 0 && !isLoadingPluginState && slotsDirty.exchange(false)) {
+        loadState.store(kLoadingSlots);
+        runLoadJob(&REEVRAudioProcessor::loadSlotBank);
+    }
+
+    // swap the new bank in, the replaced slots are freed off the audio thread
+    if (loadState.load() == kSlotsReady) {
+        for (int i = 0; i < IR_SLOTS; ++i)
+            if (i != activeSlot)
+                std::swap(slots[i], pendingSlots[i]);
+        releaseOldImpulses();
+    }
+
+    // switch to a preloaded slot, the slot convolver is handed over as the load convolver
+    // so the crossfade below reuses the regular IR load path without decoding or recalculating
+    int slot = queuedSlot.load();
+    if (slot >= 0 && loadState.load() == kIdle) {
+        queuedSlot.store(-1);
+        if (slot != activeSlot && slots[slot]) {
+            std::swap(loadConvolver, slots[slot]);
+            fadingSlot = slot;
             loadState.store(kReady);
-        });
+        }
     }
 
-    // if new IR is loaded, warmup load convolver and begin crossfade with current convolver
+    // morph position, smoothed per block, the convolvers pick it up at their next partition
+    float morphTarget = (int)p[Param::irmorphsrc] == 1
+        ? yrevBuffer[std::max(0, numSamples - 1)]
+        : p[Param::irmorph];
+    float morphCoeff = std::exp(-numSamples / (float)(MORPH_SMOOTH_MS / 1000.0 * srate));
+    morphPos = morphTarget + morphCoeff * (morphPos - morphTarget);
+    convolver->setMorphPosition(morphPos);
+    if (loadState.load() == kReady || loadState.load() == kFading)
+        loadConvolver->setMorphPosition(morphPos);
+
+    // imposed tail decay, applied as per partition gains so modulating it never reloads the IR
+    int decaySrc = (int)p[Param::taildecaysrc];
+    float decayTarget = p[Param::taildecay];
+    if (decaySrc == 1) decayTarget *= yrevBuffer[std::max(0, numSamples - 1)];
+    if (decaySrc == 2) decayTarget *= revenvBuffer[std::max(0, numSamples - 1)];
+    float decayCoeff = std::exp(-numSamples / (float)(TAIL_DECAY_SMOOTH_MS / 1000.0 * srate));
+    tailDecay = decayTarget + decayCoeff * (tailDecay - decayTarget);
+    float decayGain = (float)std::pow(10.0, -TAIL_DECAY_MAX_DB_S * tailDecay * tailDecay / 20.0 / srate);
+    convolver->setDecay(decayGain);
+    if (loadState.load() == kReady || loadState.load() == kFading)
+        loadConvolver->setDecay(decayGain);
+
+    // if new IR is loaded and fits the current engine, crossfade inside it
+    // the input spectra are shared so the new IR needs no warmup and no second convolver pass
+    if (loadState.load() == kReady && convolver->beginFade(*loadConvolver)) {
+        loadState.store(kFadingShared);
+        xfade = (int)std::ceil(srate * CONV_XFADE / 1000.0);
+        xfadelen = xfade;
+    }
+
+    // otherwise warmup load convolver and begin crossfade with current convolver
     if (loadState.load() == kReady) {
-        // warmup convolver
-        int numBlocks = warmer.getNumSamples() / convolver->size;
+        // warmup convolver, slot convolvers may still hold input from when they were active
+        loadConvolver->clear();
+        auto chunk = scratch.getBuffer(warmer.getNumChannels(), convolver->size);
+        int numBlocks = chunk.getNumChannels() > 0 ? warmer.getNumSamples() / convolver->size : 0;
         int start = (warmwritepos + 1) % warmer.getNumSamples();
-        AudioBuffer<float> chunk;
-        chunk.setSize(2, convolver->size);
 
         // prepare warmer filters
-        auto irlowcut = params.getRawParameterValue("irlowcut")->load();
-        auto irhighcut = params.getRawParameterValue("irhighcut")->load();
-        auto irlowcutSlope = (int)params.getRawParameterValue("irlowcutslope")->load();
-        auto irhighcutSlope = (int)params.getRawParameterValue("irhighcutslope")->load();
-        warmerLowcutL.setSlope((FilterSlope)irlowcutSlope); warmerLowcutL.reset(0.0f);
-        warmerLowcutR.setSlope((FilterSlope)irlowcutSlope); warmerLowcutR.reset(0.0f);
-        warmerHighcutL.setSlope((FilterSlope)irhighcutSlope); warmerHighcutL.reset(0.0f);
-        warmerHighcutR.setSlope((FilterSlope)irhighcutSlope); warmerHighcutR.reset(0.0f);
-        warmerLowcutL.init((float)srate, irlowcut, irLowcutL.slope == k24dB ? 0.0765f : 0.2929f);
-        warmerLowcutR.init((float)srate, irlowcut, irLowcutR.slope == k24dB ? 0.0765f : 0.2929f);
-        warmerHighcutL.init((float)srate, irhighcut, irHighcutL.slope == k24dB ? 0.0765f : 0.2929f);
-        warmerHighcutR.init((float)srate, irhighcut, irHighcutL.slope == k24dB ? 0.0765f : 0.2929f);
+        auto irlowcutSlope = (int)p[Param::irlowcutslope];
+        auto irhighcutSlope = (int)p[Param::irhighcutslope];
+        warmerLowcutLR.setSlope((FilterSlope)irlowcutSlope); warmerLowcutLR.reset(0.0f);
+        warmerHighcutLR.setSlope((FilterSlope)irhighcutSlope); warmerHighcutLR.reset(0.0f);
+        warmerLowcutLR.init((float)srate, irLowcut, irLowcutLR.slope == k24dB ? 0.0765f : 0.2929f);
+        warmerHighcutLR.init((float)srate, irHighcut, irHighcutLR.slope == k24dB ? 0.0765f : 0.2929f);
 
         // copy warmup buffer in chunks into the new convolver
         for (int i = 0; i < numBlocks; ++i) {
             int end = (start + convolver->size) % warmer.getNumSamples();
 
-            if (start < end) {
-                chunk.copyFrom(0, 0, warmer, 0, start, convolver->size);
-                chunk.copyFrom(1, 0, warmer, 1, start, convolver->size);
-            } else {
-                int toEnd = warmer.getNumSamples() - start;
-                int remaining = convolver->size - toEnd;
-
-                chunk.copyFrom(0, 0, warmer, 0, start, toEnd);
-                chunk.copyFrom(1, 0, warmer, 1, start, toEnd);
-                chunk.copyFrom(0, toEnd, warmer, 0, 0, remaining);
-                chunk.copyFrom(1, toEnd, warmer, 1, 0, remaining);
-            }
+            for (int ch = 0; ch < chunk.getNumChannels(); ++ch) {
+                if (start < end) {
+                    chunk.copyFrom(ch, 0, warmer, ch, start, convolver->size);
+                } else {
+                    int toEnd = warmer.getNumSamples() - start;
+                    int remaining = convolver->size - toEnd;
 
-            for (int spl = 0; spl < convolver->size; ++spl) {
-                auto lspl = chunk.getSample(0, spl);
-                auto rspl = chunk.getSample(1, spl);
-                if (irlowcut > 20.f) {
-                    lspl = warmerLowcutL.eval(lspl);
-                    rspl = warmerLowcutR.eval(rspl);
-                }
-                if (irhighcut < 20000.f) {
-                    lspl = warmerHighcutL.eval(lspl);
-                    rspl = warmerHighcutR.eval(rspl);
+                    chunk.copyFrom(ch, 0, warmer, ch, start, toEnd);
+                    chunk.copyFrom(ch, toEnd, warmer, ch, 0, remaining);
                 }
-                chunk.setSample(0, spl, lspl);
-                chunk.setSample(1, spl, rspl);
             }
 
-            loadConvolver->process(chunk.getReadPointer(0, 0), chunk.getReadPointer(1, 0), convolver->size, true);
+            if (irLowcut > 20.f)
+                warmerLowcutLR.process(chunk.getWritePointer(0), chunk.getWritePointer(1), convolver->size);
+            if (irHighcut < 20000.f)
+                warmerHighcutLR.process(chunk.getWritePointer(0), chunk.getWritePointer(1), convolver->size);
+
+            // surround channels warm up unfiltered, the IR filters only shape the tail being faded in
+            processConvolver(*loadConvolver, chunk, convolver->size, true);
             start = (start + convolver->size) % warmer.getNumSamples();
         }
 
@@ -1763,149 +2232,104 @@ void REEVRAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
         clearTails = false;
     }
 
-    // predelay
-    int delaySize = delayBuffer.getNumSamples();
-    for (int channel = 0; channel < 2; ++channel) {
-        auto* delayWrite = delayBuffer.getWritePointer(channel);
-        auto* sendRead = sendBuffer.getReadPointer(channel);
-
-        for (int i = 0; i < numSamples; ++i) {
-            int index = (delaypos + i) % delaySize;
-            delayWrite[index] = sendRead[i];
-        }
+    // predelay, optionally scaled by the reverb pattern
+    auto delayedBuffer = scratch.getBuffer(predelayLine.getNumChannels(), numSamples, false);
+    const AudioBuffer<float>* convolverInput = &sendBuffer; // undelayed if the arena is exhausted, never with chunks of the prepared size
+    if (delayedBuffer.getNumChannels() > 0) {
+        predelayLine.process(sendBuffer, delayedBuffer, numSamples, predelayPattern ? yrevBuffer.data() : nullptr);
+        convolverInput = &delayedBuffer;
     }
-    juce::AudioBuffer<float> delayedBuffer(2, numSamples);
-    delayedBuffer.clear();
-    for (int channel = 0; channel < 2; ++channel) {
-        auto* delayRead = delayBuffer.getReadPointer(channel);
-        auto* delayedWrite = delayedBuffer.getWritePointer(channel);
-
-        int readPosition = (delaypos + delaySize - predelay) % delaySize;
 
-        for (int i = 0; i < numSamples; ++i) {
-            int index = (readPosition + i) % delaySize;
-            delayedWrite[i] = delayRead[index];
+    // single engine crossfade, the position is latched per partition
+    if (loadState.load() == kFadingShared) {
+        if (xfade > 0) {
+            xfade -= numSamples;
+            convolver->setFadePosition(std::clamp(1.f - (float)xfade / (float)xfadelen, 0.f, 1.f));
+            if (xfade <= 0)
+                convolver->endFade();
+        }
+        else if (!convolver->isFading()) {
+            finishCrossfade();
         }
     }
-    delaypos = (delaypos + numSamples) % delaySize;
 
     // process send input into the convolver
-    convolver->process(
-        delayedBuffer.getReadPointer(0),
-        delayedBuffer.getReadPointer(1),
-        numSamples
-    );
+    processConvolver(*convolver, *convolverInput, numSamples, false);
+    droppedTailSegments.store(convolver->getDroppedSegments());
 
     // crossfade load convolver with current convolver signal
     if (loadState.load() == kFading) {
-        loadConvolver->process(
-            sendBuffer.getReadPointer(0),
-            sendBuffer.getReadPointer(1),
-            numSamples,
-            true
-        );
-
-        for (int i = 0; i < convolver->bufferLL.size(); ++i) {
-            float alpha = std::clamp((1.f - (float)xfade / (float)xfadelen), 0.f, 1.f);
-            convolver->bufferLL[i] *= 1.f - alpha;
-            convolver->bufferRR[i] *= 1.f - alpha;
-            loadConvolver->bufferLL[i] *= alpha;
-            loadConvolver->bufferRR[i] *= alpha;
-
-            if (convolver->isQuad && tsenabled) {
-                convolver->bufferLR[i] *= 1.f - alpha;
-                convolver->bufferRL[i] *= 1.f - alpha;
-            }
-
-            xfade--;
-        }
+        processConvolver(*loadConvolver, sendBuffer, numSamples, true);
+        addWetSignal(*convolver, numSamples, tsenabled, xfade, false);
+        addWetSignal(*loadConvolver, numSamples, false, xfade, true);
+        xfade -= numSamples;
 
         if (xfade <= 0) {
-            loadState.store(kIdle);
             std::swap(loadConvolver, convolver);
+            finishCrossfade();
         }
-
-        wetBuffer.addFrom(0, 0, loadConvolver->bufferLL.data(), numSamples, 1.f);
-        wetBuffer.addFrom(1, 0, loadConvolver->bufferRR.data(), numSamples, 1.f);
-    }
-
-    // apply the convolver to the wet buffer (after crossfade)
-    wetBuffer.addFrom(0, 0, convolver->bufferLL.data(), numSamples, 1.f);
-    wetBuffer.addFrom(1, 0, convolver->bufferRR.data(), numSamples, 1.f);
-    if (convolver->isQuad && tsenabled) {
-        wetBuffer.addFrom(0, 0, convolver->bufferRL.data(), numSamples, 1.f);
-        wetBuffer.addFrom(1, 0, convolver->bufferLR.data(), numSamples, 1.f);
     }
-
-    // apply reverb envelope and stereo width to the wet buffer
-    lchannel = wetBuffer.getReadPointer(0);
-    rchannel = wetBuffer.getReadPointer(1);
-    float normalization = 1.0f / (1.0f + width);
+    else {
+        // apply the convolver to the wet buffer
+        addWetSignal(*convolver, numSamples, tsenabled);
+    }
+
+    // apply reverb envelope and stereo width to the wet buffer in one pass
+    // mid/side width folded into a 2x2 mix, direct = (1 + width) / 2, cross = (1 - width) / 2, both normalized
+    auto* lwet = wetBuffer.getWritePointer(0);
+    auto* rwet = wetBuffer.getWritePointer(1);
+    const float normalization = 1.0f / (1.0f + width);
+    const float direct = 0.5f * (1.0f + width) * normalization;
+    const float cross = 0.5f * (1.0f - width) * normalization;
+    const float* yrevs = yrevBuffer.data();
     for (int sample = 0; sample < numSamples; ++sample) {
-        auto lin = lchannel[sample] * yrevBuffer[sample];
-        auto rin = rchannel[sample] * yrevBuffer[sample];
-
-        auto mid = (lin + rin) * 0.5f;
-        auto side = (lin - rin) * 0.5f;
-
-        auto lout = (mid + side * width) * normalization;
-        auto rout = (mid - side * width) * normalization;
-
-        wetBuffer.setSample(0, sample, lout);
-        wetBuffer.setSample(1, sample, rout);
+        auto lin = lwet[sample] * yrevs[sample];
+        auto rin = rwet[sample] * yrevs[sample];
+        lwet[sample] = lin * direct + rin * cross;
+        rwet[sample] = rin * direct + lin * cross;
+    }
+    for (int ch = 2; ch < wetBuffer.getNumChannels(); ++ch) {
+        FloatVectorOperations::multiply(wetBuffer.getWritePointer(ch), yrevBuffer.data(), numSamples);
     }
 
     // mix the dry and wet signals
     if (!revenvMonitor && !sendenvMonitor && !useMonitor) {
         buffer.applyGain(drygain);
-        wetBuffer.applyGain(wetgain);
 
-        // process display samples
+        // process display samples, the wet gain is applied by the mix below
         auto lpre = buffer.getReadPointer(0);
         auto rpre = buffer.getReadPointer(audioInputs > 1 ? 1 : 0);
         auto lpost = wetBuffer.getReadPointer(0);
         auto rpost = wetBuffer.getReadPointer(1);
-        for (int sample = 0; sample < numSamples; ++sample) {
-            processDisplaySample(xposBuffer[sample], lpre[sample], rpre[sample], lpost[sample], rpost[sample]);
+        if (drawDisplay) {
+            for (int sample = 0; sample < numSamples; ++sample) {
+                processDisplaySample(xposBuffer[sample], lpre[sample], rpre[sample], lpost[sample] * wetgain, rpost[sample] * wetgain);
+            }
         }
 
-        buffer.addFrom(0, 0, wetBuffer.getReadPointer(0), numSamples);
+        buffer.addFrom(0, 0, wetBuffer.getReadPointer(0), numSamples, wetgain);
         if (audioOutputs > 1) {
-            buffer.addFrom(1, 0, wetBuffer.getReadPointer(1), numSamples);
+            buffer.addFrom(1, 0, wetBuffer.getReadPointer(1), numSamples, wetgain);
+        }
+        for (int ch = 2; ch < std::min(audioOutputs, wetBuffer.getNumChannels()); ++ch) {
+            buffer.addFrom(ch, 0, wetBuffer.getReadPointer(ch), numSamples, wetgain);
         }
     }
     else {
         // process display samples
         auto lpre = buffer.getReadPointer(0);
         auto rpre = buffer.getReadPointer(audioInputs > 1 ? 1 : 0);
-        for (int sample = 0; sample < numSamples; ++sample) {
-            processDisplaySample(xposBuffer[sample], lpre[sample], rpre[sample], 0.f, 0.f);
+        if (drawDisplay) {
+            for (int sample = 0; sample < numSamples; ++sample) {
+                processDisplaySample(xposBuffer[sample], lpre[sample], rpre[sample], 0.f, 0.f);
+            }
         }
     }
 
-    auto ch0 = buffer.getReadPointer(0);
-    auto ch1 = buffer.getReadPointer(audioOutputs > 1 ? 1 : 0);
-    for (int i = 0; i < numSamples; ++i) {
-        eqBuffer[eqWriteIndex++] = 0.5f * (ch0[i] + ch1[i]);
-        eqWriteIndex %= eqBuffer.size();
-    }
-    eqFFTReady.store(true, std::memory_order_release);
-
-    //for (int i = 0; i < numSamples; ++i) {
-    //    fftData[fftWriteIndex++] = (ch0[i] + ch1[i]) * 0.5f;
-    //    if (fftWriteIndex >= sz) {
-    //        window.multiplyWithWindowingTable(fftData.data(), fftData.size());
-    //        fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
-    //        float norm = 1.f / (fftData.size() * 0.5f);
-    //        for (size_t j = 0; j < 2048 / 2; ++j) {
-    //            float mag = fftData[j] * norm;
-    //            fftMagnitudes[j] = mag * 0.8 + fftMagnitudes[j] * 0.2f;
-    //        }
-    //
-    //        fftWriteIndex = 0; // next write position
-    //        fftReady.store(true, std::memory_order_release);
-    //    }
-    //}
+    if (offline || !analyzer.isActive())
+        return; // no visualization while rendering or without an EQ display
+
+    analyzer.push(buffer.getReadPointer(0), buffer.getReadPointer(audioOutputs > 1 ? 1 : 0), numSamples);
 }
 
 //==============================================================================
@@ -1947,8 +2371,20 @@ void REEVRAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     state.setProperty("linkSeqToGrid", linkSeqToGrid, nullptr);
     state.setProperty("currpattern", pattern->index + 1, nullptr);
     state.setProperty("currsendpattern", sendpattern->index - 12 + 1, nullptr);
-    state.setProperty("irfile", irFile, nullptr);
+    state.setProperty("irfile", getSlotFile(0), nullptr);
     state.setProperty("midiTriggerChn", midiTriggerChn, nullptr);
+    state.setProperty("halfPrecisionIR", halfPrecisionIR, nullptr);
+    state.setProperty("tailDecimation", tailDecimation, nullptr);
+    state.setProperty("hybridTailMs", hybridTailMs, nullptr);
+    state.setProperty("envRate", envRate, nullptr);
+    state.setProperty("envCubic", envCubic, nullptr);
+    state.setProperty("predelayPattern", predelayPattern, nullptr);
+    {
+        const ScopedLock lock(irFilesLock);
+        state.setProperty("morphFiles", morphFiles.joinIntoString("\n"), nullptr);
+        state.setProperty("slotFiles", slotFiles.joinIntoString("\n"), nullptr);
+    }
+    state.setProperty("slotChn", slotChn, nullptr);
 
     for (int i = 0; i < 12; ++i) {
         std::ostringstream oss;
@@ -2037,13 +2473,35 @@ void REEVRAudioProcessor::setStateInformation (const void* data, int sizeInBytes
         resenvAutoRel = (bool)state.getProperty("sendenvAutoRel");
         midiTriggerChn = (int)state.getProperty("midiTriggerChn");
         linkSeqToGrid = state.hasProperty("linkSeqToGrid") ? (bool)state.getProperty("linkSeqToGrid") : true;
-        if (state.hasProperty("irfile")) irFile = state.getProperty("irfile");
+        if (state.hasProperty("irfile")) {
+            const ScopedLock lock(irFilesLock);
+            irFile = state.getProperty("irfile");
+        }
+        if (state.hasProperty("halfPrecisionIR")) halfPrecisionIR = (bool)state.getProperty("halfPrecisionIR");
+        if (state.hasProperty("tailDecimation")) tailDecimation = jlimit(1, 4, (int)state.getProperty("tailDecimation"));
+        if (state.hasProperty("hybridTailMs")) hybridTailMs = jlimit(0, 2000, (int)state.getProperty("hybridTailMs"));
+        if (state.hasProperty("envRate")) envRate = jlimit(1, 32, (int)state.getProperty("envRate"));
+        if (state.hasProperty("envCubic")) envCubic = (bool)state.getProperty("envCubic");
+        if (state.hasProperty("predelayPattern")) predelayPattern = (bool)state.getProperty("predelayPattern");
+        auto newMorphFiles = StringArray::fromLines(state.getProperty("morphFiles").toString());
+        newMorphFiles.removeEmptyStrings();
+        auto newSlotFiles = StringArray::fromLines(state.getProperty("slotFiles").toString());
+        newSlotFiles.removeRange(IR_SLOTS - 1, newSlotFiles.size());
+        if (newSlotFiles.joinIntoString("").isEmpty()) newSlotFiles.clear();
+        {
+            const ScopedLock lock(irFilesLock);
+            morphFiles = newMorphFiles;
+            slotFiles = newSlotFiles;
+            hasSlotFiles = slotFiles.size() > 0;
+        }
+        slotsDirty = true;
+        if (state.hasProperty("slotChn")) slotChn = (int)state.getProperty("slotChn");
 
         int currpattern = state.hasProperty("currpattern")
             ? (int)state.getProperty("currpattern")
-            : (int)params.getRawParameterValue("pattern")->load();
+            : (int)registry.get(Param::pattern);
         queuePattern(currpattern);
-        auto param = params.getParameter("pattern");
+        auto param = registry.getParameter(Param::pattern);
         param->setValueNotifyingHost(param->convertTo0to1((float)currpattern));
 
         for (int i = 0; i < 12; ++i) {
@@ -2074,9 +2532,9 @@ void REEVRAudioProcessor::setStateInformation (const void* data, int sizeInBytes
                 }
             }
 
-            auto tension = (double)params.getRawParameterValue("tension")->load();
-            auto tensionatk = (double)params.getRawParameterValue("tensionatk")->load();
-            auto tensionrel = (double)params.getRawParameterValue("tensionrel")->load();
+            auto tension = (double)registry.get(Param::tension);
+            auto tensionatk = (double)registry.get(Param::tensionatk);
+            auto tensionrel = (double)registry.get(Param::tensionrel);
             patterns[i]->setTension(tension, tensionatk, tensionrel, dualTension);
             patterns[i]->buildSegments();
             sendpatterns[i]->setTension(tension, tensionatk, tensionrel, dualTension);
@@ -2113,9 +2571,9 @@ void REEVRAudioProcessor::importPatterns()
     if (sequencer->isOpen)
         sequencer->close();
 
-    auto tensionParams = TensionParameters((double)params.getRawParameterValue("tension")->load(),
-                             (double)params.getRawParameterValue("tensionatk")->load(),
-                             (double)params.getRawParameterValue("tensionrel")->load(), dualTension);
+    auto tensionParams = TensionParameters((double)registry.get(Param::tension),
+                             (double)registry.get(Param::tensionatk),
+                             (double)registry.get(Param::tensionrel), dualTension);
 
     patternManager.importPatterns(patterns, sendpatterns, tensionParams);
     setUIMode(UIMode::Normal);
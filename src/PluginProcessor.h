@@ -16,15 +16,24 @@
 #include "Presets.h"
 #include <atomic>
 #include <deque>
+#include <array>
 #include "Globals.h"
+#include "Params.h"
 #include "ui/Sequencer.h"
 #include "dsp/Utils.h"
 #include "dsp/Follower.h"
 #include "dsp/StereoConvolver.h"
+#include "dsp/ConvolverTuner.h"
 #include "dsp/Impulse.h"
 #include "dsp/Filter.h"
 #include "dsp/SVF.h"
+#include "dsp/VisualTap.h"
+#include "dsp/SpectrumAnalyzer.h"
+#include "dsp/ScratchArena.h"
+#include "dsp/PreDelay.h"
+#include "dsp/BlockScheduler.h"
 #include "utils/PatternManager.h"
+#include "utils/RTAudit.h"
 
 using namespace globals;
 
@@ -78,7 +87,11 @@ enum LoadState {
     kIdle,
     kLoading,
     kReady,
-    kFading,
+    kFading, // dual engine crossfade, the load convolver runs in parallel
+    kFadingShared, // crossfade inside the current convolver
+    kReleasing, // freeing the old IR of the load convolver
+    kLoadingSlots, // building the IR slot bank
+    kSlotsReady,
 };
 
 /*
@@ -112,6 +125,40 @@ public:
     }
 };
 
+// Interpolates values evaluated at control rate, trails the control points by one interval
+class ControlInterpolator
+{
+public:
+    double p0 = 0.0; // control points, p2 is the newest
+    double p1 = 0.0;
+    double p2 = 0.0;
+
+    void push(double value)
+    {
+        p0 = p1;
+        p1 = p2;
+        p2 = value;
+    }
+
+    // t is the position between p1 and p2, 0..1
+    // cubic uses a hermite curve with tangents from the previous points
+    double at(double t, bool cubic) const
+    {
+        if (!cubic)
+            return p1 + (p2 - p1) * t;
+        double m1 = (p2 - p0) * 0.5;
+        double m2 = p2 - p1;
+        double t2 = t * t;
+        double t3 = t2 * t;
+        return (2 * t3 - 3 * t2 + 1) * p1 + (t3 - 2 * t2 + t) * m1 + (-2 * t3 + 3 * t2) * p2 + (t3 - t2) * m2;
+    }
+
+    void reset(double value = 0.0)
+    {
+        p0 = p1 = p2 = value;
+    }
+};
+
 //==============================================================================
 /**
 */
@@ -132,7 +179,9 @@ public:
     int plugWidth = PLUG_WIDTH;
     int plugHeight = PLUG_HEIGHT;
     String irDir = "";
-    String irFile = "";
+    String irFile = ""; // guarded by irFilesLock, read with getSlotFile(0)
+    int outOfCoreMB = 0; // far tail spectra kept in memory in MB, the rest is paged from disk, 0 is off, see StereoConvolver::outOfCoreBudget
+    int slotBudgetMB = 256; // IR slot bank spectra memory cap in MB
 
     // Instance Settings
     int currentProgram = -1;
@@ -140,6 +189,7 @@ public:
     bool dualSmooth = true; // use either single smooth or attack and release
     bool dualTension = false;
     int triggerChn = 9; // Midi pattern trigger channel, defaults to channel 10
+    int slotChn = -1; // Midi IR slot channel, note % 12 selects the slot, -1 is off, 16 is any
     bool useMonitor = false;
     bool useSidechain = false;
     bool audioIgnoreHitsWhilePlaying = false;
@@ -152,6 +202,18 @@ public:
     int paintPage = 0;
     int pointMode = 1; // Hold, Curve, S-curve, Pulse, Wave etc..
     int linkSeqToGrid = true; // sequencer step linked to grid size
+    bool halfPrecisionIR = false; // store IR spectra as fp16, halves convolver memory
+    int tailDecimation = 1; // multirate tail factor, 1 is off, 2 or 4 convolve the late IR at a lower rate
+    std::atomic<double> tailDecimationErrorDb = -200.0; // discarded late IR energy, for display
+    std::atomic<size_t> droppedTailSegments = 0; // far tail segments the disk delivered too late, for display
+    int hybridTailMs = 0; // IR length convolved exactly, an FDN tuned to the IR decay renders the rest, 0 is off
+    int envRate = 1; // samples between pattern envelope evaluations, 1 is per sample, 8, 16 or 32 interpolate in between
+    bool envCubic = false; // cubic interpolation between envelope control points, linear otherwise
+    bool predelayPattern = false; // the reverb pattern scales the predelay
+    StringArray morphFiles; // IRs blended with irFile by the morph position, up to MORPH_MAX_IRS - 1, guarded by irFilesLock
+    StringArray slotFiles; // IR slots 1 to IR_SLOTS - 1, empty strings are unused slots, guarded by irFilesLock
+    CriticalSection irFilesLock; // irFile, morphFiles and slotFiles are written on the message thread and read by load jobs
+    std::atomic<bool> hasSlotFiles = false; // slotFiles is not empty, read on the audio thread
 
     // State
     Pattern* pattern; // current pattern used for audio processing
@@ -168,14 +230,14 @@ public:
     double xpos = 0.0; // envelope x pos (0..1)
     double yrev = 0.0; // envelope y pos (0..1)
     double ysend = 0.0; // send envelope y pos
+    double revPatternY = 0.0; // last reverb pattern y, kept while the pattern is locked for rebuild
+    double sendPatternY = 0.0; // last send pattern y
     double trigpos = 0.0; // used by trigger (Audio and MIDI) to detect one one shot envelope play
     double trigposSinceHit = 1.0; // used by audioIgnoreHitsWhilePlaying option
     double trigphase = 0.0; // phase when trigger occurs, used to sync the background wave draw
     double syncQN = 1.0; // sync quarter notes
     int ltrigger = -1; // last trigger mode
     bool midiTrigger = false; // flag midi has triggered envelope
-    int winpos = 0;
-    int lwinpos = 0;
     double ltension = -10.0;
     double ltensionatk = -10.0;
     double ltensionrel = -10.0;
@@ -183,14 +245,20 @@ public:
     double lsend = 0.0; // last send value
     RCSmoother* revvalue; // smooths reveverb envelope value
     RCSmoother* sendvalue; // smooths send envelope value
+    ControlInterpolator revtarget; // reverb pattern value at control rate
+    ControlInterpolator sendtarget; // send pattern value at control rate
+    int envPhase = 0; // samples since the last envelope control point
     bool showLatencyWarning = false;
     std::vector<float> yrevBuffer;
     std::vector<float> ysendBuffer;
     std::vector<float> xposBuffer;
     AudioBuffer<float> wetBuffer;
     AudioBuffer<float> sendBuffer;
-    AudioBuffer<float> delayBuffer;
-    int delaypos = 0;
+    PreDelay predelayLine;
+    ScratchArena scratch; // per chunk audio thread buffers, reset at the start of processChunk
+    int preparedBlockSize = 1; // samplesPerBlock from prepareToPlay, longer host blocks are processed in chunks
+    MidiBuffer chunkMidi; // midi of the current chunk of an oversized host block
+    MidiBuffer chunkMidiOut; // midi output of all chunks of an oversized host block
     bool isLoadingPluginState = false; // used to load impulse while preventing concurrent load
     float ldrywet = -1.f;
     float drygain = 1.f;
@@ -201,11 +269,29 @@ public:
     Impulse* impulse;
     std::unique_ptr<StereoConvolver> convolver;
     std::unique_ptr<StereoConvolver> loadConvolver; // convolver used to load IRs and crossfade
+    ConvolverTuner convolverTuner; // partition sizes measured on this machine, persisted in settings
+    std::vector<std::unique_ptr<Impulse>> morphImpulses; // loaded morphFiles, processed like the main impulse
+    float morphPos = 0.f; // smoothed morph position
+    float tailDecay = 0.f; // smoothed tail decay amount
+    std::array<std::unique_ptr<StereoConvolver>, IR_SLOTS> slots; // preloaded IR slots, the active one is held by convolver
+    std::array<std::unique_ptr<StereoConvolver>, IR_SLOTS> pendingSlots; // slot bank being built or released
+    int activeSlot = 0;
+    int fadingSlot = -1; // slot being crossfaded in, -1 for regular IR loads
+    std::atomic<int> queuedSlot = -1; // slot requested by MIDI or the irslot param, -1 is none
+    std::atomic<bool> slotsDirty = false; // slot files or IR settings changed, rebuild the bank
+    size_t slotHistory = 0; // longest IR of the bank, every engine keeps input history for it
+    std::atomic<size_t> slotMemory = 0; // spectra bytes of the slot bank
+    std::atomic<int> slotsOverBudget = 0; // slots left empty by the memory cap
     AudioBuffer<float> warmer; // buffer used to warmup convolver before crossfading new IR
+    int matrixChannels = 0; // surround or ambisonic bus channels convolved by the IR matrix, 0 on mono and stereo buses
     int loadCooldown = 0;
     int warmwritepos = 0;
     bool init = false;
     bool irDirty = false;
+    bool offline = false; // host renders offline, tails and IR loads run inline and the UI taps are skipped
+    std::atomic<int> irGestures = 0; // IR parameters being dragged
+    bool irDraftLoaded = false; // the last IR load was a draft, rebuilt at full quality once the gestures end
+    bool loadDraft = false; // the queued IR load builds a draft
     std::atomic<LoadState> loadState = kIdle;
     int xfade = 0;
     int xfadelen = 0;
@@ -225,6 +311,8 @@ public:
     std::vector<float> latBufferR; // latency buffer right
     std::vector<float> monLatBufferL; // latency monitor buffer left
     std::vector<float> monLatBufferR; // latency monitor buffer right
+    std::vector<SVF::EQBand> decayEQBands; // updateImpulse scratch, reserved for EQ_BANDS
+    std::vector<SVF::EQBand> paramEQBands;
     int latpos = 0; // latency buffer pos
     int monWritePos = 0; // monitor latency pos
     RBJ audioHighcutL{};
@@ -245,14 +333,12 @@ public:
     bool resenvAutoRel = true;
     std::vector<float> revenvBuffer;
     std::vector<float> sendenvBuffer;
-    Filter irHighcutL{FilterSlope::k6dB, FilterMode::LP};
-    Filter irHighcutR{FilterSlope::k6dB, FilterMode::LP};
-    Filter irLowcutL{FilterSlope::k6dB, FilterMode::HP};
-    Filter irLowcutR{FilterSlope::k6dB, FilterMode::HP};
-    Filter warmerHighcutL{FilterSlope::k6dB, FilterMode::LP};
-    Filter warmerHighcutR{FilterSlope::k6dB, FilterMode::LP};
-    Filter warmerLowcutL{FilterSlope::k6dB, FilterMode::HP};
-    Filter warmerLowcutR{FilterSlope::k6dB, FilterMode::HP};
+    StereoFilter irHighcutLR{FilterSlope::k6dB, FilterMode::LP};
+    StereoFilter irLowcutLR{FilterSlope::k6dB, FilterMode::HP};
+    std::vector<Filter> irHighcutS; // surround channels IR filters
+    std::vector<Filter> irLowcutS;
+    StereoFilter warmerHighcutLR{FilterSlope::k6dB, FilterMode::LP};
+    StereoFilter warmerLowcutLR{FilterSlope::k6dB, FilterMode::HP};
 
     // PlayHead state
     bool playing = false;
@@ -268,16 +354,12 @@ public:
     double secondsPerBar = 1.0;
 
     // UI State
-    std::vector<float> preSamples; // used by view to draw pre audio
-    std::vector<float> postSamples; // used by view to draw post audio
-    int viewW = 1; // viewport width, used for buffers of samples to draw waveforms
+    VisualTap viewTap; // pre and post audio drawn behind the pattern, x is the pattern position
     std::atomic<double> xenv = 0.0; // xpos copy using atomic, read by UI thread - attempt to fix rare crash
     std::atomic<double> yenv = 0.0; // ypos copy using atomic, read by UI thread - attempt to fix rare crash
     std::atomic<bool> drawSeek = false;
-    std::vector<float> monSamples; // used to draw transients + waveform preview
-    std::atomic<float> monpos = 0.0; // write index of monitor circular buf
-    int lmonpos = 0; // last index
-    int monW = 1; // audio monitor width used to rotate monitor samples buffer
+    VisualTap monitorTap; // audio trigger input and detected transients
+    double monPhase = 0.0; // monitor write position, 0..1
     UIMode uimode = UIMode::Normal; // ui mode
     UIMode luimode = UIMode::Normal; // last ui mode
     bool showAudioKnobs = false; // used by UI to toggle audio knobs
@@ -287,9 +369,7 @@ public:
     bool showEnvelopeKnobs = false;
     bool showFileSelector = false;
     int eqtab = 0; // 0 = off, 1 = eq, 2 = decay tab
-    size_t eqWriteIndex = 0;
-    std::array<float, (1 << EQ_FFT_ORDER) * 2> eqBuffer;
-    std::atomic<bool> eqFFTReady = false;
+    SpectrumAnalyzer analyzer{ EQ_FFT_ORDER, EQ_FFT_OVERLAP, EQ_FFT_SMOOTHING }; // output spectrum drawn by the EQ displays
 
 
     static AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
@@ -299,9 +379,30 @@ public:
     void parameterChanged (const juce::String& parameterID, float newValue) override;
 
     std::vector<SVF::EQBand> getEqualizer(SVF::EQType type) const;
+    void getEqualizer(SVF::EQType type, std::vector<SVF::EQBand>& bands) const; // refills bands in place, no allocation once reserved
     void loadImpulse(String path);
     void loadSettings();
     void saveSettings();
+    void tuneConvolver(StereoConvolver& conv, size_t irLength);
+    void loadMorphImpulses(StereoConvolver& conv);
+    void releaseOldImpulses();
+    void finishCrossfade();
+    using LoadTask = void (REEVRAudioProcessor::*)();
+    void runLoadJob(LoadTask task); // queues without allocating, runs inline offline
+    void loadImpulseTask(); // IR load queued by processChunk, loadDraft selects the draft build
+    void releaseImpulsesTask();
+    void setOffline(bool isOffline);
+    void processConvolver(StereoConvolver& conv, const AudioBuffer<float>& input, int numSamples, bool force2Chans);
+    // adds the convolver output to the wet buffer, fade >= 0 ramps it in or out over the crossfade
+    void addWetSignal(StereoConvolver& conv, int numSamples, bool trueStereo, int fade = -1, bool fadeIn = false);
+    String getSlotFile(int slot) const;
+    void setSlotFile(int slot, String path);
+    void clearSlots();
+    void loadSlotBank();
+    void queueSlot(int slot);
+    void addMorphImpulse(String path);
+    void clearMorphImpulses();
+    StringArray getMorphFiles() const; // copies under irFilesLock, not for the audio thread
     void setScale(float value);
     int getCurrentGrid();
     int getCurrentSeqStep();
@@ -349,6 +450,7 @@ public:
 
     //==============================================================================
     void processBlock (AudioBuffer<float>&, MidiBuffer&) override;
+    void processChunk (AudioBuffer<float>&, MidiBuffer&, int hostOffset); // at most preparedBlockSize samples
 
     //==============================================================================
     AudioProcessorEditor* createEditor() override;
@@ -377,6 +479,7 @@ public:
     //=========================================================
 
     AudioProcessorValueTreeState params;
+    ParamRegistry registry; // index based access to params, see Params.h
     UndoManager undoManager;
 
 private:
@@ -386,12 +489,16 @@ private:
     Transient transDetectorL;
     Transient transDetectorR;
     bool paramChanged = false; // flag that triggers on any param change
+    ParamRegistry::Snapshot paramBlock{}; // param values of the current block
     ApplicationProperties settings;
-    std::vector<MidiInMsg> midiIn; // midi buffer used to process midi messages offset
+    BlockScheduler<MidiInMsg> midiIn; // midi note events of the current block sorted by offset
     std::vector<MidiOutMsg> midiOut;
-    ThreadPool threadPool{1};
+    class LoadThread;
+    std::unique_ptr<LoadThread> loadThread; // runs the IR load tasks queued by the audio thread, one at a time
+    ThreadPool tunerPool{1, 0, Thread::Priority::low}; // partition benchmarks, kept apart so IR loads never wait behind them
     PatternManager patternManager;
 
     //==============================================================================
+    JUCE_DECLARE_WEAK_REFERENCEABLE (REEVRAudioProcessor)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (REEVRAudioProcessor)
 };
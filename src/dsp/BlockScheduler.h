@@ -0,0 +1,74 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// Sample accurate event queue for the audio thread
+// events are kept sorted by block offset so processBlock can run in sub ranges between event boundaries
+// instead of scanning the queue on every sample, Event needs an int offset field
+template <typename Event>
+class BlockScheduler
+{
+public:
+    void prepare(size_t capacity) // message thread
+    {
+        events.clear();
+        events.reserve(capacity);
+        head = 0;
+    }
+
+    // sorted insert after events with the same offset, returns false if the queue is full
+    bool push(const Event& event)
+    {
+        if (events.size() == events.capacity())
+            return false;
+        size_t i = events.size();
+        events.push_back(event);
+        while (i > head && events[i - 1].offset > event.offset) {
+            events[i] = events[i - 1];
+            --i;
+        }
+        events[i] = event;
+        return true;
+    }
+
+    // calls fn for every pending event at this sample
+    template <typename Fn>
+    void dispatch(int sample, Fn&& fn)
+    {
+        while (head < events.size() && events[head].offset <= sample)
+            fn(events[head++]);
+    }
+
+    // offset of the next pending event, limit if there is none before it
+    int nextOffset(int limit) const
+    {
+        return head < events.size() ? std::min(events[head].offset, limit) : limit;
+    }
+
+    // drops dispatched events and moves the rest into the next block
+    void endBlock(int numSamples)
+    {
+        size_t pending = 0;
+        for (size_t i = head; i < events.size(); ++i) {
+            events[pending] = events[i];
+            events[pending++].offset -= numSamples;
+        }
+        events.erase(events.begin() + pending, events.end());
+        head = 0;
+    }
+
+    void clear()
+    {
+        events.clear();
+        head = 0;
+    }
+
+    bool empty() const { return head >= events.size(); }
+
+private:
+    std::vector<Event> events;
+    size_t head = 0; // first event not yet dispatched
+};
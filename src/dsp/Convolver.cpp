@@ -62,8 +62,10 @@ private:
 
 Convolver::Convolver() :
   fftconvolver::TwoStageFFTConvolver(),
+  _spectraFile(),
   _thread(),
   _backgroundProcessingFinished(1),
+  _synchronous(false),
   _backgroundProcessingFinishedEvent(true)
 {
   _thread.reset(new ConvolverBackgroundThread(*this));
@@ -81,8 +83,35 @@ bool Convolver::isFinished()
     return (bool)_backgroundProcessingFinished.load();
 }
 
+void Convolver::setOutOfCoreBudget(size_t residentBytes)
+{
+  if (residentBytes > 0 && _spectraFile == nullptr)
+  {
+    _spectraFile.reset(new SpectraFile());
+  }
+  setTailSpectraPager(residentBytes > 0 ? _spectraFile.get() : nullptr, residentBytes);
+}
+
+
+size_t Convolver::getDroppedSegments() const
+{
+  return _spectraFile != nullptr ? _spectraFile->getDroppedSegments() : 0;
+}
+
+
+void Convolver::setSynchronous(bool synchronous)
+{
+  _synchronous.store(synchronous);
+}
+
+
 void Convolver::startBackgroundProcessing()
 {
+  if (_synchronous.load())
+  {
+    doBackgroundProcessing();
+    return;
+  }
   _backgroundProcessingFinished.store(0);
   _backgroundProcessingFinishedEvent.reset();
   _thread->notify();
@@ -24,6 +24,7 @@
 //#include "FFTConvolver/TwoStageFFTConvolver.h"
 #include "TwoStageFFTConvolver.h"
 #include "JuceHeader.h"
+#include "SpectraFile.h"
 
 class Convolver : public fftconvolver::TwoStageFFTConvolver
 {
@@ -32,6 +33,25 @@ public:
   virtual ~Convolver();
   bool isFinished();
 
+  /**
+  * @brief Keeps at most residentBytes of far tail spectra in memory, the rest is paged from disk
+  *
+  * Takes effect on the next call of init(), 0 keeps all spectra in memory.
+  */
+  void setOutOfCoreBudget(size_t residentBytes);
+
+  /**
+  * @brief Paged segments the disk could not deliver in time since the last init(), see SpectraFile
+  */
+  size_t getDroppedSegments() const;
+
+  /**
+  * @brief Runs the tail work inside process() instead of on the background thread
+  *
+  * Used for offline renders, where waiting on another thread gains nothing.
+  */
+  void setSynchronous(bool synchronous);
+
 protected:
   virtual void startBackgroundProcessing();
   virtual void waitForBackgroundProcessing();
@@ -39,8 +59,10 @@ protected:
 private:
   friend class ConvolverBackgroundThread;
 
+  std::unique_ptr<SpectraFile> _spectraFile;
   std::unique_ptr<juce::Thread> _thread;
   std::atomic<uint32> _backgroundProcessingFinished;
+  std::atomic<bool> _synchronous;
   juce::WaitableEvent _backgroundProcessingFinishedEvent;
 };
 
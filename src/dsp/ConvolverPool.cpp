@@ -0,0 +1,109 @@
+#include "ConvolverPool.h"
+
+class TailWorkerPool::Worker : public juce::Thread
+{
+public:
+	Worker(TailWorkerPool& p) : juce::Thread("TailWorker"), pool(p)
+	{
+		startThread(Thread::Priority::high);
+	}
+
+	~Worker() override
+	{
+		signalThreadShouldExit();
+		notify();
+		stopThread(1000);
+	}
+
+	void run() override
+	{
+		while (!threadShouldExit()) {
+			wait(-1);
+			pool.runJobs();
+		}
+	}
+
+private:
+	TailWorkerPool& pool;
+};
+
+TailWorkerPool::TailWorkerPool()
+{
+	for (auto& job : jobs)
+		job.store(nullptr);
+	// leave a core for the audio thread
+	const int count = jlimit(1, MAX_WORKERS, SystemStats::getNumCpus() - 1);
+	for (int i = 0; i < count; ++i)
+		workers.push_back(std::make_unique<Worker>(*this));
+}
+
+TailWorkerPool::~TailWorkerPool()
+{
+	workers.clear();
+}
+
+void TailWorkerPool::submit(PooledConvolver& convolver)
+{
+	for (auto& job : jobs) {
+		PooledConvolver* expected = nullptr;
+		if (job.compare_exchange_strong(expected, &convolver)) {
+			for (auto& worker : workers)
+				worker->notify();
+			return;
+		}
+	}
+	convolver.runBackgroundJob();
+}
+
+void TailWorkerPool::runJobs()
+{
+	bool found = true;
+	while (found) {
+		found = false;
+		for (auto& job : jobs) {
+			if (job.load(std::memory_order_relaxed) == nullptr)
+				continue;
+			if (auto* convolver = job.exchange(nullptr)) {
+				convolver->runBackgroundJob();
+				found = true;
+			}
+		}
+	}
+}
+
+// =================================================
+
+PooledConvolver::PooledConvolver()
+{
+	finished.signal();
+}
+
+PooledConvolver::~PooledConvolver()
+{
+	waitForIdle();
+}
+
+void PooledConvolver::waitForIdle()
+{
+	finished.wait();
+}
+
+void PooledConvolver::startBackgroundProcessing()
+{
+	finished.reset();
+	if (synchronous.load())
+		runBackgroundJob();
+	else
+		pool->submit(*this);
+}
+
+void PooledConvolver::waitForBackgroundProcessing()
+{
+	finished.wait();
+}
+
+void PooledConvolver::runBackgroundJob()
+{
+	doBackgroundProcessing();
+	finished.signal();
+}
@@ -0,0 +1,52 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include "Convolver.h"
+#include <array>
+#include <atomic>
+
+class PooledConvolver;
+
+// background tails of many convolvers scheduled on a few shared worker threads
+// instead of one thread per convolver, shared by every plugin instance
+class TailWorkerPool
+{
+public:
+    static constexpr int MAX_JOBS = 64;
+    static constexpr int MAX_WORKERS = 4;
+
+    TailWorkerPool();
+    ~TailWorkerPool();
+
+    void submit(PooledConvolver& convolver); // lock free, runs the job inline if the queue is full
+    int getNumWorkers() const { return (int)workers.size(); }
+
+private:
+    class Worker;
+    void runJobs(); // runs queued jobs until the queue is empty
+
+    std::array<std::atomic<PooledConvolver*>, MAX_JOBS> jobs;
+    std::vector<std::unique_ptr<Worker>> workers;
+};
+
+class PooledConvolver : public fftconvolver::TwoStageFFTConvolver
+{
+public:
+    PooledConvolver();
+    ~PooledConvolver() override;
+    void waitForIdle(); // blocks until the pending tail job is done, call before reset or init
+    void setSynchronous(bool sync) { synchronous.store(sync); } // tail runs inside process, for offline renders
+
+protected:
+    void startBackgroundProcessing() override;
+    void waitForBackgroundProcessing() override;
+
+private:
+    friend class TailWorkerPool;
+    void runBackgroundJob();
+
+    juce::SharedResourcePointer<TailWorkerPool> pool;
+    juce::WaitableEvent finished { true };
+    std::atomic<bool> synchronous { false };
+};
@@ -0,0 +1,160 @@
+#include "ConvolverTuner.h"
+
+namespace
+{
+	// runs the background stage inline and times it apart from the audio thread work
+	class BenchConvolver : public fftconvolver::TwoStageFFTConvolver
+	{
+	public:
+		double backgroundSeconds = 0.0;
+
+	protected:
+		void startBackgroundProcessing() override
+		{
+			const auto start = juce::Time::getHighResolutionTicks();
+			doBackgroundProcessing();
+			backgroundSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+		}
+
+		void waitForBackgroundProcessing() override {}
+	};
+
+	size_t nextPow2(size_t n)
+	{
+		size_t p = 1;
+		while (p < n) p *= 2;
+		return p;
+	}
+}
+
+ConvolverTuner::Partitions ConvolverTuner::getDefault(int blockSize)
+{
+	Partitions p;
+	p.head = nextPow2((size_t)std::max(1, blockSize));
+	p.tail = std::max(size_t(8192), 2 * p.head);
+	return p;
+}
+
+juce::String ConvolverTuner::getKey(int blockSize, size_t irLength, bool offline)
+{
+	return "b" + juce::String(blockSize) + "_ir" + juce::String((juce::int64)nextPow2(irLength)) + (offline ? "_off" : "");
+}
+
+ConvolverTuner::Partitions ConvolverTuner::measure(int blockSize, size_t irLength, bool offline)
+{
+	const auto def = getDefault(blockSize);
+	if (blockSize <= 0 || irLength <= def.head)
+		return def;
+
+	// noise IR of the bucket length, the values don't matter but must not be trimmed as silence
+	juce::Random rng(1234);
+	std::vector<float> ir(std::min(nextPow2(irLength), MAX_BENCH_IR));
+	for (auto& s : ir)
+		s = rng.nextFloat() * 0.5f + 0.25f;
+	std::vector<float> input((size_t)blockSize);
+	std::vector<float> output((size_t)blockSize);
+	for (auto& s : input)
+		s = rng.nextFloat() * 2.f - 1.f;
+
+	std::vector<size_t> heads = { def.head };
+	if (def.head / 2 >= MIN_HEAD)
+		heads.push_back(def.head / 2);
+
+	struct Result
+	{
+		Partitions partitions;
+		double total; // all cpu time spent, audio and background threads
+		double peak; // slowest audio thread call
+	};
+	std::vector<Result> results;
+
+	// same input length for every candidate, covers two periods of the largest tail
+	const size_t numSamples = 2 * MAX_TAIL;
+	for (auto head : heads) {
+		for (size_t tail = std::max(MIN_TAIL, 2 * head); tail <= MAX_TAIL; tail *= 2) {
+			BenchConvolver conv;
+			if (!conv.init(head, tail, ir.data(), ir.size()))
+				continue;
+
+			double total = 0.0;
+			double peak = 0.0;
+			for (size_t done = 0; done < numSamples; done += (size_t)blockSize) {
+				const double background = conv.backgroundSeconds;
+				const auto start = juce::Time::getHighResolutionTicks();
+				conv.process(input.data(), output.data(), (size_t)blockSize);
+				const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+				total += elapsed;
+				peak = std::max(peak, elapsed - (conv.backgroundSeconds - background));
+			}
+			results.push_back({ { head, tail }, total, peak });
+		}
+	}
+
+	if (results.empty())
+		return def;
+
+	// cheapest total cost among candidates that don't spike the audio thread
+	double bestPeak = results[0].peak;
+	for (auto& r : results)
+		bestPeak = std::min(bestPeak, r.peak);
+
+	const Result* best = nullptr;
+	for (auto& r : results) {
+		if (!offline && r.peak > 2.0 * bestPeak) continue;
+		if (best == nullptr || r.total < best->total)
+			best = &r;
+	}
+
+	return best->partitions;
+}
+
+bool ConvolverTuner::lookup(const juce::String& key, Partitions& result)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	auto it = wisdom.find(key);
+	if (it == wisdom.end())
+		return false;
+	result = it->second;
+	return true;
+}
+
+void ConvolverTuner::store(const juce::String& key, Partitions partitions)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	wisdom[key] = partitions;
+	measuring.erase(key);
+}
+
+bool ConvolverTuner::beginMeasure(const juce::String& key)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	if (wisdom.count(key) > 0)
+		return false;
+	return measuring.insert(key).second;
+}
+
+juce::String ConvolverTuner::toString()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	juce::String str;
+	for (auto& [key, p] : wisdom) {
+		str << key << "=" << juce::String((juce::int64)p.head) << ":" << juce::String((juce::int64)p.tail) << ";";
+	}
+	return str;
+}
+
+void ConvolverTuner::fromString(const juce::String& str)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	auto entries = juce::StringArray::fromTokens(str, ";", "");
+	for (auto& entry : entries) {
+		auto key = entry.upToFirstOccurrenceOf("=", false, false);
+		auto value = entry.fromFirstOccurrenceOf("=", false, false);
+		Partitions p;
+		p.head = (size_t)value.upToFirstOccurrenceOf(":", false, false).getLargeIntValue();
+		p.tail = (size_t)value.fromFirstOccurrenceOf(":", false, false).getLargeIntValue();
+		if (key.isEmpty() || p.head == 0 || !juce::isPowerOfTwo(p.head) || !juce::isPowerOfTwo(p.tail) || p.head > p.tail)
+			continue;
+		wisdom[key] = p;
+	}
+}
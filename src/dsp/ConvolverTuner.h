@@ -0,0 +1,47 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include "TwoStageFFTConvolver.h"
+#include <JuceHeader.h>
+#include <map>
+#include <set>
+#include <mutex>
+
+/*
+	Partition size auto-tuner, picks the fastest head and tail block sizes
+	for a host block size and IR length by benchmarking candidate configurations
+	on this machine. Results are kept as "wisdom" keyed by block size and
+	IR length bucket so the measurement only runs once per configuration.
+*/
+class ConvolverTuner
+{
+public:
+	struct Partitions
+	{
+		size_t head = 0;
+		size_t tail = 0;
+	};
+
+	static constexpr size_t MIN_HEAD = 64;
+	static constexpr size_t MIN_TAIL = 1024;
+	static constexpr size_t MAX_TAIL = 32768;
+	static constexpr size_t MAX_BENCH_IR = size_t(1) << 21; // longer IRs are measured at this length
+
+	static Partitions getDefault(int blockSize); // head = block size, tail = max(8192, 2 * head)
+	static juce::String getKey(int blockSize, size_t irLength, bool offline = false);
+	// offline picks the cheapest total cost, audio thread spikes don't matter when rendering
+	static Partitions measure(int blockSize, size_t irLength, bool offline = false);
+
+	bool lookup(const juce::String& key, Partitions& result);
+	void store(const juce::String& key, Partitions partitions);
+	// claims a configuration for measuring, false if it is known or already being measured
+	bool beginMeasure(const juce::String& key);
+	juce::String toString();
+	void fromString(const juce::String& str);
+
+private:
+	std::mutex mtx;
+	std::map<juce::String, Partitions> wisdom;
+	std::set<juce::String> measuring;
+};
@@ -0,0 +1,128 @@
+#include "FDN.h"
+
+namespace
+{
+	// mutually different line lengths in ms, rounded to primes at the current rate
+	constexpr float LINE_MS[FDN::NUM_LINES] = { 29.7f, 37.1f, 41.1f, 43.7f, 53.3f, 59.9f, 67.7f, 73.1f };
+
+	bool isPrime(int n)
+	{
+		if (n < 2) return false;
+		for (int d = 2; d * d <= n; ++d)
+			if (n % d == 0) return false;
+		return true;
+	}
+}
+
+void FDN::prepare(double _srate, int onset, int samplesPerBlock)
+{
+	srate = _srate;
+	for (int i = 0; i < NUM_LINES; ++i) {
+		int len = std::max(2, (int)(LINE_MS[i] * srate / 1000.0));
+		while (!isPrime(len)) ++len;
+		lengths[i] = len;
+		lines[i].assign(len, 0.f);
+		lineSplits[i].init(srate);
+	}
+	for (auto& split : outputSplits)
+		split.init(srate);
+	// input reaches the outputs after one trip around the shortest line
+	predelay = std::max(0, onset - *std::min_element(lengths.begin(), lengths.end()));
+	for (auto& gains : outputGains)
+		gains = { 1.f, 1.f, 1.f };
+
+	const int preSize = nextPowerOfTwo(predelay + samplesPerBlock + 1);
+	preL.assign(preSize, 0.f);
+	preR.assign(preSize, 0.f);
+	preMask = preSize - 1;
+	clear();
+}
+
+void FDN::setDecay(const std::array<float, 3>& rt60)
+{
+	// -60dB after rt60 seconds, applied once per trip around each line
+	for (int i = 0; i < NUM_LINES; ++i) {
+		for (int b = 0; b < 3; ++b) {
+			const double t = std::max(0.05f, rt60[b]);
+			absorption[i][b] = (float)std::pow(10.0, -3.0 * lengths[i] / (t * srate));
+		}
+	}
+}
+
+void FDN::setOutputGains(int channel, const std::array<float, 3>& gains)
+{
+	outputGains[channel] = gains;
+}
+
+void FDN::clear()
+{
+	for (int i = 0; i < NUM_LINES; ++i) {
+		std::fill(lines[i].begin(), lines[i].end(), 0.f);
+		positions[i] = 0;
+		lineSplits[i].z1 = lineSplits[i].z2 = 0.f;
+	}
+	for (auto& split : outputSplits)
+		split.z1 = split.z2 = 0.f;
+	std::fill(preL.begin(), preL.end(), 0.f);
+	std::fill(preR.begin(), preR.end(), 0.f);
+	prePos = 0;
+}
+
+inline void FDN::tick(float inL, float inR, float& outL, float& outR)
+{
+	float v[NUM_LINES];
+	float sumL = 0.f;
+	float sumR = 0.f;
+	for (int i = 0; i < NUM_LINES; ++i) {
+		v[i] = lineSplits[i].apply(lines[i][positions[i]], absorption[i]);
+		if (i & 1) sumR += v[i];
+		else sumL += v[i];
+	}
+
+	// fast Walsh-Hadamard transform, scaled to stay orthonormal
+	for (int len = 1; len < NUM_LINES; len <<= 1) {
+		for (int i = 0; i < NUM_LINES; i += len << 1) {
+			for (int j = i; j < i + len; ++j) {
+				const float a = v[j];
+				const float b = v[j + len];
+				v[j] = a + b;
+				v[j + len] = a - b;
+			}
+		}
+	}
+
+	const float norm = 1.f / std::sqrt((float)NUM_LINES);
+	for (int i = 0; i < NUM_LINES; ++i) {
+		lines[i][positions[i]] = v[i] * norm + (i & 1 ? inR : inL);
+		positions[i] = positions[i] + 1 == lengths[i] ? 0 : positions[i] + 1;
+	}
+
+	outL = outputSplits[0].apply(sumL * 0.5f, outputGains[0]);
+	outR = outputSplits[1].apply(sumR * 0.5f, outputGains[1]);
+}
+
+void FDN::process(const float* inL, const float* inR, float* outL, float* outR, int nsamples)
+{
+	for (int i = 0; i < nsamples; ++i) {
+		preL[prePos] = inL[i];
+		preR[prePos] = inR[i];
+		const int readPos = (prePos - predelay) & preMask;
+		float l, r;
+		tick(preL[readPos], preR[readPos], l, r);
+		outL[i] += l;
+		outR[i] += r;
+		prePos = (prePos + 1) & preMask;
+	}
+}
+
+void FDN::renderImpulse(int input, std::vector<float>& outL, std::vector<float>& outR, int length)
+{
+	clear();
+	outL.assign(length, 0.f);
+	outR.assign(length, 0.f);
+	for (int i = 0; i < length; ++i) {
+		const float x = i == predelay ? 1.f : 0.f;
+		tick(input == 0 ? x : 0.f, input == 1 ? x : 0.f, outL[i], outR[i]);
+	}
+	clear();
+}
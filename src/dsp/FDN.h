@@ -0,0 +1,84 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+
+/*
+	Complementary three band split made of two one pole lowpasses,
+	low + mid + high always sums back to the input.
+*/
+struct BandSplit
+{
+	static constexpr float LOW_FREQ = 500.f;
+	static constexpr float HIGH_FREQ = 4000.f;
+
+	float a1 = 0.f, a2 = 0.f;
+	float z1 = 0.f, z2 = 0.f;
+
+	void init(double srate)
+	{
+		a1 = (float)(1.0 - std::exp(-MathConstants<double>::twoPi * LOW_FREQ / srate));
+		a2 = (float)(1.0 - std::exp(-MathConstants<double>::twoPi * HIGH_FREQ / srate));
+		z1 = z2 = 0.f;
+	}
+
+	inline void split(float x, float& low, float& mid, float& high)
+	{
+		z1 += a1 * (x - z1);
+		z2 += a2 * (x - z2);
+		low = z1;
+		mid = z2 - z1;
+		high = x - z2;
+	}
+
+	inline float apply(float x, const std::array<float, 3>& gains)
+	{
+		float low, mid, high;
+		split(x, low, mid, high);
+		return gains[0] * low + gains[1] * mid + gains[2] * high;
+	}
+};
+
+/*
+	Feedback delay network for the hybrid late tail.
+	Eight delay lines mixed by a normalized Hadamard matrix, each line absorbs
+	per band so the network decays with the given RT60s, and each output has
+	a three band gain calibrated against the IR it replaces.
+	Left input feeds and left output reads the even lines, right uses the odd ones.
+*/
+class FDN
+{
+public:
+	static constexpr int NUM_LINES = 8;
+
+	FDN() {}
+	~FDN() {}
+
+	void prepare(double srate, int onset, int samplesPerBlock); // onset is the delay of the first output sample
+	void setDecay(const std::array<float, 3>& rt60); // seconds per band
+	void setOutputGains(int channel, const std::array<float, 3>& gains);
+	void process(const float* inL, const float* inR, float* outL, float* outR, int nsamples); // adds to outputs
+	void clear();
+	// impulse response from one input to both outputs, resets the network state
+	void renderImpulse(int input, std::vector<float>& outL, std::vector<float>& outR, int length);
+
+private:
+	inline void tick(float inL, float inR, float& outL, float& outR);
+
+	double srate = 44100.0;
+	std::array<std::vector<float>, NUM_LINES> lines;
+	std::array<int, NUM_LINES> lengths = {};
+	std::array<int, NUM_LINES> positions = {};
+	std::array<std::array<float, 3>, NUM_LINES> absorption = {};
+	std::array<BandSplit, NUM_LINES> lineSplits;
+	std::array<std::array<float, 3>, 2> outputGains = {};
+	std::array<BandSplit, 2> outputSplits;
+
+	std::vector<float> preL, preR; // input predelay
+	int prePos = 0;
+	int preMask = 0;
+	int predelay = 0;
+};
@@ -1,4 +1,5 @@
 #include "Filter.h"
+#include <cstring>
 
 void Filter::init(float srate, float freq, float q, float q2)
 {
@@ -65,4 +66,129 @@ void Filter::reset(float sample)
 {
     ic1 = ic2 = ic3 = ic4 = sample;
     state = sample;
-}
\ No newline at end of file
+}
+
+void StereoFilter::init(float srate, float freq, float q, float q2)
+{
+    Coeffs c;
+    c.g = Filter::getCoeff(freq, srate);
+    c.k = 2 - 2*q;
+    c.k2 = 2 - 2*q2;
+
+    if (slope == k6dB) {
+        c.g = c.g / (1.0f + c.g);
+    }
+    else {
+        c.a1 = 1.0f / (1.0f + c.g * (c.g + c.k));
+        c.a2 = c.g * c.a1;
+        c.a3 = c.g * c.a2;
+
+        c.a12 = 1.0f / (1.0f + c.g * (c.g + c.k2));
+        c.a22 = c.g * c.a12;
+        c.a32 = c.g * c.a22;
+    }
+
+    target = c;
+    if (snap) {
+        current = target;
+        snap = false;
+    }
+    ramping = std::memcmp(&current, &target, sizeof(Coeffs)) != 0;
+}
+
+void StereoFilter::reset(float sample)
+{
+    ic1 = ic2 = ic3 = ic4 = state = Lanes::expand(sample);
+    current = target;
+    ramping = false;
+    snap = true;
+}
+
+void StereoFilter::process(float* left, float* right, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    if (slope == k6dB) processSlope<k6dB>(left, right, numSamples);
+    else if (slope == k12dB) processSlope<k12dB>(left, right, numSamples);
+    else processSlope<k24dB>(left, right, numSamples);
+
+    current = target;
+    ramping = false;
+}
+
+template <FilterSlope S>
+void StereoFilter::processSlope(float* left, float* right, int numSamples)
+{
+    if (mode == LP) ramping ? processBlock<S, LP, true>(left, right, numSamples) : processBlock<S, LP, false>(left, right, numSamples);
+    else if (mode == BP) ramping ? processBlock<S, BP, true>(left, right, numSamples) : processBlock<S, BP, false>(left, right, numSamples);
+    else ramping ? processBlock<S, HP, true>(left, right, numSamples) : processBlock<S, HP, false>(left, right, numSamples);
+}
+
+template <FilterSlope S, FilterMode M, bool Ramp>
+void StereoFilter::processBlock(float* left, float* right, int numSamples)
+{
+    // per sample coefficient increments towards the target
+    Coeffs c = current;
+    Coeffs d;
+    if (Ramp) {
+        const float inc = 1.0f / (float)numSamples;
+        d.g = (target.g - c.g) * inc;
+        d.k = (target.k - c.k) * inc;
+        d.k2 = (target.k2 - c.k2) * inc;
+        d.a1 = (target.a1 - c.a1) * inc;
+        d.a2 = (target.a2 - c.a2) * inc;
+        d.a3 = (target.a3 - c.a3) * inc;
+        d.a12 = (target.a12 - c.a12) * inc;
+        d.a22 = (target.a22 - c.a22) * inc;
+        d.a32 = (target.a32 - c.a32) * inc;
+    }
+
+    alignas(Lanes::SIMDRegisterSize) float io[Lanes::SIMDNumElements] = {};
+    for (int i = 0; i < numSamples; ++i) {
+        if (Ramp) {
+            c.g += d.g; c.k += d.k; c.k2 += d.k2;
+            c.a1 += d.a1; c.a2 += d.a2; c.a3 += d.a3;
+            c.a12 += d.a12; c.a22 += d.a22; c.a32 += d.a32;
+        }
+
+        io[0] = left[i];
+        io[1] = right[i];
+        const Lanes x = Lanes::fromRawArray(io);
+        Lanes output;
+
+        if (S == k6dB) {
+            state += (x - state) * c.g;
+            output = M == LP ? state : x - state;
+        }
+        else {
+            // 12p first stage
+            auto v3 = x - ic2;
+            auto v1 = ic1 * c.a1 + v3 * c.a2; // band
+            auto v2 = ic2 + ic1 * c.a2 + v3 * c.a3; // low
+            ic1 = v1 * 2.0f - ic1;
+            ic2 = v2 * 2.0f - ic2;
+
+            if (M == LP) output = v2;
+            else if (M == BP) output = v1;
+            else output = x - v1 * c.k - v2;
+
+            if (S == k24dB) {
+                // 24p second stage
+                v3 = output - ic4;
+                v1 = ic3 * c.a12 + v3 * c.a22;
+                v2 = ic4 + ic3 * c.a22 + v3 * c.a32;
+                ic3 = v1 * 2.0f - ic3;
+                ic4 = v2 * 2.0f - ic4;
+
+                if (M == LP) output = v2;
+                else if (M == BP) output = v1;
+                else output = output - v1 * c.k2 - v2;
+            }
+        }
+
+        output.copyToRawArray(io);
+        left[i] = io[0];
+        right[i] = io[1];
+    }
+}
@@ -77,4 +77,54 @@ private:
 
 	// 6db vars
 	float state = 0.0f;
-};
\ No newline at end of file
+};
+
+// Left and right channels of the same filter evaluated in SIMD lanes, one block at a time
+// the kernels are specialized per slope and mode so the sample loop has no branches
+// coefficients set by init() ramp linearly across the next block instead of jumping
+class StereoFilter
+{
+public:
+	using Lanes = juce::dsp::SIMDRegister<float>;
+
+	FilterSlope slope;
+	FilterMode mode;
+
+	StereoFilter(FilterSlope slope, FilterMode mode) : slope(slope), mode(mode) {}
+
+	void setSlope(FilterSlope s) { slope = s; };
+	void setMode(FilterMode m) { mode = m; };
+	void init(float srate, float freq, float q = 0.0765f, float q2 = 0.6173f);
+	void process(float* left, float* right, int numSamples);
+	void reset(float sample);
+
+private:
+	struct Coeffs
+	{
+		float g = 0.0f;
+		float k = 0.0f;
+		float k2 = 0.0f;
+		float a1 = 0.0f;
+		float a2 = 0.0f;
+		float a3 = 0.0f;
+		float a12 = 0.0f;
+		float a22 = 0.0f;
+		float a32 = 0.0f;
+	};
+
+	template <FilterSlope S>
+	void processSlope(float* left, float* right, int numSamples);
+	template <FilterSlope S, FilterMode M, bool Ramp>
+	void processBlock(float* left, float* right, int numSamples);
+
+	Coeffs current;
+	Coeffs target;
+	bool ramping = false;
+	bool snap = true; // the first init after a reset applies immediately
+
+	Lanes ic1 = Lanes::expand(0.0f);
+	Lanes ic2 = Lanes::expand(0.0f);
+	Lanes ic3 = Lanes::expand(0.0f);
+	Lanes ic4 = Lanes::expand(0.0f);
+	Lanes state = Lanes::expand(0.0f);
+};
@@ -61,6 +61,8 @@ Impulse::Impulse() : _fft()
     re.resize(FFT_SIZE);
     im.resize(FFT_SIZE);
     _fft.init(FFT_SIZE);
+    decayEQ.reserve(EQ_BANDS); // updated from the audio thread by copy
+    paramEQ.reserve(EQ_BANDS);
 
     const float w = 2.0f * MathConstants<float>::pi / FFT_SIZE;
     for (int i = 0; i < FFT_SIZE / 2; ++i)
@@ -74,6 +76,58 @@ void Impulse::prepare(double _srate)
     srate = _srate;
 }
 
+void Impulse::copySettings(const Impulse& other)
+{
+    srate = other.srate;
+    attack = other.attack;
+    decay = other.decay;
+    trimLeft = other.trimLeft;
+    trimRight = other.trimRight;
+    stretch = other.stretch;
+    decayRate = other.decayRate;
+    gain = other.gain;
+    reverse = other.reverse;
+    paramEQ = other.paramEQ;
+    decayEQ = other.decayEQ;
+    matrixChannels = other.matrixChannels;
+}
+
+const std::vector<float>* Impulse::getMatrixRoute(int in, int out) const
+{
+    const int nchans = (int)channels.size();
+    if (nchans == 0 || matrixChannels <= 2)
+        return nullptr;
+    if (nchans >= matrixChannels * matrixChannels)
+        return &channels[in * matrixChannels + out];
+    return in == out ? &channels[in % nchans] : nullptr;
+}
+
+std::vector<std::vector<float>*> Impulse::getBuffers()
+{
+    std::vector<std::vector<float>*> bufs = { &bufferLL, &bufferRR };
+    if (isQuad) {
+        bufs.push_back(&bufferLR);
+        bufs.push_back(&bufferRL);
+    }
+    for (auto& chan : channels)
+        bufs.push_back(&chan);
+    return bufs;
+}
+
+// the resamplers work on channel pairs, an odd last channel is paired with a copy of itself
+void Impulse::applyChannelPairs(const std::function<void(std::vector<float>&, std::vector<float>&)>& fn)
+{
+    for (size_t i = 0; i < channels.size(); i += 2) {
+        if (i + 1 < channels.size()) {
+            fn(channels[i], channels[i + 1]);
+        }
+        else {
+            auto copy = channels[i];
+            fn(channels[i], copy);
+        }
+    }
+}
+
 void Impulse::load(String filepath)
 {
     AudioFormatManager manager;
@@ -119,8 +173,8 @@ void Impulse::load(String filepath)
         int nsamps = buf.getNumSamples();
         if (nsamps == 0) throw "Load default impulse";
 
-        // find and load true stereo match file
-        if (nchans == 2) {
+        // find and load true stereo match file, the matrix convolves the file channels as they are
+        if (nchans == 2 && matrixChannels <= 2) {
             auto match = findTrueStereoPair(filepath, nsamps, irsrate);
             if (match.path.isNotEmpty()) {
                 auto f2 = File(match.path);
@@ -156,6 +210,14 @@ void Impulse::load(String filepath)
         const float* data = buf.getReadPointer(0);
         rawBufferLL.assign(data, data + tailStart);
 
+        rawChannels.clear();
+        if (matrixChannels > 2) {
+            for (int ch = 0; ch < nchans; ++ch) {
+                data = buf.getReadPointer(ch);
+                rawChannels.emplace_back(data, data + tailStart);
+            }
+        }
+
         if (isQuad) {
             numChans = 4;
             data = buf.getReadPointer(1);
@@ -305,6 +367,7 @@ void Impulse::recalcImpulse()
         bufferLR = rawBufferLR;
         bufferRL = rawBufferRL;
     }
+    channels = rawChannels;
 
     if (bufferLL.size() == 0 || bufferRR.size() == 0) {
         jassertfalse;
@@ -322,6 +385,9 @@ void Impulse::recalcImpulse()
             bufferRL[i] *= autoGain;
         }
     }
+    for (auto& chan : channels)
+        for (auto& v : chan)
+            v *= autoGain;
 
     if (reverse) {
         std::reverse(bufferLL.begin(), bufferLL.end());
@@ -331,13 +397,23 @@ void Impulse::recalcImpulse()
             std::reverse(bufferLR.begin(), bufferLR.end());
             std::reverse(bufferRL.begin(), bufferRL.end());
         }
+        for (auto& chan : channels)
+            std::reverse(chan.begin(), chan.end());
     }
 
+    // drafts skip the trimmed sections before the costly stages
+    const size_t rawSize = bufferLL.size();
+    size_t cropStart = 0;
+    size_t cropEnd = rawSize;
+    if (draft)
+        cropDraft(cropStart, cropEnd);
+
     resampleIRToProjectRate(bufferLL, bufferRR);
     if (isQuad) resampleIRToProjectRate(bufferLR, bufferRL);
+    applyChannelPairs([this](auto& l, auto& r) { resampleIRToProjectRate(l, r); });
 
     peak = 0.f;
-    for (int i = 0; i < numSamples; ++i) {
+    for (size_t i = 0; i < bufferLL.size(); ++i) {
         peak = std::max(std::max(peak, std::fabs(bufferLL[i])), std::fabs(bufferRR[i]));
         if (isQuad) {
             peak = std::max(std::max(peak, std::fabs(bufferLR[i])), std::fabs(bufferRL[i]));
@@ -347,14 +423,37 @@ void Impulse::recalcImpulse()
     auto s = stretch;
     applyStretch(bufferLL, bufferRR, s);
     if (isQuad) applyStretch(bufferLR, bufferRL, s);
+    applyChannelPairs([this, s](auto& l, auto& r) { applyStretch(l, r, s); });
 
-    applyTrim();
+    if (draft) {
+        // the buffers hold the cropped section, the trims are rebuilt at the final rate for drawing
+        // and the envelope spans the full trimmed length as in a regular build
+        const double scale = (double)bufferLL.size() / (double)std::max(size_t(1), cropEnd - cropStart);
+        const size_t trimEnd = rawSize - static_cast<size_t>(trimRight * rawSize);
+        trimLeftSamples = (int)(cropStart * scale);
+        trimRightSamples = (int)((rawSize - cropEnd) * scale);
+        envelopeSize = (size_t)((std::max(trimEnd, cropStart) - cropStart) * scale);
+    }
+    else {
+        applyTrim();
+        envelopeSize = bufferLL.size();
+    }
     applyGain();
     applyParamEQ();
     applyDecayEQ();
     applyClip();
     applyEnvelope();
 
+    // mono and dual mono files end up with bit identical channels
+    isDualMono = !isQuad && bufferLL.size() == bufferRR.size()
+        && std::equal(bufferLL.begin(), bufferLL.end(), bufferRR.begin());
+
+    sparseLength = (int)(srate * EARLY_REFLECTIONS_MS / 1000.0);
+    findSparseTaps(bufferLL, tapsLL);
+    findSparseTaps(bufferRR, tapsRR);
+    findSparseTaps(bufferLR, tapsLR);
+    findSparseTaps(bufferRL, tapsRL);
+
     duration = ((double)bufferLL.size() + trimLeftSamples + trimRightSamples) / srate;
     version += 1;
 }
@@ -442,62 +541,48 @@ void Impulse::applyTrim()
     size_t end = totalSamples - static_cast<size_t>(trimRight * totalSamples);
 
     if (start >= end || start >= totalSamples || end > totalSamples) {
-        bufferLL.clear();
-        bufferRR.clear();
-        if (isQuad) {
-            bufferLR.clear();
-            bufferRL.clear();
-        }
+        for (auto* buf : getBuffers())
+            buf->clear();
         return;
     }
 
     trimLeftSamples = (int)start;
     trimRightSamples = (int)(totalSamples - end);
 
-    bufferLL.erase(bufferLL.begin() + end, bufferLL.end());
-    bufferLL.erase(bufferLL.begin(), bufferLL.begin() + start);
-
-    bufferRR.erase(bufferRR.begin() + end, bufferRR.end());
-    bufferRR.erase(bufferRR.begin(), bufferRR.begin() + start);
-
-    if (isQuad) {
-        bufferLR.erase(bufferLR.begin() + end, bufferLR.end());
-        bufferLR.erase(bufferLR.begin(), bufferLR.begin() + start);
-
-        bufferRL.erase(bufferRL.begin() + end, bufferRL.end());
-        bufferRL.erase(bufferRL.begin(), bufferRL.begin() + start);
+    for (auto* buf : getBuffers()) {
+        buf->erase(buf->begin() + std::min(end, buf->size()), buf->end());
+        buf->erase(buf->begin(), buf->begin() + std::min(start, buf->size()));
     }
 }
 
 void Impulse::applyGain()
 {
     auto g = gain;
-    auto size = bufferLL.size();
-    for (int i = 0; i < size; ++i) {
-        bufferLL[i] *= g;
-        bufferRR[i] *= g;
-    }
-    if (isQuad) {
-        for (int i = 0; i < size; ++i) {
-            bufferLR[i] *= g;
-            bufferRL[i] *= g;
-        }
+    for (auto* buf : getBuffers())
+        for (auto& v : *buf)
+            v *= g;
+}
+
+// keeps the raw section that survives the trims, limited to what renders DRAFT_IR_MS after stretching
+void Impulse::cropDraft(size_t& cropStart, size_t& cropEnd)
+{
+    const size_t rawSize = bufferLL.size();
+    const double rawPerOutput = irsrate / srate / std::pow(2.0, (double)stretch);
+    cropStart = std::min(rawSize, static_cast<size_t>(trimLeft * rawSize));
+    cropEnd = std::max(cropStart, rawSize - static_cast<size_t>(trimRight * rawSize));
+    cropEnd = std::min(cropEnd, cropStart + (size_t)(DRAFT_IR_MS / 1000.0 * srate * rawPerOutput));
+
+    for (auto* buf : getBuffers()) {
+        buf->erase(buf->begin() + std::min(cropEnd, buf->size()), buf->end());
+        buf->erase(buf->begin(), buf->begin() + std::min(cropStart, buf->size()));
     }
 }
 
 void Impulse::applyClip()
 {
-    auto size = bufferLL.size();
-    for (int i = 0; i < size; ++i) {
-        bufferLL[i] = std::clamp(bufferLL[i], -1.f, 1.f);
-        bufferRR[i] = std::clamp(bufferRR[i], -1.f, 1.f);
-    }
-    if (isQuad) {
-        for (int i = 0; i < size; ++i) {
-            bufferLR[i] = std::clamp(bufferLR[i], -1.f, 1.f);
-            bufferRL[i] = std::clamp(bufferRL[i], -1.f, 1.f);
-        }
-    }
+    for (auto* buf : getBuffers())
+        for (auto& v : *buf)
+            v = std::clamp(v, -1.f, 1.f);
 }
 
 void Impulse::applyParamEQ()
@@ -524,14 +609,9 @@ void Impulse::applyParamEQ()
         return;
 
     for (auto& svf : eq) {
-        svf.processBlock(bufferLL.data(), size, 0, size, svf.freq, svf.q, svf.gain);
-        svf.clear(0.f);
-        svf.processBlock(bufferRR.data(), size, 0, size, svf.freq, svf.q, svf.gain);
-        if (isQuad) {
+        for (auto* buf : getBuffers()) {
             svf.clear(0.f);
-            svf.processBlock(bufferLR.data(), size, 0, size, svf.freq, svf.q, svf.gain);
-            svf.clear(0.f);
-            svf.processBlock(bufferRL.data(), size, 0, size, svf.freq, svf.q, svf.gain);
+            svf.processBlock(buf->data(), (int)buf->size(), 0, (int)buf->size(), svf.freq, svf.q, svf.gain);
         }
     }
 }
@@ -590,12 +670,8 @@ void Impulse::applyDecayEQ()
         decayLUT[i] = _decay;
     }
 
-    applyDecay(bufferLL, decayLUT);
-    applyDecay(bufferRR, decayLUT);
-    if (isQuad) {
-        applyDecay(bufferLR, decayLUT);
-        applyDecay(bufferRL, decayLUT);
-    }
+    for (auto* buf : getBuffers())
+        applyDecay(*buf, decayLUT);
 }
 
 void Impulse::applyDecay(std::vector<float>& buf, std::vector<double>& decayLUT)
@@ -653,30 +729,115 @@ void Impulse::applyEnvelope()
     auto size = (int)bufferLL.size();
     if (!size) return;
 
-    int attackSize = int(attack * size);
-    int decaySize = int(decay * size);
+    auto envSize = (int)std::max(envelopeSize, bufferLL.size());
+    int attackSize = int(attack * envSize);
+    int decaySize = int(decay * envSize);
 
-    for (int i = 0; i < attackSize; ++i) {
+    auto bufs = getBuffers();
+    for (int i = 0; i < std::min(attackSize, size); ++i) {
         float envgain = static_cast<float>(i) / static_cast<float>(attackSize);
-        bufferLL[i] *= envgain;
-        bufferRR[i] *= envgain;
-        if (isQuad) {
-            bufferLR[i] *= envgain;
-            bufferRL[i] *= envgain;
-        }
+        for (auto* buf : bufs)
+            (*buf)[i] *= envgain;
     }
 
     for (int i = 0; i < decaySize; ++i) {
         float t = static_cast<float>(i) / static_cast<float>(decaySize);
         float envgain = 1.0f - (float)std::pow(t, 0.5);  // reverse exponential
-        auto idx = size - decaySize + i;
-        bufferLL[idx] *= envgain;
-        bufferRR[idx] *= envgain;
-        if (isQuad) {
-            bufferLR[idx] *= envgain;
-            bufferRL[idx] *= envgain;
+        auto idx = envSize - decaySize + i;
+        if (idx >= size) break;
+        for (auto* buf : bufs)
+            (*buf)[idx] *= envgain;
+    }
+}
+
+// finds discrete reflections in the early part of the IR, taps stay empty
+// if there are too many of them or the gaps between them are not near silence
+void Impulse::findSparseTaps(const std::vector<float>& buf, std::vector<TapDelay::Tap>& taps) const
+{
+    taps.clear();
+    const int len = std::min((int)buf.size(), sparseLength);
+    float early = 0.f;
+    for (int i = 0; i < len; ++i)
+        early = std::max(early, std::fabs(buf[i]));
+    if (early == 0.f) return;
+
+    const float tapFloor = early * SPARSE_TAP_FLOOR;
+    double tapEnergy = 0.0;
+    double restEnergy = 0.0;
+    for (int i = 0; i < len; ++i) {
+        const float s = buf[i];
+        if (std::fabs(s) >= tapFloor) {
+            if ((int)taps.size() == SPARSE_MAX_TAPS) {
+                taps.clear();
+                return;
+            }
+            taps.push_back({ i, s });
+            tapEnergy += (double)s * s;
+        }
+        else {
+            restEnergy += (double)s * s;
         }
     }
+
+    if (restEnergy > tapEnergy * SPARSE_REST_FLOOR)
+        taps.clear();
+}
+
+// fits the per band Schroeder decay curves after the junction, from -5dB to -25dB relative
+// to the junction level, and measures the band energies over [junction, junction + window)
+Impulse::BandDecay Impulse::analyseBandDecay(const std::vector<float>& buf, int junction, int window) const
+{
+    BandDecay result;
+    const int n = (int)buf.size();
+    if (junction <= 0 || junction >= n)
+        return result;
+
+    std::array<std::vector<float>, 3> bands;
+    for (auto& band : bands)
+        band.resize(n);
+    BandSplit split;
+    split.init(srate);
+    for (int i = 0; i < n; ++i)
+        split.split(buf[i], bands[0][i], bands[1][i], bands[2][i]);
+
+    const int end = std::min(n, junction + window);
+    std::vector<double> edc(n - junction + 1);
+    for (int b = 0; b < 3; ++b) {
+        const auto& band = bands[b];
+        double energy = 0.0;
+        for (int i = junction; i < end; ++i)
+            energy += (double)band[i] * band[i];
+        result.energy[b] = energy / std::max(1, end - junction);
+
+        // backwards integrated energy from the junction on
+        edc[n - junction] = 0.0;
+        for (int i = n - 1; i >= junction; --i)
+            edc[i - junction] = edc[i - junction + 1] + (double)band[i] * band[i];
+        if (edc[0] <= 0.0)
+            continue;
+
+        // least squares line over the fit range, decimated as the curve is smooth
+        double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+        int count = 0;
+        for (int i = 0; i < n - junction; i += 16) {
+            if (edc[i] <= 0.0) break;
+            const double db = 10.0 * std::log10(edc[i] / edc[0]);
+            if (db > -5.0) continue;
+            if (db < -25.0) break;
+            sx += i;
+            sy += db;
+            sxx += (double)i * i;
+            sxy += i * db;
+            count++;
+        }
+        const double denom = count * sxx - sx * sx;
+        if (count < 8 || denom <= 0.0)
+            continue;
+        const double slope = (count * sxy - sx * sy) / denom; // dB per sample
+        if (slope < 0.0)
+            result.rt60[b] = (float)jlimit(0.05, 60.0, -60.0 / slope / srate);
+    }
+    return result;
 }
 
 int Impulse::getTailStart(const float* data, int nsamples)
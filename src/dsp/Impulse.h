@@ -6,6 +6,8 @@
 #include "SVF.h"
 #include "../Globals.h"
 #include "AudioFFT.h"
+#include "TapDelay.h"
+#include "FDN.h"
 
 using namespace globals;
 
@@ -18,8 +20,18 @@ public:
 		bool swapChannels;
 	};
 
+	// per band (low, mid, high) decay of the IR past a junction point
+	struct BandDecay
+	{
+		std::array<float, 3> rt60 = { 1.f, 1.f, 1.f }; // seconds
+		std::array<double, 3> energy = { 0.0, 0.0, 0.0 }; // mean energy per sample over the analysis window
+	};
+
 	static constexpr int FFT_SIZE = 4096;
 	static constexpr size_t HOP_SIZE = FFT_SIZE / 4;
+	static constexpr int SPARSE_MAX_TAPS = 32;
+	static constexpr float SPARSE_TAP_FLOOR = 1e-3f; // -60dB of the early peak, quieter samples are not taps
+	static constexpr double SPARSE_REST_FLOOR = 1e-7; // energy between taps must stay 70dB below the taps
 
 	Impulse();
 	~Impulse() {}
@@ -29,6 +41,12 @@ public:
 	void prepare(double _srate);
 	void load(String path);
 	void recalcImpulse();
+	void copySettings(const Impulse& other); // processing params only, the IR file stays
+	BandDecay analyseBandDecay(const std::vector<float>& buf, int junction, int window) const;
+	// IR from an input to an output channel of the matrix, nullptr if the route is silent
+	// files with N*N channels hold every route input major like the quad files (LL, LR, RL, RR),
+	// files with fewer channels are convolved channel by channel
+	const std::vector<float>* getMatrixRoute(int in, int out) const;
 
 	audiofft::AudioFFT _fft;
 	std::vector<float> window;
@@ -52,6 +70,7 @@ public:
 	float peak = 0.0f; // used for drawing the impulse
 	int trimLeftSamples = 0; // used for drawing
 	int trimRightSamples = 0; // used for drawing
+	bool draft = false; // preview build while a parameter is dragged, trimmed section only and at most DRAFT_IR_MS
 
 	double srate = 44100.0;
 	double stretchsrate = 44100.0; // stretch samplerate
@@ -67,17 +86,31 @@ public:
 	float gain = 1.f;
 	bool reverse = false;
 	bool isQuad = false;
+	bool isDualMono = false; // LL and RR impulses are identical, e.g. mono files
+	int sparseLength = 0; // early samples analysed for sparse taps
+	std::vector<TapDelay::Tap> tapsLL = {}; // sparse early reflections, empty when the early part is dense
+	std::vector<TapDelay::Tap> tapsLR = {};
+	std::vector<TapDelay::Tap> tapsRR = {};
+	std::vector<TapDelay::Tap> tapsRL = {};
+	int matrixChannels = 0; // bus channels, above 2 every file channel is kept for the convolution matrix
+	std::vector<std::vector<float>> rawChannels = {};
+	std::vector<std::vector<float>> channels = {}; // processed file channels, see getMatrixRoute()
 	double duration = 0.0; // display only value
 	unsigned long int version = 1;
 
 
 private:
+	std::vector<std::vector<float>*> getBuffers(); // every route buffer in use, stereo and matrix
+	size_t envelopeSize = 0; // length spanned by the attack and decay envelope, drafts hold only its start
+	void applyChannelPairs(const std::function<void(std::vector<float>&, std::vector<float>&)>& fn);
 	float calculateAutoGain(const std::vector<float>& dataL, const std::vector<float>& dataR);
 	void resampleIRToProjectRate(std::vector<float>& bufL, std::vector<float>& bufR) const;
 	int getTailStart(const float* data, int nsamples);
+	void findSparseTaps(const std::vector<float>& buf, std::vector<TapDelay::Tap>& taps) const;
 	void applyStretch(std::vector<float>& bufL, std::vector<float>& bufR, float _stretch);
 	void applyTrim();
 	void applyEnvelope();
+	void cropDraft(size_t& cropStart, size_t& cropEnd);
 	void applyClip();
 	void applyParamEQ();
 	void applyDecayEQ();
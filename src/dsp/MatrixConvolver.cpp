@@ -0,0 +1,154 @@
+#include "MatrixConvolver.h"
+
+void MatrixConvolver::prepare(int samplesPerBlock, int _numChannels)
+{
+	reset();
+	size = samplesPerBlock;
+	numChannels = _numChannels;
+	headBlockSize = 1;
+	while (headBlockSize < static_cast<size_t>(samplesPerBlock)) {
+		headBlockSize *= 2;
+	}
+	tailBlockSize = std::max(size_t(8192), 2 * headBlockSize);
+	inputs.resize(numChannels);
+	for (auto& input : inputs) {
+		input.convolver = std::make_unique<PooledConvolver>();
+		input.convolver->setSynchronous(synchronous);
+	}
+	outputs.assign(numChannels, std::vector<float>(samplesPerBlock, 0.f));
+}
+
+void MatrixConvolver::setPartitions(size_t head, size_t tail)
+{
+	jassert(isPowerOfTwo(head) && isPowerOfTwo(tail) && head <= tail);
+	headBlockSize = head;
+	tailBlockSize = tail;
+}
+
+void MatrixConvolver::load(const std::vector<const std::vector<float>*>& routes, bool halfPrecision)
+{
+	jassert((int)routes.size() == numChannels * numChannels);
+
+	for (int in = 0; in < numChannels; ++in) {
+		auto& input = inputs[in];
+		input.convolver->waitForIdle();
+		input.convolver->reset();
+		input.routes.clear();
+		input.targets.clear();
+
+		// group the outputs fed by the same IR, silent routes are skipped
+		std::vector<const std::vector<float>*> distinct;
+		for (int out = 0; out < numChannels; ++out) {
+			auto* ir = routes[in * numChannels + out];
+			if (!ir || ir->empty() || std::all_of(ir->begin(), ir->end(), [](float v) { return v == 0.f; }))
+				continue;
+			auto it = std::find_if(distinct.begin(), distinct.end(), [ir](auto* other) { return other == ir || *other == *ir; });
+			if (it == distinct.end()) {
+				distinct.push_back(ir);
+				input.targets.push_back({ out });
+			}
+			else {
+				input.targets[it - distinct.begin()].push_back(out);
+			}
+		}
+
+		size_t irLen = 0;
+		for (auto* ir : distinct)
+			irLen = std::max(irLen, ir->size());
+		for (auto* ir : distinct) {
+			input.routes.emplace_back(*ir);
+			input.routes.back().resize(irLen, 0.f);
+		}
+
+		input.buffers.assign(distinct.size(), std::vector<float>(size, 0.f));
+		input.pointers.clear();
+		for (auto& buf : input.buffers)
+			input.pointers.push_back(buf.data());
+
+		if (distinct.empty())
+			continue;
+
+		// an earlier input with the same routes lends its spectra, this one only keeps its input history
+		bool shared = false;
+		for (int prev = 0; prev < in && !shared; ++prev) {
+			if (inputs[prev].routes == input.routes)
+				shared = input.convolver->initFrom(*inputs[prev].convolver);
+		}
+		if (!shared) {
+			std::vector<const float*> irs;
+			for (auto& route : input.routes)
+				irs.push_back(route.data());
+			input.convolver->setHalfPrecision(halfPrecision);
+			input.convolver->initRoutes(headBlockSize, tailBlockSize, irs.data(), irs.size(), irLen);
+		}
+	}
+
+	// the padded copies are only needed to find shared inputs
+	for (auto& input : inputs) {
+		input.routes.clear();
+		input.routes.shrink_to_fit();
+	}
+}
+
+void MatrixConvolver::process(const float* const* data, size_t nsamples)
+{
+	for (auto& out : outputs)
+		FloatVectorOperations::clear(out.data(), (int)nsamples);
+
+	for (int in = 0; in < numChannels; ++in) {
+		auto& input = inputs[in];
+		if (input.targets.empty())
+			continue;
+		input.convolver->processRoutes(data[in], input.pointers.data(), nsamples);
+		for (size_t r = 0; r < input.targets.size(); ++r) {
+			for (int out : input.targets[r])
+				FloatVectorOperations::add(outputs[out].data(), input.buffers[r].data(), (int)nsamples);
+		}
+	}
+}
+
+void MatrixConvolver::setDecay(float gainPerSample)
+{
+	for (auto& input : inputs)
+		input.convolver->setDecay(gainPerSample);
+}
+
+void MatrixConvolver::setSynchronous(bool sync)
+{
+	synchronous = sync;
+	for (auto& input : inputs)
+		input.convolver->setSynchronous(sync);
+}
+
+void MatrixConvolver::clear()
+{
+	for (auto& input : inputs)
+		input.convolver->clear();
+	for (auto& out : outputs)
+		std::fill(out.begin(), out.end(), 0.f);
+}
+
+void MatrixConvolver::reset()
+{
+	for (auto& input : inputs) {
+		input.convolver->waitForIdle();
+		input.convolver->reset();
+		input.targets.clear();
+	}
+}
+
+size_t MatrixConvolver::getIRMemoryUsage() const
+{
+	size_t total = 0;
+	for (auto& input : inputs)
+		total += input.convolver->getIRMemoryUsage();
+	return total;
+}
+
+int MatrixConvolver::getUniqueRouteCount() const
+{
+	int count = 0;
+	for (auto& input : inputs)
+		count += (int)input.targets.size();
+	return count;
+}
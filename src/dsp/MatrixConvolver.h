@@ -0,0 +1,48 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include "ConvolverPool.h"
+
+// N channel convolution matrix for surround and ambisonic IRs
+// each input is transformed once for all of its routes, identical routes are convolved once
+// and feed several outputs, inputs with the same routes share the IR spectra
+// cost grows with the number of unique routes instead of the channel count squared
+class MatrixConvolver
+{
+public:
+    MatrixConvolver() {}
+    ~MatrixConvolver() {}
+
+    void prepare(int samplesPerBlock, int numChannels);
+    void setPartitions(size_t head, size_t tail);
+    // routes holds channels * channels IRs input major (in * channels + out), nullptr routes are silent
+    void load(const std::vector<const std::vector<float>*>& routes, bool halfPrecision);
+    void process(const float* const* inputs, size_t nsamples); // writes every channel of outputs
+    void setDecay(float gainPerSample);
+    void clear();
+    void reset(); // not on the audio thread
+    void setSynchronous(bool sync); // see PooledConvolver::setSynchronous
+    size_t getIRMemoryUsage() const;
+    int getNumChannels() const { return numChannels; }
+    int getUniqueRouteCount() const; // routes convolved per block
+
+    std::vector<std::vector<float>> outputs;
+
+private:
+    struct Input
+    {
+        std::unique_ptr<PooledConvolver> convolver;
+        std::vector<std::vector<float>> routes; // distinct IRs of this input padded to the same length
+        std::vector<std::vector<int>> targets; // outputs fed by each distinct route
+        std::vector<std::vector<float>> buffers;
+        std::vector<float*> pointers;
+    };
+
+    std::vector<Input> inputs;
+    int numChannels = 0;
+    bool synchronous = false;
+    int size = 0;
+    size_t headBlockSize = 0;
+    size_t tailBlockSize = 0;
+};
@@ -0,0 +1,250 @@
+#include "MultirateTail.h"
+
+namespace
+{
+	constexpr int LOW_HIST_SIZE = 64; // power of 2, >= taps per phase
+
+	size_t nextPow2(size_t n)
+	{
+		size_t p = 1;
+		while (p < n) p *= 2;
+		return p;
+	}
+
+	// raised cosine fade in of the late section
+	float fadeIn(int i, int len)
+	{
+		return 0.5f - 0.5f * std::cos(MathConstants<float>::pi * (i + 0.5f) / (float)len);
+	}
+}
+
+MultirateTail::MultirateTail(int _factor)
+	: factor(std::max(2, _factor))
+{
+	// windowed sinc lowpass, cutoff below the decimated nyquist so the transition band ends near it
+	const int len = TAPS_PER_PHASE * factor + 1;
+	delay = (len - 1) / 2;
+	const double cutoff = 0.425 / factor; // cycles per sample
+	fir.resize(len);
+	double sum = 0.0;
+	for (int i = 0; i < len; ++i) {
+		const double t = (double)(i - delay);
+		const double sinc = t == 0.0 ? 2.0 * cutoff : std::sin(MathConstants<double>::twoPi * cutoff * t) / (MathConstants<double>::pi * t);
+		const double w = 0.42 - 0.5 * std::cos(MathConstants<double>::twoPi * i / (len - 1)) + 0.08 * std::cos(2.0 * MathConstants<double>::twoPi * i / (len - 1));
+		fir[i] = (float)(sinc * w);
+		sum += fir[i];
+	}
+	for (auto& c : fir)
+		c = (float)(c / sum);
+
+	// interpolator polyphase branches, gain of factor restores the zero stuffed level
+	phases.resize(factor);
+	for (int p = 0; p < factor; ++p) {
+		for (int i = 0; i * factor + p < len; ++i) {
+			phases[p].push_back(fir[i * factor + p] * factor);
+		}
+	}
+
+	histL.resize(HIST_SIZE, 0.f);
+	histR.resize(HIST_SIZE, 0.f);
+	for (auto& hist : lowHist)
+		hist.resize(LOW_HIST_SIZE, 0.f);
+}
+
+void MultirateTail::prepare(int samplesPerBlock)
+{
+	const size_t lowBlock = (size_t)(samplesPerBlock / factor + 2);
+	lowL.resize(lowBlock, 0.f);
+	lowR.resize(lowBlock, 0.f);
+	for (auto& out : lowOut)
+		out.resize(lowBlock, 0.f);
+	headBlockSize = nextPow2((size_t)(samplesPerBlock + factor - 1) / factor);
+	tailBlockSize = std::max(size_t(4096), 2 * headBlockSize);
+}
+
+void MultirateTail::loadRoute(int route, const std::vector<float>& ir, int splitPos, int fadeLen, std::vector<float>& early, bool halfPrecision)
+{
+	const int n = (int)ir.size();
+	splitPos = std::max(splitPos, 3 * delay);
+	fadeLen = std::max(1, fadeLen);
+
+	// early section, full rate, fades out over the split
+	early.assign(ir.begin(), ir.begin() + std::min(n, splitPos + fadeLen));
+	for (int i = 0; i < fadeLen && splitPos + i < n; ++i)
+		early[splitPos + i] *= 1.f - fadeIn(i, fadeLen);
+
+	// late section fades in, padded so the filter never reads out of range
+	const int advance = 2 * delay; // decimator and interpolator delays
+	std::vector<float> late(n + advance + fir.size(), 0.f);
+	double lateEnergy = 0.0;
+	totalEnergy[route] = 0.0;
+	for (int i = 0; i < n; ++i) {
+		totalEnergy[route] += (double)ir[i] * ir[i];
+		if (i < splitPos) continue;
+		late[i] = i < splitPos + fadeLen ? ir[i] * fadeIn(i - splitPos, fadeLen) : ir[i];
+		lateEnergy += (double)late[i] * late[i];
+	}
+
+	// band limit and decimate, h_low[k] = factor * (h_late * fir)[k * factor + advance]
+	const int lowLen = std::max(0, (n - advance + delay) / factor + 1);
+	std::vector<float> lowIr(lowLen);
+	double lowEnergy = 0.0;
+	for (int k = 0; k < lowLen; ++k) {
+		const int start = k * factor + advance - delay;
+		double acc = 0.0;
+		for (int t = 0; t < (int)fir.size(); ++t)
+			acc += (double)late[start + t] * fir[fir.size() - 1 - t];
+		lowIr[k] = (float)(acc * factor);
+		lowEnergy += acc * acc * factor;
+	}
+
+	// what the band limit dropped, the decimated IR holds factor times fewer samples of the band
+	lostEnergy[route] = std::max(0.0, lateEnergy - lowEnergy);
+
+	if (!convolvers[route])
+		convolvers[route] = std::make_unique<Convolver>();
+	convolvers[route]->setSynchronous(synchronous);
+	convolvers[route]->setHalfPrecision(halfPrecision);
+	active[route] = convolvers[route]->init(headBlockSize, tailBlockSize, lowIr.data(), lowIr.size());
+}
+
+void MultirateTail::setDecay(float gainPerSample)
+{
+	// one decimated sample spans factor full rate samples, the advance keeps both time axes aligned
+	const float lowGain = std::pow(gainPerSample, (float)factor);
+	for (auto& conv : convolvers)
+		if (conv)
+			conv->setDecay(lowGain);
+}
+
+void MultirateTail::shareRoute(int route, int from)
+{
+	if (!convolvers[route])
+		convolvers[route] = std::make_unique<Convolver>();
+	convolvers[route]->setSynchronous(synchronous);
+	active[route] = active[from] && convolvers[route]->initFrom(*convolvers[from]);
+	lostEnergy[route] = lostEnergy[from];
+	totalEnergy[route] = totalEnergy[from];
+}
+
+void MultirateTail::resetRoute(int route)
+{
+	if (convolvers[route])
+		convolvers[route]->reset();
+	active[route] = false;
+	lostEnergy[route] = 0.0;
+	totalEnergy[route] = 0.0;
+}
+
+float MultirateTail::decimate(const std::vector<float>& hist, int writePos) const
+{
+	float acc = 0.f;
+	for (int t = 0; t < (int)fir.size(); ++t)
+		acc += fir[t] * hist[(writePos - t) & (HIST_SIZE - 1)];
+	return acc;
+}
+
+void MultirateTail::process(const float* dataL, const float* dataR, int nsamples, float* outLL, float* outRR, float* outLR, float* outRL)
+{
+	float* outs[4] = { outLL, outRR, outLR, outRL };
+	const float* lowIn[4] = { lowL.data(), lowR.data(), lowL.data(), lowR.data() };
+
+	// polyphase decimation, only every factor-th filter output is computed
+	int ph = phase;
+	int count = 0;
+	for (int i = 0; i < nsamples; ++i) {
+		histL[histPos] = dataL[i];
+		histR[histPos] = dataR[i];
+		if (ph == 0) {
+			lowL[count] = decimate(histL, histPos);
+			lowR[count] = decimate(histR, histPos);
+			count++;
+		}
+		histPos = (histPos + 1) & (HIST_SIZE - 1);
+		ph = ph + 1 == factor ? 0 : ph + 1;
+	}
+
+	// late convolution at the decimated rate
+	for (int r = 0; r < 4; ++r) {
+		if (active[r] && outs[r])
+			convolvers[r]->process(lowIn[r], lowOut[r].data(), (size_t)count);
+	}
+
+	// polyphase interpolation back to full rate, added to the early section
+	ph = phase;
+	int k = 0;
+	int latest = (lowHistPos - 1) & (LOW_HIST_SIZE - 1);
+	for (int i = 0; i < nsamples; ++i) {
+		if (ph == 0) {
+			for (int r = 0; r < 4; ++r)
+				lowHist[r][lowHistPos] = active[r] && outs[r] ? lowOut[r][k] : 0.f;
+			latest = lowHistPos;
+			lowHistPos = (lowHistPos + 1) & (LOW_HIST_SIZE - 1);
+			k++;
+		}
+		const auto& coeffs = phases[ph];
+		for (int r = 0; r < 4; ++r) {
+			if (!active[r] || !outs[r]) continue;
+			const auto& hist = lowHist[r];
+			float acc = 0.f;
+			for (int j = 0; j < (int)coeffs.size(); ++j)
+				acc += coeffs[j] * hist[(latest - j) & (LOW_HIST_SIZE - 1)];
+			outs[r][i] += acc;
+		}
+		ph = ph + 1 == factor ? 0 : ph + 1;
+	}
+	phase = ph;
+}
+
+void MultirateTail::clear()
+{
+	std::fill(histL.begin(), histL.end(), 0.f);
+	std::fill(histR.begin(), histR.end(), 0.f);
+	for (auto& hist : lowHist)
+		std::fill(hist.begin(), hist.end(), 0.f);
+	for (int r = 0; r < 4; ++r) {
+		if (convolvers[r])
+			convolvers[r]->clear();
+	}
+	histPos = 0;
+	lowHistPos = 0;
+	phase = 0;
+}
+
+void MultirateTail::reset()
+{
+	for (int r = 0; r < 4; ++r)
+		resetRoute(r);
+	clear();
+}
+
+void MultirateTail::setSynchronous(bool sync)
+{
+	synchronous = sync;
+	for (auto& conv : convolvers)
+		if (conv)
+			conv->setSynchronous(sync);
+}
+
+double MultirateTail::getErrorDb() const
+{
+	double lost = 0.0;
+	double total = 0.0;
+	for (int r = 0; r < 4; ++r) {
+		if (!active[r]) continue;
+		lost += lostEnergy[r];
+		total += totalEnergy[r];
+	}
+	if (lost <= 0.0 || total <= 0.0)
+		return -200.0;
+	return 10.0 * std::log10(lost / total);
+}
+
+size_t MultirateTail::getIRMemoryUsage() const
+{
+	size_t bytes = 0;
+	for (auto& conv : convolvers) {
+		if (conv) bytes += conv->getIRMemoryUsage();
+	}
+	return bytes;
+}
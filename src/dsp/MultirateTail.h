@@ -0,0 +1,73 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Convolver.h"
+#include <array>
+
+/*
+	Late IR section convolved at a decimated rate.
+	The IR is split in the time domain with a raised cosine crossfade, the early
+	part stays at full rate and the late part is band limited and decimated by
+	factor D. Inputs go through a polyphase decimator, the late convolutions run
+	at rate / D and their outputs through matched polyphase interpolators.
+	The linear phase filters delay is compensated by advancing the late IR,
+	so both sections stay phase aligned across the crossfade.
+
+	The error is the late section energy above the decimated band, which is
+	discarded, reported in dB relative to the whole IR energy.
+*/
+class MultirateTail
+{
+public:
+	static constexpr int TAPS_PER_PHASE = 32; // filter length is TAPS_PER_PHASE * factor + 1
+
+	MultirateTail(int factor);
+	~MultirateTail() {}
+
+	void prepare(int samplesPerBlock);
+	// splits ir at splitPos with a crossfade of fadeLen samples, early receives the full rate part
+	void loadRoute(int route, const std::vector<float>& ir, int splitPos, int fadeLen, std::vector<float>& early, bool halfPrecision);
+	// shares the late spectra of another route with an identical IR
+	void shareRoute(int route, int from);
+	void resetRoute(int route);
+	// adds the late section to the route outputs, routes are LL, RR, LR, RL
+	void process(const float* dataL, const float* dataR, int nsamples, float* outLL, float* outRR, float* outLR, float* outRL);
+	void setDecay(float gainPerSample); // full rate decay, see StereoConvolver::setDecay
+	void clear();
+	void reset();
+	void setSynchronous(bool sync); // see Convolver::setSynchronous
+	int getFactor() const { return factor; }
+	int getMinSplit() const { return 2 * delay; } // late IR must start after the filters delay
+	double getErrorDb() const;
+	size_t getIRMemoryUsage() const;
+
+	enum Route { LL = 0, RR, LR, RL };
+
+private:
+	float decimate(const std::vector<float>& hist, int writePos) const;
+
+	int factor;
+	int delay; // linear phase delay of one filter at full rate
+	std::vector<float> fir; // lowpass with unity DC gain
+	std::vector<std::vector<float>> phases; // interpolator coefficients per output phase
+	int phase = 0; // position of the next input sample within a decimation period
+
+	static constexpr int HIST_SIZE = 1024; // power of 2, >= fir size
+	std::vector<float> histL, histR; // full rate inputs
+	int histPos = 0;
+	std::vector<float> lowL, lowR; // decimated inputs of the current block
+
+	std::array<std::unique_ptr<Convolver>, 4> convolvers;
+	std::array<bool, 4> active = { false, false, false, false };
+	std::array<std::vector<float>, 4> lowOut; // decimated outputs of the current block
+	std::array<std::vector<float>, 4> lowHist; // recent decimated outputs for the interpolators
+	int lowHistPos = 0;
+
+	std::array<double, 4> lostEnergy = { 0.0, 0.0, 0.0, 0.0 };
+	std::array<double, 4> totalEnergy = { 0.0, 0.0, 0.0, 0.0 };
+	size_t headBlockSize = 0;
+	size_t tailBlockSize = 0;
+	bool synchronous = false;
+};
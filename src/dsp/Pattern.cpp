@@ -215,10 +215,12 @@ void Pattern::clearUnsafe()
 
 void Pattern::buildSegments()
 {
-    std::vector<PPoint> pts;
+    std::lock_guard<std::mutex> lock(mtx); // prevents crash while reading Y from another thread, guards buildPoints
+    auto& pts = buildPoints; // keeps its capacity, rebuilds on the audio thread only allocate after points were added
     {
-        std::lock_guard<std::mutex> lock(pointsmtx);
-        pts = points;
+        std::lock_guard<std::mutex> plock(pointsmtx);
+        pts.reserve(points.size() + 2);
+        pts.assign(points.begin(), points.end());
     }
     // add ghost points outside the 0..1 boundary
     // allows the pattern to repeat itself and rotate seamlessly
@@ -237,7 +239,6 @@ void Pattern::buildSegments()
         pts.push_back({0, p1.x + 1.0, p1.y, p1.tension, p1.type, false});
     }
 
-    std::lock_guard<std::mutex> lock(mtx); // prevents crash while reading Y from another thread
     segments.clear();
     for (size_t i = 0; i < pts.size() - 1; ++i) {
         auto p1 = pts[i];
@@ -257,6 +258,7 @@ void Pattern::buildSegments()
             }
         }
     }
+    hasClearTails.store(std::any_of(segments.begin(), segments.end(), [](const Segment& seg) { return seg.clearsTails; }));
 }
 
 // Thread safely returns a copy of segments
@@ -350,17 +352,17 @@ void Pattern::transform(double midy)
 void Pattern::clearTransform()
 {
     rawpoints.clear();
+    rawpoints.reserve(points.size()); // transform() runs on the audio thread with reverb automation
 }
 
 double Pattern::getavgY()
 {
     double avg = 0.0;
-    auto pts = points;
-    if (!pts.size()) return 1.0 - clearY;
-    for (auto& p : pts) {
+    if (!points.size()) return 1.0 - clearY;
+    for (auto& p : points) {
         avg += 1.0 - p.y;
     }
-    avg /= pts.size();
+    avg /= points.size();
     return avg;
 }
 
@@ -534,6 +536,21 @@ double Pattern::get_y_half_sine(Segment seg, double x)
 double Pattern::get_y_at(double x, bool updateClearTails)
 {
     std::lock_guard<std::mutex> lock(mtx); // prevents crash while building segments
+    return get_y_unlocked(x, updateClearTails);
+}
+
+// audio thread variant, never waits for buildSegments and leaves y untouched while it runs
+bool Pattern::try_get_y_at(double x, double& y, bool updateClearTails)
+{
+    std::unique_lock<std::mutex> lock(mtx, std::try_to_lock);
+    if (!lock.owns_lock())
+        return false;
+    y = get_y_unlocked(x, updateClearTails);
+    return true;
+}
+
+double Pattern::get_y_unlocked(double x, bool updateClearTails)
+{
     int low = 0;
     int high = static_cast<int>(segments.size()) - 1;
 
@@ -60,6 +60,7 @@ public:
     std::atomic<double> tensionAtk = 0.0; // tension multiplier for attack only
     std::atomic<double> tensionRel = 0.0; // tension multiplier for release only
     bool shouldClearTails = false; // keeps track of clearTails
+    std::atomic<bool> hasClearTails = false; // any segment clears tails, control rate envelopes fall back to per sample
     double lastx = 0.0; // used to detect clear reverb tails
 
     Pattern(int index);
@@ -102,6 +103,7 @@ public:
     double get_y_smooth_stairs(Segment seg, double x);
     double get_y_half_sine(Segment seg, double x);
     double get_y_at(double x, bool updateClearTails = false);
+    bool try_get_y_at(double x, double& y, bool updateClearTails = false);
 
     void createUndo();
     void undo();
@@ -112,9 +114,11 @@ public:
 private:
     double clearY = 0.5; // the y value when the pattern is clear
     std::vector<PPoint> rawpoints; 
+    std::vector<PPoint> buildPoints; // buildSegments scratch, points plus the ghost points
     static inline uint64_t versionIDCounter = 1; // static global ID counter
     static inline uint64_t pointsIDCounter = 1; // static global ID counter
     bool dualTension = false;
+    double get_y_unlocked(double x, bool updateClearTails);
     std::mutex mtx;
     std::mutex pointsmtx;
 };
\ No newline at end of file
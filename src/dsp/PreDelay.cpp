@@ -0,0 +1,123 @@
+#include "PreDelay.h"
+
+void PreDelay::prepare(int numChannels, int _maxDelay, int _maxBlock, double srate)
+{
+	maxDelay = std::max(0, _maxDelay);
+	maxBlock = std::max(1, _maxBlock);
+	size = maxDelay + maxBlock + 2; // a chunk never overwrites samples still to be read, plus the interpolation neighbour
+	line.setSize(numChannels, size);
+	glideSamples = std::max(1, (int)(PREDELAY_GLIDE_MS / 1000.0 * srate));
+
+	delays.resize(maxBlock);
+	index.resize(maxBlock);
+	frac.resize(maxBlock);
+	x0.resize(maxBlock);
+	x1.resize(maxBlock);
+
+	clear();
+}
+
+void PreDelay::clear()
+{
+	line.clear();
+	writePos = 0;
+	glideRemaining = 0;
+	snap = true;
+}
+
+void PreDelay::setDelay(float samples)
+{
+	float delay = juce::jlimit(0.f, (float)maxDelay, samples);
+	if (snap) {
+		current = target = delay;
+		glideRemaining = 0;
+		snap = false;
+		return;
+	}
+
+	if (delay == target)
+		return;
+
+	target = delay;
+	step = (target - current) / glideSamples;
+	glideRemaining = glideSamples;
+}
+
+void PreDelay::process(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int numSamples, const float* mod)
+{
+	for (int start = 0; start < numSamples; start += maxBlock) {
+		int count = std::min(maxBlock, numSamples - start);
+		write(input, start, count);
+
+		if (mod == nullptr && glideRemaining == 0 && current == std::floor(current))
+			readFixed(output, start, count, (int)current);
+		else
+			readInterpolated(output, start, count, mod != nullptr ? mod + start : nullptr);
+
+		writePos = (writePos + count) % size;
+	}
+}
+
+void PreDelay::write(const juce::AudioBuffer<float>& input, int start, int numSamples)
+{
+	int first = std::min(numSamples, size - writePos);
+	for (int ch = 0; ch < line.getNumChannels(); ++ch) {
+		auto* dest = line.getWritePointer(ch);
+		auto* src = input.getReadPointer(ch, start);
+		juce::FloatVectorOperations::copy(dest + writePos, src, first);
+		juce::FloatVectorOperations::copy(dest, src + first, numSamples - first);
+	}
+}
+
+void PreDelay::readFixed(juce::AudioBuffer<float>& output, int start, int numSamples, int delay)
+{
+	int readPos = (writePos + size - delay) % size;
+	int first = std::min(numSamples, size - readPos);
+	for (int ch = 0; ch < line.getNumChannels(); ++ch) {
+		auto* src = line.getReadPointer(ch);
+		auto* dest = output.getWritePointer(ch, start);
+		juce::FloatVectorOperations::copy(dest, src + readPos, first);
+		juce::FloatVectorOperations::copy(dest + first, src, numSamples - first);
+	}
+}
+
+void PreDelay::readInterpolated(juce::AudioBuffer<float>& output, int start, int numSamples, const float* mod)
+{
+	// delay per sample, gliding toward the target and scaled by the modulation
+	for (int i = 0; i < numSamples; ++i) {
+		if (glideRemaining > 0) {
+			current += step;
+			if (--glideRemaining == 0)
+				current = target;
+		}
+		delays[i] = current;
+	}
+	if (mod != nullptr) {
+		juce::FloatVectorOperations::multiply(delays.data(), mod, numSamples);
+		juce::FloatVectorOperations::clip(delays.data(), delays.data(), 0.f, (float)maxDelay, numSamples);
+	}
+
+	// read positions are shared by all channels, the write position of sample i is wrapped at most once
+	for (int i = 0; i < numSamples; ++i) {
+		int base = writePos + i;
+		if (base >= size) base -= size;
+		double pos = (double)(base + size) - delays[i];
+		int i0 = (int)pos;
+		frac[i] = (float)(pos - i0);
+		index[i] = i0 >= size ? i0 - size : i0;
+	}
+
+	// gather both neighbours, then blend x0 + frac * (x1 - x0) with vector ops
+	for (int ch = 0; ch < line.getNumChannels(); ++ch) {
+		auto* src = line.getReadPointer(ch);
+		auto* dest = output.getWritePointer(ch, start);
+		for (int i = 0; i < numSamples; ++i) {
+			int i0 = index[i];
+			x0[i] = src[i0];
+			x1[i] = src[i0 + 1 == size ? 0 : i0 + 1];
+		}
+		juce::FloatVectorOperations::subtract(x1.data(), x0.data(), numSamples);
+		juce::FloatVectorOperations::multiply(x1.data(), frac.data(), numSamples);
+		juce::FloatVectorOperations::add(dest, x0.data(), x1.data(), numSamples);
+	}
+}
@@ -0,0 +1,55 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "../Globals.h"
+
+using namespace globals;
+
+// Multichannel predelay line allocated in prepareToPlay for the longest predelay
+// a steady integer delay is read with at most two contiguous copies per channel,
+// delay changes glide and modulated delays are read with a linear fractional delay
+class PreDelay
+{
+public:
+    void prepare(int numChannels, int maxDelay, int maxBlock, double srate); // message thread
+    void clear();
+
+    // target delay in samples clamped to the prepared range
+    // glides over PREDELAY_GLIDE_MS except for the first call after clear()
+    void setDelay(float samples);
+
+    int getNumChannels() const { return line.getNumChannels(); }
+    int getMaxDelay() const { return maxDelay; }
+
+    // writes input into the line and the delayed signal into output
+    // mod scales the delay per sample, nullptr for an unmodulated delay
+    void process(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int numSamples, const float* mod = nullptr);
+
+private:
+    void write(const juce::AudioBuffer<float>& input, int start, int numSamples);
+    void readFixed(juce::AudioBuffer<float>& output, int start, int numSamples, int delay);
+    void readInterpolated(juce::AudioBuffer<float>& output, int start, int numSamples, const float* mod);
+
+    juce::AudioBuffer<float> line;
+    int size = 1;
+    int writePos = 0;
+    int maxDelay = 0;
+    int maxBlock = 1;
+    int glideSamples = 1;
+
+    float current = 0.f;
+    float target = 0.f;
+    float step = 0.f;
+    int glideRemaining = 0;
+    bool snap = true; // the first delay after a clear applies immediately
+
+    // interpolated read scratch, one chunk each
+    std::vector<float> delays;
+    std::vector<int> index;
+    std::vector<float> frac;
+    std::vector<float> x0;
+    std::vector<float> x1;
+};
@@ -0,0 +1,26 @@
+#include "ScratchArena.h"
+
+void ScratchArena::prepare(size_t bytes)
+{
+	memory.assign(bytes + ALIGNMENT, 0);
+	auto addr = reinterpret_cast<uintptr_t>(memory.data());
+	base = memory.data() + ((ALIGNMENT - addr % ALIGNMENT) % ALIGNMENT);
+	used = 0;
+}
+
+juce::AudioBuffer<float> ScratchArena::getBuffer(int numChannels, int numSamples, bool clear)
+{
+	auto start = used;
+	auto channels = allocate<float*>((size_t)numChannels);
+	auto data = allocate<float>((size_t)(numChannels * numSamples));
+	if (channels == nullptr || data == nullptr) {
+		used = start;
+		return {};
+	}
+
+	for (int ch = 0; ch < numChannels; ++ch)
+		channels[ch] = data + (size_t)ch * numSamples;
+	if (clear)
+		juce::FloatVectorOperations::clear(data, numChannels * numSamples);
+	return juce::AudioBuffer<float>(channels, numChannels, numSamples);
+}
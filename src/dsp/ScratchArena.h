@@ -0,0 +1,43 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Per instance bump allocator for audio thread scratch buffers
+// sized in prepareToPlay from worst case limits and reset at the start of every block, never grows on the audio thread
+class ScratchArena
+{
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    void prepare(size_t bytes); // message thread
+    void reset() { used = 0; }
+
+    // returns nullptr if the arena is exhausted
+    template <typename T>
+    T* allocate(size_t count)
+    {
+        auto offset = (used + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        if (offset + count * sizeof(T) > getCapacity()) {
+            jassertfalse; // prepare() was sized too small
+            return nullptr;
+        }
+        used = offset + count * sizeof(T);
+        return reinterpret_cast<T*>(base + offset);
+    }
+
+    // buffer referring to arena memory, never allocates
+    // returns an empty buffer without channels if the arena is exhausted
+    // pass clear as false when every sample is written before it is read
+    juce::AudioBuffer<float> getBuffer(int numChannels, int numSamples, bool clear = true);
+
+    size_t getCapacity() const { return memory.size() > ALIGNMENT ? memory.size() - ALIGNMENT : 0; }
+    size_t getUsed() const { return used; }
+
+private:
+    std::vector<char> memory;
+    char* base = nullptr; // first aligned byte of memory
+    size_t used = 0;
+};
@@ -0,0 +1,161 @@
+#include "SpectraFile.h"
+
+SpectraFile::SpectraFile()
+	: juce::Thread("SpectraFilePrefetch")
+{
+}
+
+SpectraFile::~SpectraFile()
+{
+	signalThreadShouldExit();
+	notify();
+	stopThread(1000);
+	close();
+}
+
+juce::int64 SpectraFile::segmentOffset(size_t segment) const
+{
+	return (juce::int64)((segment - firstSegment) * 2 * stride * sizeof(float));
+}
+
+size_t SpectraFile::getMappedBytes() const
+{
+	return NUM_SLOTS * 2 * stride * sizeof(float);
+}
+
+void SpectraFile::close()
+{
+	for (auto& slot : slots) {
+		slot.map.reset();
+		slot.ready.store(false);
+	}
+	readSlot = 0;
+	droppedSegments.store(0);
+	output.reset();
+	if (file != juce::File())
+		file.deleteFile();
+	file = juce::File();
+}
+
+bool SpectraFile::beginStore(size_t _complexSize, size_t _firstSegment, size_t _segmentCount)
+{
+	signalThreadShouldExit();
+	notify();
+	stopThread(1000);
+	close();
+
+	complexSize = _complexSize;
+	stride = (complexSize + 15) / 16 * 16;
+	firstSegment = _firstSegment;
+	segmentCount = _segmentCount;
+	padding.assign(stride - complexSize, 0.0f);
+
+	file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+		.getNonexistentChildFile("reevr_spectra", ".tmp", false);
+	output = std::make_unique<juce::FileOutputStream>(file);
+	if (output->failedToOpen()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void SpectraFile::store(size_t segment, const float* re, const float* im)
+{
+	jassert(output != nullptr && segment >= firstSegment && segment < firstSegment + segmentCount);
+	if (output == nullptr) return;
+	const auto padBytes = padding.size() * sizeof(float);
+	output->write(re, complexSize * sizeof(float));
+	if (padBytes > 0) output->write(padding.data(), padBytes);
+	output->write(im, complexSize * sizeof(float));
+	if (padBytes > 0) output->write(padding.data(), padBytes);
+}
+
+bool SpectraFile::endStore()
+{
+	if (output == nullptr) return false;
+	output->flush();
+	const bool ok = output->getStatus().wasOk();
+	output.reset();
+	if (!ok) {
+		close();
+		return false;
+	}
+	startThread(juce::Thread::Priority::high);
+	return true;
+}
+
+void SpectraFile::run()
+{
+	const auto segmentBytes = (juce::int64)(2 * stride * sizeof(float));
+	size_t next = firstSegment;
+	int slotIndex = 0;
+
+	while (!threadShouldExit()) {
+		auto& slot = slots[slotIndex];
+		if (slot.ready.load(std::memory_order_acquire)) {
+			wait(-1); // woken up by release()
+			continue;
+		}
+
+		const auto start = segmentOffset(next);
+		slot.map.reset();
+		slot.map = std::make_unique<juce::MemoryMappedFile>(file, juce::Range<juce::int64>(start, start + segmentBytes), juce::MemoryMappedFile::readOnly);
+		auto data = (const char*)slot.map->getData();
+		if (data == nullptr) {
+			slot.map.reset();
+			wait(100);
+			continue;
+		}
+
+		// touch every page so the segment is resident before the convolver reads it
+		volatile char touched = 0;
+		for (size_t i = 0; i < slot.map->getSize(); i += 4096)
+			touched = touched + data[i];
+
+		slot.segment = next;
+		slot.ready.store(true, std::memory_order_release);
+		slotReady.signal();
+
+		next = next + 1 < firstSegment + segmentCount ? next + 1 : firstSegment;
+		slotIndex = (slotIndex + 1) % NUM_SLOTS;
+	}
+}
+
+bool SpectraFile::fetch(size_t segment, const float*& re, const float*& im)
+{
+	const auto deadline = juce::Time::getMillisecondCounter() + FETCH_TIMEOUT_MS;
+	for (;;) {
+		auto& slot = slots[readSlot];
+		if (slot.ready.load(std::memory_order_acquire)) {
+			if (slot.segment == segment) {
+				auto data = (const char*)slot.map->getData();
+				re = (const float*)(data + (segmentOffset(segment) - slot.map->getRange().getStart()));
+				im = re + stride;
+				return true;
+			}
+			// left over from a dropped fetch, skipping it realigns the slot order
+			advance();
+			continue;
+		}
+
+		if (!isThreadRunning() || juce::Time::getMillisecondCounter() >= deadline) {
+			droppedSegments.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		slotReady.wait(1);
+	}
+}
+
+void SpectraFile::release(size_t segment)
+{
+	juce::ignoreUnused(segment);
+	advance();
+}
+
+void SpectraFile::advance()
+{
+	slots[readSlot].ready.store(false, std::memory_order_release);
+	readSlot = (readSlot + 1) % NUM_SLOTS;
+	notify();
+}
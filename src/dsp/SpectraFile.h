@@ -0,0 +1,62 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include "FFTConvolver.h"
+#include <JuceHeader.h>
+#include <array>
+
+/*
+	Out-of-core storage for far tail IR spectra.
+	Segments are written to a temporary file, a prefetch thread memory maps
+	them one by one ahead of the convolver and touches their pages so the
+	MAC never waits on disk. Only NUM_SLOTS segments are mapped at any time.
+	Paged segments belong to the background tail stage, fetch waits for the
+	prefetcher so the output stays exact. A segment still missing after
+	FETCH_TIMEOUT_MS is skipped and counted in getDroppedSegments.
+*/
+class SpectraFile : public fftconvolver::SpectraPager, private juce::Thread
+{
+public:
+	static constexpr int NUM_SLOTS = 4; // segments paged in ahead of the convolver
+	static constexpr juce::uint32 FETCH_TIMEOUT_MS = 1000; // longest wait for the prefetcher before a segment is dropped
+
+	SpectraFile();
+	~SpectraFile() override;
+
+	bool beginStore(size_t complexSize, size_t firstSegment, size_t segmentCount) override;
+	void store(size_t segment, const float* re, const float* im) override;
+	bool endStore() override;
+	bool fetch(size_t segment, const float*& re, const float*& im) override;
+	void release(size_t segment) override;
+
+	size_t getMappedBytes() const; // upper bound of spectra bytes mapped by the prefetcher
+	size_t getDroppedSegments() const { return droppedSegments.load(std::memory_order_relaxed); } // since the last store
+
+private:
+	struct Slot
+	{
+		std::unique_ptr<juce::MemoryMappedFile> map;
+		size_t segment = 0;
+		std::atomic<bool> ready { false };
+	};
+
+	void run() override;
+	void close();
+	void advance(); // hands the current slot back to the prefetcher
+	juce::int64 segmentOffset(size_t segment) const;
+
+	juce::File file;
+	std::unique_ptr<juce::FileOutputStream> output;
+	std::vector<float> padding;
+	size_t complexSize = 0;
+	size_t stride = 0; // floats per re/im part, padded to keep segments 64 byte aligned
+	size_t firstSegment = 0;
+	size_t segmentCount = 0;
+	std::array<Slot, NUM_SLOTS> slots;
+	int readSlot = 0;
+	juce::WaitableEvent slotReady;
+	std::atomic<size_t> droppedSegments { 0 };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectraFile)
+};
@@ -0,0 +1,127 @@
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer(int _fftOrder, int _overlap, float _smoothing)
+	: juce::Thread("SpectrumAnalyzer")
+	, ring((size_t)RING_SIZE, 0.f)
+{
+	configure(_fftOrder, _overlap, _smoothing);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+	stopThread(1000);
+}
+
+void SpectrumAnalyzer::configure(int _fftOrder, int overlap, float _smoothing)
+{
+	const bool running = isThreadRunning();
+	if (running)
+		stopThread(1000);
+
+	fftOrder = juce::jlimit(8, 15, _fftOrder);
+	fftSize = 1 << fftOrder;
+	hop = std::max(1, fftSize / juce::jlimit(1, 16, overlap));
+	smoothing = juce::jlimit(0.f, 0.99f, _smoothing);
+
+	fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+	window = std::make_unique<juce::dsp::WindowingFunction<float>>((size_t)fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
+	input.assign((size_t)fftSize, 0.f);
+	fftData.assign((size_t)fftSize * 2, 0.f);
+	magnitudes.assign((size_t)fftSize / 2, 0.f);
+	for (auto& frame : frames)
+		frame.assign((size_t)fftSize / 2, 0.f);
+
+	inputPos = 0;
+	hopCount = 0;
+	back = 0;
+	middle.store(1);
+	front = 2;
+
+	if (running)
+		startThread(juce::Thread::Priority::low);
+}
+
+void SpectrumAnalyzer::addViewer()
+{
+	if (viewers.fetch_add(1) == 0)
+		startThread(juce::Thread::Priority::low);
+}
+
+void SpectrumAnalyzer::removeViewer()
+{
+	if (viewers.fetch_sub(1) == 1)
+		stopThread(1000);
+}
+
+void SpectrumAnalyzer::push(const float* left, const float* right, int numSamples)
+{
+	if (!isActive())
+		return;
+
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+	for (int i = 0; i < size1; ++i)
+		ring[start1 + i] = 0.5f * (left[i] + right[i]);
+	for (int i = 0; i < size2; ++i)
+		ring[start2 + i] = 0.5f * (left[size1 + i] + right[size1 + i]);
+	fifo.finishedWrite(size1 + size2);
+}
+
+void SpectrumAnalyzer::run()
+{
+	while (!threadShouldExit()) {
+		int start1, size1, start2, size2;
+		fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+		auto read = [&](int start, int size) {
+			for (int i = 0; i < size; ++i) {
+				input[inputPos] = ring[start + i];
+				inputPos = (inputPos + 1) & (fftSize - 1);
+				if (++hopCount >= hop) {
+					hopCount = 0;
+					analyze();
+				}
+			}
+		};
+
+		read(start1, size1);
+		read(start2, size2);
+		fifo.finishedRead(size1 + size2);
+
+		wait(10);
+	}
+}
+
+void SpectrumAnalyzer::analyze()
+{
+	// unroll the circular input, oldest sample first
+	const int firstPart = fftSize - inputPos;
+	std::copy_n(input.data() + inputPos, firstPart, fftData.data());
+	std::copy_n(input.data(), inputPos, fftData.data() + firstPart);
+	std::fill(fftData.begin() + fftSize, fftData.end(), 0.f);
+
+	window->multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+	fft->performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+	const float norm = 1.f / fftSize;
+	for (size_t j = 0; j < magnitudes.size(); ++j)
+		magnitudes[j] = fftData[j] * norm * (1.f - smoothing) + magnitudes[j] * smoothing;
+
+	publish();
+}
+
+void SpectrumAnalyzer::publish()
+{
+	std::copy(magnitudes.begin(), magnitudes.end(), frames[back].begin());
+	back = middle.exchange(back | NEW_FRAME, std::memory_order_acq_rel) & ~NEW_FRAME;
+}
+
+bool SpectrumAnalyzer::getMagnitudes(std::vector<float>& dest)
+{
+	if ((middle.load(std::memory_order_acquire) & NEW_FRAME) == 0)
+		return false;
+
+	front = middle.exchange(front, std::memory_order_acq_rel) & ~NEW_FRAME;
+	dest.assign(frames[front].begin(), frames[front].end());
+	return true;
+}
@@ -0,0 +1,70 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*
+	Background spectrum analyzer for the EQ displays.
+	The audio thread pushes a mono mix into a single producer single consumer ring,
+	a low priority worker runs the windowed FFTs every hop and smooths the magnitudes,
+	finished frames are handed to the UI through a triple buffer so reads never tear.
+	Nothing runs while no display is attached.
+*/
+class SpectrumAnalyzer : private juce::Thread
+{
+public:
+	SpectrumAnalyzer(int fftOrder, int overlap = 2, float smoothing = 0.2f);
+	~SpectrumAnalyzer() override;
+
+	// message thread, restarts the worker
+	// overlap is the number of FFTs per window length, smoothing the weight of the previous frame
+	void configure(int fftOrder, int overlap, float smoothing);
+	int getNumBins() const { return fftSize / 2; }
+
+	void addViewer(); // displays attach on construction and detach on destruction
+	void removeViewer();
+	bool isActive() const { return viewers.load(std::memory_order_relaxed) > 0; }
+
+	// audio thread, samples are dropped while the ring is full
+	void push(const float* left, const float* right, int numSamples);
+
+	// UI thread, copies the latest finished frame into dest
+	// returns false if no frame was published since the last call
+	bool getMagnitudes(std::vector<float>& dest);
+
+private:
+	static constexpr int RING_SIZE = 1 << 16;
+	static constexpr int NEW_FRAME = 4; // set on the shared triple buffer index when it holds an unread frame
+
+	void run() override;
+	void analyze();
+	void publish();
+
+	juce::AbstractFifo fifo{ RING_SIZE };
+	std::vector<float> ring;
+	std::atomic<int> viewers = 0;
+
+	// worker state
+	int fftOrder = 0;
+	int fftSize = 0;
+	int hop = 0;
+	float smoothing = 0.f;
+	std::unique_ptr<juce::dsp::FFT> fft;
+	std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+	std::vector<float> input; // last fftSize samples, circular
+	std::vector<float> fftData;
+	std::vector<float> magnitudes;
+	int inputPos = 0;
+	int hopCount = 0;
+
+	// triple buffer, the worker owns back, the UI owns front
+	std::array<std::vector<float>, 3> frames;
+	std::atomic<int> middle = 1;
+	int back = 0;
+	int front = 2;
+};
@@ -1,4 +1,5 @@
 #include "StereoConvolver.h"
+#include "ConvolverTuner.h"
 
 bool StereoConvolver::finishedLoading()
 {
@@ -8,26 +9,414 @@ bool StereoConvolver::finishedLoading()
 void StereoConvolver::prepare(int samplesPerBlock)
 {
 	size = samplesPerBlock;
-	headBlockSize = 1;
-	while (headBlockSize < static_cast<size_t>(samplesPerBlock)) {
-		headBlockSize *= 2;
-	}
-	tailBlockSize = std::max(size_t(8192), 2 * headBlockSize);
+	auto partitions = ConvolverTuner::getDefault(samplesPerBlock);
+	headBlockSize = partitions.head;
+	tailBlockSize = partitions.tail;
 	bufferLL.resize(samplesPerBlock, 0.0f);
 	bufferRR.resize(samplesPerBlock, 0.0f);
 	bufferLR.resize(samplesPerBlock, 0.0f);
 	bufferRL.resize(samplesPerBlock, 0.0f);
+	if (multirateTail)
+		multirateTail->prepare(samplesPerBlock);
+	matrix = nullptr;
+}
+
+void StereoConvolver::setPartitions(size_t head, size_t tail)
+{
+	jassert(isPowerOfTwo(head) && isPowerOfTwo(tail) && head <= tail);
+	headBlockSize = head;
+	tailBlockSize = tail;
+}
+
+size_t StereoConvolver::getIRMemoryUsage() const
+{
+	return convolverLL->getIRMemoryUsage()
+		+ convolverRR->getIRMemoryUsage()
+		+ convolverLR->getIRMemoryUsage()
+		+ convolverRL->getIRMemoryUsage()
+		+ (multirateTail ? multirateTail->getIRMemoryUsage() : 0)
+		+ (matrix ? matrix->getIRMemoryUsage() : 0);
+}
+
+size_t StereoConvolver::getDroppedSegments() const
+{
+	return convolverLL->getDroppedSegments()
+		+ convolverRR->getDroppedSegments()
+		+ convolverLR->getDroppedSegments()
+		+ convolverRL->getDroppedSegments();
 }
 
 void StereoConvolver::loadImpulse(Impulse& imp)
 {
-	convolverLL->init(headBlockSize, tailBlockSize, imp.bufferLL.data(), imp.bufferLL.size());
-	convolverRR->init(headBlockSize, tailBlockSize, imp.bufferRR.data(), imp.bufferRR.size());
+	convolverLL->setHalfPrecision(halfPrecision);
+	convolverRR->setHalfPrecision(halfPrecision);
+	convolverLR->setHalfPrecision(halfPrecision);
+	convolverRL->setHalfPrecision(halfPrecision);
+	// split the resident budget between the routes in use, it only covers each route's background tail stage
+	const size_t routeBudget = outOfCoreBudget / (imp.isQuad ? 4 : 2);
+	convolverLL->setOutOfCoreBudget(routeBudget);
+	convolverRR->setOutOfCoreBudget(routeBudget);
+	convolverLR->setOutOfCoreBudget(routeBudget);
+	convolverRL->setOutOfCoreBudget(routeBudget);
+	convolverLL->setInputHistory(inputHistory);
+	convolverRR->setInputHistory(inputHistory);
+	convolverLR->setInputHistory(inputHistory);
+	convolverRL->setInputHistory(inputHistory);
+	convolverRR->reset(); // may hold spectra shared from the previous LL impulse
+
+	morphCount = 1;
+	if (matrixChannels > 2 && !imp.channels.empty()) {
+		loadMatrix(imp);
+		return;
+	}
+	matrix = nullptr;
+
+	if (!morphImpulses.empty()) {
+		loadMorph(imp);
+		return;
+	}
+
+	const std::vector<float>* irLL = &imp.bufferLL;
+	const std::vector<float>* irRR = &imp.bufferRR;
+	const std::vector<float>* irLR = &imp.bufferLR;
+	const std::vector<float>* irRL = &imp.bufferRL;
+
+	// hybrid tail, the FDN replaces the IR past the junction
+	std::vector<float> exactLL, exactRR, exactLR, exactRL;
+	if (hybridTailMs > 0 && loadHybridTail(imp, exactLL, exactRR, exactLR, exactRL)) {
+		irLL = &exactLL;
+		irRR = &exactRR;
+		irLR = &exactLR;
+		irRL = &exactRL;
+	}
+	else {
+		fdn = nullptr;
+	}
+	// the FDN feeds each output from different lines, so LL and RR sections differ
+	const bool dualMono = imp.isDualMono && !fdn;
+
+	// multirate tail, the convolvers below only get the early section of each route
+	std::vector<float> earlyLL, earlyRR, earlyLR, earlyRL;
+	const int splitPos = (int)(imp.srate * MULTIRATE_SPLIT_MS / 1000.0);
+	const int fadeLen = (int)(imp.srate * MULTIRATE_XFADE_MS / 1000.0);
+	if (multirate > 1 && irLL->size() > (size_t)(splitPos + fadeLen) + tailBlockSize) {
+		if (!multirateTail || multirateTail->getFactor() != multirate)
+			multirateTail = std::make_unique<MultirateTail>(multirate);
+		multirateTail->setSynchronous(synchronous);
+		multirateTail->prepare(size);
+		multirateTail->reset();
+		multirateTail->loadRoute(MultirateTail::LL, *irLL, splitPos, fadeLen, earlyLL, halfPrecision);
+		if (dualMono) {
+			multirateTail->shareRoute(MultirateTail::RR, MultirateTail::LL);
+			earlyRR = earlyLL;
+		}
+		else {
+			multirateTail->loadRoute(MultirateTail::RR, *irRR, splitPos, fadeLen, earlyRR, halfPrecision);
+		}
+		irLL = &earlyLL;
+		irRR = &earlyRR;
+		if (imp.isQuad) {
+			multirateTail->loadRoute(MultirateTail::LR, *irLR, splitPos, fadeLen, earlyLR, halfPrecision);
+			multirateTail->loadRoute(MultirateTail::RL, *irRL, splitPos, fadeLen, earlyRL, halfPrecision);
+			irLR = &earlyLR;
+			irRL = &earlyRL;
+		}
+	}
+	else {
+		multirateTail = nullptr;
+	}
+
+	// sparse early reflections go to the tap delays, the convolvers skip the zeroed partitions
+	std::vector<float> denseLL, denseRR, denseLR, denseRL;
+	auto splitTaps = [&](TapDelay& delay, const std::vector<TapDelay::Tap>& taps, const std::vector<float>*& ir, std::vector<float>& dense) {
+		delay.prepare(imp.sparseLength, size);
+		delay.setTaps(taps);
+		if (taps.empty()) return;
+		dense = *ir;
+		std::fill(dense.begin(), dense.begin() + std::min(dense.size(), (size_t)imp.sparseLength), 0.f);
+		ir = &dense;
+	};
+	splitTaps(tapsLL, imp.tapsLL, irLL, denseLL);
+	splitTaps(tapsRR, imp.tapsRR, irRR, denseRR);
+	splitTaps(tapsLR, imp.isQuad ? imp.tapsLR : std::vector<TapDelay::Tap>(), irLR, denseLR);
+	splitTaps(tapsRL, imp.isQuad ? imp.tapsRL : std::vector<TapDelay::Tap>(), irRL, denseRL);
+
+	convolverLL->init(headBlockSize, tailBlockSize, irLL->data(), irLL->size());
+	// identical channels share the LL spectra, RR only keeps its own input history
+	if (!dualMono || !convolverRR->initFrom(*convolverLL)) {
+		convolverRR->init(headBlockSize, tailBlockSize, irRR->data(), irRR->size());
+	}
+	isQuad = imp.isQuad;
+	if (isQuad) {
+		convolverLR->init(headBlockSize, tailBlockSize, irLR->data(), irLR->size());
+		convolverRL->init(headBlockSize, tailBlockSize, irRL->data(), irRL->size());
+	}
+	else {
+		// release cross channel spectra left from a previous true stereo IR
+		convolverLR->reset();
+		convolverRL->reset();
+	}
+}
+
+void StereoConvolver::loadMatrix(const Impulse& imp)
+{
+	convolverLL->reset();
+	convolverLR->reset();
+	convolverRL->reset();
+	multirateTail = nullptr;
+	fdn = nullptr;
+	tapsLL.setTaps({});
+	tapsRR.setTaps({});
+	tapsLR.setTaps({});
+	tapsRL.setTaps({});
+	isQuad = false;
+
+	if (!matrix || matrix->getNumChannels() != matrixChannels) {
+		matrix = std::make_unique<MatrixConvolver>();
+		matrix->setSynchronous(synchronous);
+		matrix->prepare(size, matrixChannels);
+	}
+	matrix->setPartitions(headBlockSize, tailBlockSize);
+
+	std::vector<const std::vector<float>*> routes;
+	for (int in = 0; in < matrixChannels; ++in)
+		for (int out = 0; out < matrixChannels; ++out)
+			routes.push_back(imp.getMatrixRoute(in, out));
+	matrix->load(routes, halfPrecision);
+}
+
+bool StereoConvolver::loadHybridTail(const Impulse& imp, std::vector<float>& ll, std::vector<float>& rr, std::vector<float>& lr, std::vector<float>& rl)
+{
+	const int junction = (int)(imp.srate * hybridTailMs / 1000.0);
+	const int fadeLen = (int)(imp.srate * HYBRID_XFADE_MS / 1000.0);
+	// not worth it unless the FDN replaces more than a tail partition
+	if (junction < imp.sparseLength || imp.bufferLL.size() <= (size_t)(junction + fadeLen) + tailBlockSize)
+		return false;
+
+	// decay of the routes in use past the junction, one set of RT60s drives the whole network
+	auto decayLL = imp.analyseBandDecay(imp.bufferLL, junction, fadeLen);
+	auto decayRR = imp.analyseBandDecay(imp.bufferRR, junction, fadeLen);
+	Impulse::BandDecay decayLR, decayRL;
+	if (imp.isQuad) {
+		decayLR = imp.analyseBandDecay(imp.bufferLR, junction, fadeLen);
+		decayRL = imp.analyseBandDecay(imp.bufferRL, junction, fadeLen);
+	}
+	std::array<float, 3> rt60;
+	for (int b = 0; b < 3; ++b) {
+		rt60[b] = imp.isQuad
+			? (decayLL.rt60[b] + decayRR.rt60[b] + decayLR.rt60[b] + decayRL.rt60[b]) / 4.f
+			: (decayLL.rt60[b] + decayRR.rt60[b]) / 2.f;
+	}
+
+	if (!fdn)
+		fdn = std::make_unique<FDN>();
+	fdn->prepare(imp.srate, junction, size);
+	fdn->setDecay(rt60);
+
+	// calibrate the output band levels against the IR energy right after the junction,
+	// each output hears both inputs through the network
+	const int renderLen = junction + fadeLen;
+	std::vector<float> fromL_L, fromL_R, fromR_L, fromR_R;
+	fdn->renderImpulse(0, fromL_L, fromL_R, renderLen);
+	fdn->renderImpulse(1, fromR_L, fromR_R, renderLen);
+	auto fdnL = imp.analyseBandDecay(fromL_L, junction, fadeLen).energy;
+	auto fdnR = imp.analyseBandDecay(fromL_R, junction, fadeLen).energy;
+	auto crossL = imp.analyseBandDecay(fromR_L, junction, fadeLen).energy;
+	auto crossR = imp.analyseBandDecay(fromR_R, junction, fadeLen).energy;
+	std::array<float, 3> gainsL, gainsR;
+	for (int b = 0; b < 3; ++b) {
+		const double targetL = decayLL.energy[b] + (imp.isQuad ? decayRL.energy[b] : 0.0);
+		const double targetR = decayRR.energy[b] + (imp.isQuad ? decayLR.energy[b] : 0.0);
+		const double outL = fdnL[b] + crossL[b];
+		const double outR = fdnR[b] + crossR[b];
+		gainsL[b] = outL > 0.0 ? (float)std::sqrt(targetL / outL) : 0.f;
+		gainsR[b] = outR > 0.0 ? (float)std::sqrt(targetR / outR) : 0.f;
+	}
+	fdn->setOutputGains(0, gainsL);
+	fdn->setOutputGains(1, gainsR);
+	fdn->renderImpulse(0, fromL_L, fromL_R, renderLen);
+	fdn->renderImpulse(1, fromR_L, fromR_R, renderLen);
+
+	// the FDN is linear, convolving (1 - w)(h - f) with w the FDN fade in gives exactly
+	// the IR up to the junction and (1 - w)h + wf across the crossfade
+	auto exactSection = [&](const std::vector<float>& h, const std::vector<float>& f, std::vector<float>& out) {
+		out.assign(renderLen, 0.f);
+		for (int i = 0; i < renderLen && i < (int)h.size(); ++i) {
+			const float w = i < junction ? 0.f : 0.5f - 0.5f * std::cos(MathConstants<float>::pi * (i - junction + 0.5f) / (float)fadeLen);
+			out[i] = (1.f - w) * (h[i] - f[i]);
+		}
+	};
+	exactSection(imp.bufferLL, fromL_L, ll);
+	exactSection(imp.bufferRR, fromR_R, rr);
+	if (imp.isQuad) {
+		exactSection(imp.bufferLR, fromL_R, lr);
+		exactSection(imp.bufferRL, fromR_L, rl);
+	}
+	return true;
+}
+
+void StereoConvolver::loadMorph(const Impulse& imp)
+{
+	// the tail helpers are tuned to a single IR
+	fdn = nullptr;
+	multirateTail = nullptr;
+	tapsLL.setTaps({});
+	tapsRR.setTaps({});
+	tapsLR.setTaps({});
+	tapsRL.setTaps({});
+
+	std::vector<const Impulse*> imps = { &imp };
+	for (auto* target : morphImpulses) {
+		if ((int)imps.size() < MORPH_MAX_IRS)
+			imps.push_back(target);
+	}
+	size_t len = 0;
+	for (auto* i : imps)
+		len = std::max({ len, i->bufferLL.size(), i->bufferRR.size() });
+
+	// every IR zero padded to the longest, cross routes of stereo IRs stay silent
 	isQuad = imp.isQuad;
+	auto initRoute = [&](Convolver& conv, std::vector<float> Impulse::* route, bool cross) {
+		std::vector<std::vector<float>> irs(imps.size(), std::vector<float>(len, 0.f));
+		std::vector<const float*> ptrs;
+		for (size_t k = 0; k < imps.size(); ++k) {
+			const auto& buf = imps[k]->*route;
+			if (!cross || imps[k]->isQuad)
+				std::copy(buf.begin(), buf.begin() + std::min(len, buf.size()), irs[k].begin());
+			ptrs.push_back(irs[k].data());
+		}
+		conv.initMorph(headBlockSize, tailBlockSize, ptrs.data(), ptrs.size(), len);
+	};
+	initRoute(*convolverLL, &Impulse::bufferLL, false);
+	initRoute(*convolverRR, &Impulse::bufferRR, false);
 	if (isQuad) {
-		convolverLR->init(headBlockSize, tailBlockSize, imp.bufferLR.data(), imp.bufferLR.size());
-		convolverRL->init(headBlockSize, tailBlockSize, imp.bufferRL.data(), imp.bufferRL.size());
+		initRoute(*convolverLR, &Impulse::bufferLR, true);
+		initRoute(*convolverRL, &Impulse::bufferRL, true);
 	}
+	else {
+		convolverLR->reset();
+		convolverRL->reset();
+	}
+	morphCount = (int)imps.size();
+	const float position = morphPosition;
+	morphPosition = -1.f;
+	setMorphPosition(position);
+}
+
+void StereoConvolver::setMorphPosition(float position)
+{
+	position = std::clamp(position, 0.f, 1.f);
+	if (morphCount < 2 || position == morphPosition)
+		return;
+	morphPosition = position;
+
+	// equal power blend of the two nearest IRs, their tails are mostly uncorrelated
+	std::array<float, MORPH_MAX_IRS> weights = {};
+	const float x = position * (morphCount - 1);
+	const int i = std::min((int)x, morphCount - 2);
+	const float frac = x - i;
+	weights[i] = std::cos(frac * MathConstants<float>::halfPi);
+	weights[i + 1] = std::sin(frac * MathConstants<float>::halfPi);
+	convolverLL->setMorphWeights(weights.data(), (size_t)morphCount);
+	convolverRR->setMorphWeights(weights.data(), (size_t)morphCount);
+	convolverLR->setMorphWeights(weights.data(), (size_t)morphCount);
+	convolverRL->setMorphWeights(weights.data(), (size_t)morphCount);
+}
+
+bool StereoConvolver::beginFade(StereoConvolver& other)
+{
+	auto hasTaps = [](const StereoConvolver& c) {
+		return c.tapsLL.isActive() || c.tapsRR.isActive() || c.tapsLR.isActive() || c.tapsRL.isActive();
+	};
+	if (size != other.size || isQuad != other.isQuad || fdn || other.fdn || multirateTail || other.multirateTail || matrix || other.matrix
+		|| morphCount > 1 || other.morphCount > 1 || hasTaps(*this) || hasTaps(other))
+		return false;
+
+	if (!convolverLL->canFadeTo(*other.convolverLL) || !convolverRR->canFadeTo(*other.convolverRR))
+		return false;
+	if (isQuad && (!convolverLR->canFadeTo(*other.convolverLR) || !convolverRL->canFadeTo(*other.convolverRL)))
+		return false;
+
+	convolverLL->beginFade(*other.convolverLL);
+	convolverRR->beginFade(*other.convolverRR);
+	if (isQuad) {
+		convolverLR->beginFade(*other.convolverLR);
+		convolverRL->beginFade(*other.convolverRL);
+	}
+	return true;
+}
+
+void StereoConvolver::setFadePosition(float position)
+{
+	convolverLL->setFadePosition(position);
+	convolverRR->setFadePosition(position);
+	convolverLR->setFadePosition(position);
+	convolverRL->setFadePosition(position);
+}
+
+void StereoConvolver::endFade()
+{
+	convolverLL->endFade();
+	convolverRR->endFade();
+	convolverLR->endFade();
+	convolverRL->endFade();
+}
+
+bool StereoConvolver::isFading() const
+{
+	return convolverLL->isFading() || convolverRR->isFading() || convolverLR->isFading() || convolverRL->isFading();
+}
+
+void StereoConvolver::releaseImpulse()
+{
+	convolverLL->reset();
+	convolverRR->reset();
+	convolverLR->reset();
+	convolverRL->reset();
+	multirateTail = nullptr;
+	fdn = nullptr;
+	matrix = nullptr;
+	morphCount = 1;
+	tapsLL.setTaps({});
+	tapsRR.setTaps({});
+	tapsLR.setTaps({});
+	tapsRL.setTaps({});
+}
+
+void StereoConvolver::setSynchronous(bool sync)
+{
+	synchronous = sync;
+	convolverLL->setSynchronous(sync);
+	convolverRR->setSynchronous(sync);
+	convolverLR->setSynchronous(sync);
+	convolverRL->setSynchronous(sync);
+	if (multirateTail)
+		multirateTail->setSynchronous(sync);
+	if (matrix)
+		matrix->setSynchronous(sync);
+}
+
+void StereoConvolver::setDecay(float gainPerSample)
+{
+	// the partitions are weighted while accumulating, sparse taps and the FDN tail keep their decay
+	convolverLL->setDecay(gainPerSample);
+	convolverRR->setDecay(gainPerSample);
+	convolverLR->setDecay(gainPerSample);
+	convolverRL->setDecay(gainPerSample);
+	if (multirateTail)
+		multirateTail->setDecay(gainPerSample);
+	if (matrix)
+		matrix->setDecay(gainPerSample);
+}
+
+void StereoConvolver::processMatrix(const float* const* data, size_t nsamples)
+{
+	matrix->process(data, nsamples);
+}
+
+double StereoConvolver::getMultirateErrorDb() const
+{
+	return multirateTail ? multirateTail->getErrorDb() : -200.0;
 }
 
 void StereoConvolver::process(const float* dataL, const float* dataR, size_t nsamples, bool force2Chans)
@@ -39,6 +428,22 @@ void StereoConvolver::process(const float* dataL, const float* dataR, size_t nsa
 		convolverLR->process(dataL, bufferLR.data(), nsamples);
 		convolverRL->process(dataR, bufferRL.data(), nsamples);
 	}
+
+	tapsLL.process(dataL, bufferLL.data(), (int)nsamples);
+	tapsRR.process(dataR, bufferRR.data(), (int)nsamples);
+	if (isQuad && !force2Chans) {
+		tapsLR.process(dataL, bufferLR.data(), (int)nsamples);
+		tapsRL.process(dataR, bufferRL.data(), (int)nsamples);
+	}
+
+	if (fdn)
+		fdn->process(dataL, dataR, bufferLL.data(), bufferRR.data(), (int)nsamples);
+
+	if (multirateTail) {
+		const bool cross = isQuad && !force2Chans;
+		multirateTail->process(dataL, dataR, (int)nsamples, bufferLL.data(), bufferRR.data(),
+			cross ? bufferLR.data() : nullptr, cross ? bufferRL.data() : nullptr);
+	}
 }
 
 void StereoConvolver::reset()
@@ -47,6 +452,14 @@ void StereoConvolver::reset()
 	convolverRR->reset();
 	convolverLR->reset();
 	convolverRL->reset();
+	multirateTail = nullptr;
+	fdn = nullptr;
+	matrix = nullptr;
+	morphCount = 1;
+	tapsLL.setTaps({});
+	tapsRR.setTaps({});
+	tapsLR.setTaps({});
+	tapsRL.setTaps({});
 	bufferLL.clear();
 	bufferRR.clear();
 	bufferLR.clear();
@@ -59,4 +472,14 @@ void StereoConvolver::clear()
 	convolverRR->clear();
 	convolverLR->clear();
 	convolverRL->clear();
+	tapsLL.clear();
+	tapsRR.clear();
+	tapsLR.clear();
+	tapsRL.clear();
+	if (multirateTail)
+		multirateTail->clear();
+	if (fdn)
+		fdn->clear();
+	if (matrix)
+		matrix->clear();
 }
\ No newline at end of file
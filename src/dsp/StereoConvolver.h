@@ -5,6 +5,9 @@
 #include <JuceHeader.h>
 #include "Convolver.h"
 #include "Impulse.h"
+#include "MultirateTail.h"
+#include "FDN.h"
+#include "MatrixConvolver.h"
 
 class StereoConvolver
 {
@@ -18,11 +21,31 @@ public:
     ~StereoConvolver() {}
     
     void loadImpulse(Impulse& imp);
-    void prepare(int samplesPerBlock);
+    void prepare(int samplesPerBlock); // sets the ConvolverTuner::getDefault partitions
+    // overrides the prepare() partitions, applied on next loadImpulse
+    // the processor calls it through tuneConvolver before every load, convolvers loaded without it keep the defaults
+    void setPartitions(size_t head, size_t tail);
     void process(const float* data0, const float* data1, size_t nsamples, bool force2Chans = false);
     void reset();
     void clear();
     bool finishedLoading();
+    size_t getIRMemoryUsage() const;
+    size_t getDroppedSegments() const; // far tail segments skipped because the disk was late
+    double getMultirateErrorDb() const; // energy discarded by the multirate tail relative to the IR
+    void setMorphPosition(float position); // 0 is the main IR, 1 the last morph IR, adjacent IRs are blended
+    int getMorphCount() const { return morphCount; }
+    // crossfades to the IR of other inside this engine, false if the layouts differ (no taps, FDN, multirate or morph)
+    bool beginFade(StereoConvolver& other);
+    void setFadePosition(float position);
+    void endFade(); // other holds the old IR once isFading() is false
+    bool isFading() const;
+    void releaseImpulse(); // frees the IR spectra keeping the block buffers, not on the audio thread
+    void setSynchronous(bool sync); // tails run inside process() for offline renders, no background threads
+    void setDecay(float gainPerSample); // imposes an exponential decay through per partition gains, 1 is off, no IR reload
+    bool isMatrix() const { return matrix != nullptr; }
+    // convolves every bus channel through the IR matrix, see Impulse::getMatrixRoute()
+    void processMatrix(const float* const* data, size_t nsamples);
+    const float* getMatrixOutput(int channel) const { return matrix->outputs[channel].data(); }
 
     std::vector<float> bufferLL = {};
     std::vector<float> bufferRR = {};
@@ -30,15 +53,40 @@ public:
     std::vector<float> bufferRL = {};
     int size = 0;
     bool isQuad = false;
+    bool halfPrecision = false; // store IR spectra as fp16, applied on next loadImpulse
+    int multirate = 1; // late tail decimation factor, 1 is off, applied on next loadImpulse
+    int hybridTailMs = 0; // IR convolved exactly up to this point, a tuned FDN renders the rest, 0 is off
+    size_t inputHistory = 0; // IR length the engines can later fade to (see beginFade), applied on next loadImpulse
+    size_t outOfCoreBudget = 0; // bytes of background tail stage spectra kept in memory, split between the routes, the rest is paged from disk, 0 is off
+                                // the head and first tail stages always stay in memory and are not counted
     std::vector<SVF::EQBand> decayEQ;
+    std::vector<const Impulse*> morphImpulses; // IRs blended with the main one, applied on next loadImpulse
+    int matrixChannels = 0; // surround and ambisonic bus channels, above 2 multichannel IRs load into the matrix
 
 protected:
     size_t headBlockSize = 0;
     size_t tailBlockSize = 0;
 
 private:
+    // analyses the IR and tunes the FDN, fills the routes exact sections, false if the IR is too short
+    bool loadHybridTail(const Impulse& imp, std::vector<float>& ll, std::vector<float>& rr, std::vector<float>& lr, std::vector<float>& rl);
+    // loads the main and morph IRs into every route, each convolver blends their spectra
+    void loadMorph(const Impulse& imp);
+    // loads every route of a multichannel IR, morph, taps, multirate and hybrid tails are not used
+    void loadMatrix(const Impulse& imp);
+
     std::unique_ptr<Convolver> convolverLL;
     std::unique_ptr<Convolver> convolverRR;
     std::unique_ptr<Convolver> convolverLR;
     std::unique_ptr<Convolver> convolverRL;
+    std::unique_ptr<MultirateTail> multirateTail;
+    std::unique_ptr<FDN> fdn; // hybrid late tail
+    std::unique_ptr<MatrixConvolver> matrix;
+    TapDelay tapsLL; // sparse early reflections, the convolvers get the dense remainder
+    TapDelay tapsRR;
+    TapDelay tapsLR;
+    TapDelay tapsRL;
+    int morphCount = 1;
+    float morphPosition = 0.f;
+    bool synchronous = false;
 };
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "TapDelay.h"
+
+void TapDelay::prepare(int maxDelay, int samplesPerBlock)
+{
+	const int size = nextPowerOfTwo(std::max(1, maxDelay + samplesPerBlock + 1));
+	if ((int)ring.size() != size)
+		ring.assign(size, 0.f);
+	mask = size - 1;
+	writePos = 0;
+}
+
+void TapDelay::setTaps(const std::vector<Tap>& _taps)
+{
+	taps = _taps;
+	clear();
+}
+
+void TapDelay::clear()
+{
+	std::fill(ring.begin(), ring.end(), 0.f);
+	writePos = 0;
+}
+
+void TapDelay::process(const float* input, float* output, int nsamples)
+{
+	if (taps.empty() || ring.empty()) return;
+	const int size = (int)ring.size();
+	jassert(nsamples <= size);
+
+	// write the block first, taps shorter than the block read from it
+	const int first = std::min(nsamples, size - writePos);
+	FloatVectorOperations::copy(ring.data() + writePos, input, first);
+	if (first < nsamples)
+		FloatVectorOperations::copy(ring.data(), input + first, nsamples - first);
+
+	for (auto& tap : taps) {
+		const int start = (writePos - tap.delay) & mask;
+		const int run = std::min(nsamples, size - start);
+		FloatVectorOperations::addWithMultiply(output, ring.data() + start, tap.gain, run);
+		if (run < nsamples)
+			FloatVectorOperations::addWithMultiply(output + run, ring.data(), tap.gain, nsamples - run);
+	}
+
+	writePos = (writePos + nsamples) & mask;
+}
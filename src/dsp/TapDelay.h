@@ -0,0 +1,36 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+/*
+	Multi-tap delay line for sparse IR sections.
+	Renders each tap as a vectorized multiply-add of a block of delayed input,
+	so the cost is one SIMD pass per tap instead of a convolution.
+*/
+class TapDelay
+{
+public:
+	struct Tap
+	{
+		int delay;
+		float gain;
+	};
+
+	TapDelay() {}
+	~TapDelay() {}
+
+	void prepare(int maxDelay, int samplesPerBlock);
+	void setTaps(const std::vector<Tap>& taps); // also clears the delay line
+	void process(const float* input, float* output, int nsamples); // adds the taps to output
+	void clear();
+	bool isActive() const { return !taps.empty(); }
+
+private:
+	std::vector<float> ring;
+	std::vector<Tap> taps;
+	int mask = 0;
+	int writePos = 0;
+};
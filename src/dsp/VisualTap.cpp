@@ -0,0 +1,94 @@
+#include "VisualTap.h"
+
+VisualTap::VisualTap(int capacity, int _frameSize)
+	: fifo(capacity)
+	, frames((size_t)capacity)
+	, frameSize(_frameSize)
+{
+}
+
+void VisualTap::process(float x, float a, float b, bool hit)
+{
+	if (count == 0) {
+		current.x = x;
+		current.min = { a, b };
+		current.max = { a, b };
+		current.hit = hit;
+	}
+	else {
+		current.min = { std::min(current.min[0], a), std::min(current.min[1], b) };
+		current.max = { std::max(current.max[0], a), std::max(current.max[1], b) };
+		current.hit = current.hit || hit;
+	}
+
+	if (++count >= frameSize) {
+		publish();
+		count = 0;
+	}
+}
+
+void VisualTap::publish()
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(1, start1, size1, start2, size2);
+	if (size1 > 0)
+		frames[start1] = current;
+	fifo.finishedWrite(size1); // frames are dropped while the ring is full
+}
+
+void VisualTap::clear()
+{
+	count = 0;
+	clearPending.store(true);
+}
+
+int VisualTap::readPeaks(int width, float* peaksA, float* peaksB, char* hits)
+{
+	if (width <= 0)
+		return lastPixel;
+
+	if (clearPending.exchange(false)) {
+		std::fill(peaksA, peaksA + width, 0.f);
+		if (peaksB) std::fill(peaksB, peaksB + width, 0.f);
+		if (hits) std::fill(hits, hits + width, 0);
+		lastPixel = -1;
+	}
+
+	auto readFrame = [&](const Frame& frame) {
+		const int pixel = juce::jlimit(0, width - 1, (int)(frame.x * width));
+		const float a = std::max(std::fabs(frame.min[0]), std::fabs(frame.max[0]));
+		const float b = std::max(std::fabs(frame.min[1]), std::fabs(frame.max[1]));
+
+		if (pixel == lastPixel) {
+			peaksA[pixel] = std::max(peaksA[pixel], a);
+			if (peaksB) peaksB[pixel] = std::max(peaksB[pixel], b);
+			if (hits) hits[pixel] = hits[pixel] || frame.hit;
+			return;
+		}
+
+		// a new pixel starts over, small forward jumps fill the pixels in between
+		int from = pixel;
+		if (lastPixel >= 0) {
+			const int gap = (pixel - lastPixel + width) % width;
+			if (gap < width / 8)
+				from = (lastPixel + 1) % width;
+		}
+		for (int p = from; ; p = (p + 1) % width) {
+			peaksA[p] = a;
+			if (peaksB) peaksB[p] = b;
+			if (hits) hits[p] = p == pixel && frame.hit;
+			if (p == pixel) break;
+		}
+		lastPixel = pixel;
+	};
+
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+	for (int i = 0; i < size1; ++i)
+		readFrame(frames[start1 + i]);
+	for (int i = 0; i < size2; ++i)
+		readFrame(frames[start2 + i]);
+	fifo.finishedRead(size1 + size2);
+
+	return lastPixel;
+}
@@ -0,0 +1,47 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Audio thread to UI visualization tap, fed only while a display is attached
+// samples are reduced to min/max frames published through a lock-free single producer single consumer ring
+class VisualTap
+{
+public:
+    struct Frame
+    {
+        float x = 0.f; // display position of the first sample, 0..1
+        std::array<float, 2> min = { 0.f, 0.f };
+        std::array<float, 2> max = { 0.f, 0.f };
+        bool hit = false; // transient detected within the frame
+    };
+
+    VisualTap(int capacity = 4096, int frameSize = 32);
+
+    void setActive(bool isActive) { active.store(isActive); } // displays attach on construction, detach on destruction
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+
+    // audio thread
+    void process(float x, float a, float b, bool hit = false);
+    void clear(); // the reader drops its peaks on the next read
+
+    // UI thread, drains the frames into per pixel peaks, pixels skipped between frames are filled
+    // returns the pixel of the last frame read, -1 if nothing was written since the last clear
+    int readPeaks(int width, float* peaksA, float* peaksB = nullptr, char* hits = nullptr);
+
+private:
+    void publish();
+
+    juce::AbstractFifo fifo;
+    std::vector<Frame> frames;
+    std::atomic<bool> active = false;
+    std::atomic<bool> clearPending = false;
+    const int frameSize;
+    Frame current; // frame being accumulated by the audio thread
+    int count = 0;
+    int lastPixel = -1; // reader state
+};
@@ -13,22 +13,22 @@
 
 AudioDisplay::AudioDisplay(REEVRAudioProcessor& p) : audioProcessor(p)
 {
+    peaks.resize(globals::MAX_PLUG_WIDTH, 0.f); // samples array size must be >= audio monitor width
+    hits.resize(globals::MAX_PLUG_WIDTH, 0);
+    audioProcessor.monitorTap.setActive(true);
     startTimerHz(60);
 };
 
-void AudioDisplay::timerCallback()
+AudioDisplay::~AudioDisplay()
 {
-    if (isVisible())
-        repaint();
+    audioProcessor.monitorTap.setActive(false);
 }
 
-void AudioDisplay::resized()
+void AudioDisplay::timerCallback()
 {
-    juce::Component::SafePointer<AudioDisplay> safeThis(this); // FIX Renoise DAW crashing on plugin instantiated
-    MessageManager::callAsync([safeThis] {
-        if (safeThis != nullptr)
-        safeThis->audioProcessor.monW = safeThis->getWidth();
-    });
+    writePixel = audioProcessor.monitorTap.readPeaks(std::min(getWidth(), (int)peaks.size()), peaks.data(), nullptr, hits.data());
+    if (isVisible())
+        repaint();
 }
 
 void AudioDisplay::paint(Graphics& g) {
@@ -36,16 +36,14 @@ void AudioDisplay::paint(Graphics& g) {
     g.setColour(Colours::white.withAlpha(0.4f));
     g.drawRect(bounds);
     g.setColour(Colour(0xff7f7f7f));
-    const int width = getWidth();
+    const int width = std::min(getWidth(), (int)peaks.size());
     const int height = getHeight();
-    const int index = (int)audioProcessor.monpos.load();
+    const int index = std::max(0, writePixel);
 
     for (int i = 0; i < width; ++i) {
-        double sample = audioProcessor.monSamples[(index + i) % width];
+        double sample = peaks[(index + i) % width];
         if (i == 0) sample = 0.0f; // ignore first pixel, fixes glitching
-        bool hit = sample >= 10.0; // trigger hits are encoded as amplitude +10
-        if (hit)
-            sample -= 10.0;
+        bool hit = hits[(index + i) % width] != 0;
         sample = jlimit(0.0,1.0,sample);
 
         if (sample > 0.0) {
@@ -21,12 +21,14 @@ class AudioDisplay : public juce::Component, private juce::Timer
 {
 public:
     AudioDisplay(REEVRAudioProcessor&);
-    ~AudioDisplay() override {};
-    void resized() override;
+    ~AudioDisplay() override;
     void timerCallback() override;
     void paint(Graphics& g) override;
     
     std::deque<double> audioBuffer;
     std::deque<bool> hitBuffer; 
+    std::vector<float> peaks; // peaks per pixel, read from the processor monitor tap
+    std::vector<char> hits; // transients per pixel
+    int writePixel = -1; // last pixel written, the oldest one follows
     REEVRAudioProcessor& audioProcessor;
 };
\ No newline at end of file
@@ -6,22 +6,20 @@ EQDisplay::EQDisplay(REEVRAudioProcessorEditor& e, SVF::EQType _type)
 	, type(_type)
 	, prel(type == SVF::ParamEQ ? "post" : "decay")
 {
+	editor.audioProcessor.analyzer.addViewer();
 	startTimerHz(30);
 	updateEQCurve();
 }
 
 EQDisplay::~EQDisplay()
 {
+	editor.audioProcessor.analyzer.removeViewer();
 }
 
 void EQDisplay::timerCallback()
 {
 	if (isShowing()) {
-		if (editor.audioProcessor.eqFFTReady.load(std::memory_order_acquire)) {
-			editor.audioProcessor.eqFFTReady.store(false, std::memory_order_release);
-			recalcFFTMags();
-		}
-
+		editor.audioProcessor.analyzer.getMagnitudes(fftMagnitudes);
 		repaint();
 	}
 }
@@ -215,11 +213,11 @@ void EQDisplay::paint(juce::Graphics& g)
 
 	// draw points
 	for (int i = 0; i < EQ_BANDS; ++i) {
-		auto pre = prel + "eq_band" + String(i + 1);
-		auto freq = editor.audioProcessor.params.getRawParameterValue(pre + "_freq")->load();
-		auto gain = editor.audioProcessor.params.getRawParameterValue(pre + "_gain")->load();
-		auto q = editor.audioProcessor.params.getRawParameterValue(pre + "_q")->load();
-		auto bypass = (bool)editor.audioProcessor.params.getRawParameterValue(pre + "_bypass")->load();
+		auto& registry = editor.audioProcessor.registry;
+		auto freq = registry.get(Param::eq(type, i, Param::eqfreq));
+		auto gain = registry.get(Param::eq(type, i, Param::eqgain));
+		auto q = registry.get(Param::eq(type, i, Param::eqq));
+		auto bypass = (bool)registry.get(Param::eq(type, i, Param::eqbypass));
 
 		freqs[i] = freq;
 		gains[i] = gain;
@@ -318,32 +316,6 @@ void EQDisplay::drawWaveform(juce::Graphics& g)
 	g.fillRect(bounds.toFloat().expanded(1.f).withHeight(2.f).withBottomY((float)bounds.getBottom() + 1));
 }
 
-void EQDisplay::recalcFFTMags()
-{
-	auto fftSize = 1 << EQ_FFT_ORDER;
-	auto writeIndex = editor.audioProcessor.eqWriteIndex;
-	auto bufferSize = fftData.size();
-	size_t startIndex = (writeIndex + bufferSize - fftSize) % bufferSize;
-
-	if (startIndex + fftSize <= bufferSize) {
-		std::copy_n(&editor.audioProcessor.eqBuffer[startIndex], fftSize, fftData.data());
-	}
-	else {
-		// Wrap-around copy
-		size_t firstPart = bufferSize - startIndex;
-		std::copy_n(&editor.audioProcessor.eqBuffer[startIndex], firstPart, fftData.data());
-		std::copy_n(&editor.audioProcessor.eqBuffer[0], fftSize - firstPart, fftData.data() + firstPart);
-	}
-
-	window.multiplyWithWindowingTable(fftData.data(), fftData.size());
-	fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
-	float norm = 1.f / (fftData.size() * 0.5f);
-	for (size_t j = 0; j < fftSize / 2; ++j) {
-	    float mag = fftData[j] * norm;
-	    fftMagnitudes[j] = mag * 0.8f + fftMagnitudes[j] * 0.2f;
-	}
-}
-
 void EQDisplay::resized()
 {
 	auto b = getLocalBounds();
@@ -365,6 +337,38 @@ void EQDisplay::updateEQCurve()
 
 	magPoints.clear();
 
+	// band coefficients do not depend on the curve point, compute them once
+	auto& registry = editor.audioProcessor.registry;
+	auto srate = editor.audioProcessor.srate;
+	std::array<bool, EQ_BANDS> active{};
+	for (int b = 0; b < EQ_BANDS; ++b) {
+		auto m = (int)registry.get(Param::eq(type, b, Param::eqmode));
+		auto cutoff = registry.get(Param::eq(type, b, Param::eqfreq));
+		auto gain = registry.get(Param::eq(type, b, Param::eqgain));
+		gain = exp(gain * DB2LOG);
+		auto q = registry.get(Param::eq(type, b, Param::eqq));
+		auto bypass = (bool)registry.get(Param::eq(type, b, Param::eqbypass));
+		if (bypass) continue;
+		active[b] = true;
+		SVF::Mode mode = b == 0 && m == 0 ? SVF::HP
+			: b == 0 && m == 1 ? SVF::LS
+			: b == 0 && m == 2 ? SVF::HP6
+			: b == EQ_BANDS - 1 && m == 0 ? SVF::LP
+			: b == EQ_BANDS - 1 && m == 1 ? SVF::HS
+			: b == EQ_BANDS - 1 && m == 2 ? SVF::LP6
+			: m == 0 ? SVF::BP : m == 1 ? SVF::PK
+			: SVF::BS;
+
+		if (mode == SVF::LP) bandFilters[b].lp((float)srate, cutoff, q);
+		else if (mode == SVF::LS) bandFilters[b].ls((float)srate, cutoff, q, gain);
+		else if (mode == SVF::HP) bandFilters[b].hp((float)srate, cutoff, q);
+		else if (mode == SVF::HS) bandFilters[b].hs((float)srate, cutoff, q, gain);
+		else if (mode == SVF::BP) bandFilters[b].bp((float)srate, cutoff, q);
+		else if (mode == SVF::BS) bandFilters[b].bs((float)srate, cutoff, q);
+		else if (mode == SVF::LP6) bandFilters[b].lp6((float)srate, cutoff);
+		else if (mode == SVF::HP6) bandFilters[b].hp6((float)srate, cutoff);
+		else bandFilters[b].pk((float)srate, cutoff, q, gain);
+	}
 
 	for (int i = 0; i < numPoints; ++i) {
 		float norm = (float)i / (numPoints - 1);
@@ -372,35 +376,8 @@ void EQDisplay::updateEQCurve()
 		float mag = 1.0f;
 
 		for (int b = 0; b < EQ_BANDS; ++b) {
-			auto pre = prel + "eq_band" + String(b + 1);
-			auto m = (int)editor.audioProcessor.params.getRawParameterValue(pre +  "_mode")->load();
-			auto srate = editor.audioProcessor.srate;
-			auto cutoff = editor.audioProcessor.params.getRawParameterValue(pre + "_freq")->load();
-			auto gain = editor.audioProcessor.params.getRawParameterValue(pre + "_gain")->load();
-			gain = exp(gain * DB2LOG);
-			auto q = editor.audioProcessor.params.getRawParameterValue(pre + "_q")->load();
-			auto bypass = (bool)editor.audioProcessor.params.getRawParameterValue(pre + "_bypass")->load();
-			if (bypass) continue;
-			SVF::Mode mode = b == 0 && m == 0 ? SVF::HP
-				: b == 0 && m == 1 ? SVF::LS
-				: b == 0 && m == 2 ? SVF::HP6
-				: b == EQ_BANDS - 1 && m == 0 ? SVF::LP
-				: b == EQ_BANDS - 1 && m == 1 ? SVF::HS
-				: b == EQ_BANDS - 1 && m == 2 ? SVF::LP6
-				: m == 0 ? SVF::BP : m == 1 ? SVF::PK
-				: SVF::BS;
-
-			if (mode == SVF::LP) bandFilters[b].lp((float)srate, cutoff, q);
-			else if (mode == SVF::LS) bandFilters[b].ls((float)srate, cutoff, q, gain);
-			else if (mode == SVF::HP) bandFilters[b].hp((float)srate, cutoff, q);
-			else if (mode == SVF::HS) bandFilters[b].hs((float)srate, cutoff, q, gain);
-			else if (mode == SVF::BP) bandFilters[b].bp((float)srate, cutoff, q);
-			else if (mode == SVF::BS) bandFilters[b].bs((float)srate, cutoff, q);
-			else if (mode == SVF::LP6) bandFilters[b].lp6((float)srate, cutoff);
-			else if (mode == SVF::HP6) bandFilters[b].hp6((float)srate, cutoff);
-			else bandFilters[b].pk((float)srate, cutoff, q, gain);
-
-			mag *= bandFilters[b].getMagnitude(freq);
+			if (active[b])
+				mag *= bandFilters[b].getMagnitude(freq);
 		}
 
 		magPoints.push_back((mag));
@@ -22,7 +22,6 @@ public:
 	void mouseUp(const MouseEvent& e) override;
 	void mouseDoubleClick(const MouseEvent& e) override;
 	void mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
-	void recalcFFTMags();
 
     void paint(juce::Graphics& g) override;
 	void drawWaveform(Graphics& g);
@@ -38,10 +37,7 @@ public:
 
 	std::array<SVF, EQ_BANDS> bandFilters{};
 private:
-	juce::dsp::FFT fft{ EQ_FFT_ORDER };
-	juce::dsp::WindowingFunction<float> window{ 1 << EQ_FFT_ORDER, juce::dsp::WindowingFunction<float>::blackmanHarris };
-	std::array<float, (1 << EQ_FFT_ORDER) * 2> fftData;
-	std::array<float, (1 << EQ_FFT_ORDER) / 2> fftMagnitudes;
+	std::vector<float> fftMagnitudes; // latest analyzer frame
 
 	SVF::EQType type;
 	String prel;
@@ -244,7 +244,7 @@ void EQWidget::toggleUIComponents()
 void EQWidget::showBandModeMenu()
 {
 	auto mode = SVF::PK;
-	auto m = (int)editor.audioProcessor.params.getRawParameterValue(prel + "eq_band" + String(selband + 1) + "_mode")->load();
+	auto m = (int)editor.audioProcessor.registry.get(Param::eq(type, selband, Param::eqmode));
 	if (selband == 0 && m == 0) mode = SVF::HP;
 	else if (selband == 0 && m == 1) mode = SVF::LS;
 	else if (selband == 0 && m == 2) mode = SVF::HP6;
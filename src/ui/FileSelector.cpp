@@ -75,7 +75,7 @@ void FileSelector::selectionChanged()
     if (!isVisible()) return;
     auto file = fileTree->getSelectedFile();
     auto& path = file.getFullPathName();
-    if (path.isNotEmpty() && path != audioProcessor.irFile)
+    if (path.isNotEmpty() && path != audioProcessor.getSlotFile(0))
         audioProcessor.loadImpulse(path);
 }
 void FileSelector::fileClicked(const juce::File &file, const juce::MouseEvent &e)
@@ -37,6 +37,13 @@ void SettingsButton::mouseDown(const juce::MouseEvent& e)
 	}
 	triggerChn.addItem(27, "Any", true, audioProcessor.triggerChn == 16);
 
+	PopupMenu slotChn;
+	slotChn.addItem(2030, "Off", true, audioProcessor.slotChn == -1);
+	for (int i = 0; i < 16; ++i) {
+		slotChn.addItem(2030 + i + 1, String(i + 1), true, audioProcessor.slotChn == i);
+	}
+	slotChn.addItem(2047, "Any", true, audioProcessor.slotChn == 16);
+
 	PopupMenu audioTrigger;
 	audioTrigger.addItem(32, "Ignore hits while playing", true, audioProcessor.audioIgnoreHitsWhilePlaying);
 
@@ -74,14 +81,87 @@ void SettingsButton::mouseDown(const juce::MouseEvent& e)
 	output.addSeparator();
 	output.addItem(701, "Bipolar CC", true, audioProcessor.bipolarCC);
 
+	PopupMenu convolver;
+	convolver.addItem(800, "Low memory IR (fp16)", true, audioProcessor.halfPrecisionIR);
+	PopupMenu outOfCore;
+	outOfCore.addItem(810, "Off", true, audioProcessor.outOfCoreMB == 0);
+	outOfCore.addSeparator();
+	for (int i = 0; i < 4; ++i) {
+		const int mb = 64 << i;
+		outOfCore.addItem(811 + i, String(mb) + " MB far tail in memory", true, audioProcessor.outOfCoreMB == mb);
+	}
+	if (audioProcessor.outOfCoreMB > 0) {
+		outOfCore.addSeparator();
+		outOfCore.addItem(819, "Late segments " + String((int64)audioProcessor.droppedTailSegments.load()), false, false);
+	}
+	convolver.addSubMenu("Stream IR tail from disk", outOfCore);
+	PopupMenu multirate;
+	multirate.addItem(820, "Off", true, audioProcessor.tailDecimation == 1);
+	multirate.addItem(821, "Half rate", true, audioProcessor.tailDecimation == 2);
+	multirate.addItem(822, "Quarter rate", true, audioProcessor.tailDecimation == 4);
+	if (audioProcessor.tailDecimation > 1) {
+		multirate.addSeparator();
+		multirate.addItem(829, "HF loss " + String(audioProcessor.tailDecimationErrorDb.load(), 1) + " dB", false, false);
+	}
+	convolver.addSubMenu("Multirate tail", multirate);
+	PopupMenu hybrid;
+	hybrid.addItem(830, "Off", true, audioProcessor.hybridTailMs == 0);
+	hybrid.addSeparator();
+	hybrid.addItem(831, "Convolve 500 ms", true, audioProcessor.hybridTailMs == 500);
+	hybrid.addItem(832, "Convolve 1 s", true, audioProcessor.hybridTailMs == 1000);
+	hybrid.addItem(833, "Convolve 2 s", true, audioProcessor.hybridTailMs == 2000);
+	convolver.addSubMenu("Synthesized tail", hybrid);
+	PopupMenu morph;
+	auto morphFiles = audioProcessor.getMorphFiles();
+	morph.addItem(840, "Add IR...", morphFiles.size() < MORPH_MAX_IRS - 1, false);
+	morph.addItem(841, "Clear", morphFiles.size() > 0, false);
+	if (morphFiles.size() > 0) {
+		morph.addSeparator();
+		for (int i = 0; i < morphFiles.size(); ++i)
+			morph.addItem(842 + i, File(morphFiles[i]).getFileNameWithoutExtension(), false, false);
+	}
+	convolver.addSubMenu("Morph IRs", morph);
+	PopupMenu slots;
+	for (int i = 1; i < IR_SLOTS; ++i) {
+		auto file = audioProcessor.getSlotFile(i);
+		auto name = file.isEmpty() ? String("Empty") : File(file).getFileNameWithoutExtension();
+		slots.addItem(850 + i, "Slot " + String(i) + ": " + name, true, audioProcessor.activeSlot == i);
+	}
+	slots.addItem(862, "Clear", audioProcessor.hasSlotFiles.load(), false);
+	slots.addSeparator();
+	PopupMenu slotBudget;
+	for (int i = 0; i < 4; ++i) {
+		const int mb = 128 << i;
+		slotBudget.addItem(863 + i, String(mb) + " MB", true, audioProcessor.slotBudgetMB == mb);
+	}
+	slots.addSubMenu("Memory budget", slotBudget);
+	String usage = "Using " + String((double)audioProcessor.slotMemory.load() / (1 << 20), 1) + " MB";
+	if (audioProcessor.slotsOverBudget.load() > 0)
+		usage += ", " + String(audioProcessor.slotsOverBudget.load()) + " over budget";
+	slots.addItem(867, usage, false, false);
+	convolver.addSubMenu("IR slots", slots);
+
 	PopupMenu options;
 	options.addSubMenu("Output", output);
 	options.addSubMenu("MIDI trigger chn", midiTriggerChn);
 	options.addSubMenu("Patt trigger chn", triggerChn);
+	options.addSubMenu("IR slot chn", slotChn);
 	options.addSubMenu("Audio trigger", audioTrigger);
 	options.addSeparator();
 	options.addItem(30, "Dual smooth", true, audioProcessor.dualSmooth);
 	options.addItem(31, "Dual tension", true, audioProcessor.dualTension);
+	options.addItem(33, "Pattern predelay", true, audioProcessor.predelayPattern);
+	PopupMenu envRate;
+	envRate.addItem(40, "Every sample", true, audioProcessor.envRate == 1);
+	envRate.addItem(41, "Every 8 samples", true, audioProcessor.envRate == 8);
+	envRate.addItem(42, "Every 16 samples", true, audioProcessor.envRate == 16);
+	envRate.addItem(43, "Every 32 samples", true, audioProcessor.envRate == 32);
+	envRate.addSeparator();
+	envRate.addItem(44, "Linear", audioProcessor.envRate > 1, !audioProcessor.envCubic);
+	envRate.addItem(45, "Cubic", audioProcessor.envRate > 1, audioProcessor.envCubic);
+	options.addSubMenu("Envelope rate", envRate);
+	options.addSeparator();
+	options.addSubMenu("Convolver", convolver);
 
 
 	PopupMenu load;
@@ -158,6 +238,21 @@ void SettingsButton::mouseDown(const juce::MouseEvent& e)
 					audioProcessor.audioIgnoreHitsWhilePlaying = !audioProcessor.audioIgnoreHitsWhilePlaying;
 				});
 			}
+			else if (result == 33) {
+				MessageManager::callAsync([this]() {
+					audioProcessor.predelayPattern = !audioProcessor.predelayPattern;
+				});
+			}
+			else if (result >= 40 && result <= 43) { // Envelope control rate
+				MessageManager::callAsync([this, result]() {
+					audioProcessor.envRate = result == 40 ? 1 : 4 << (result - 40);
+				});
+			}
+			else if (result == 44 || result == 45) {
+				MessageManager::callAsync([this, result]() {
+					audioProcessor.envCubic = result == 45;
+				});
+			}
 			else if (result == 52) {
 				if (audioProcessor.uimode == UIMode::Seq) {
 					auto snap = audioProcessor.sequencer->cells;
@@ -248,6 +343,75 @@ void SettingsButton::mouseDown(const juce::MouseEvent& e)
 			else if (result == 701) {
 				audioProcessor.bipolarCC = !audioProcessor.bipolarCC;
 			}
+			// convolver options
+			else if (result == 800) {
+				MessageManager::callAsync([this]() {
+					audioProcessor.halfPrecisionIR = !audioProcessor.halfPrecisionIR;
+					audioProcessor.irDirty = true;
+				});
+			}
+			else if (result >= 820 && result <= 822) {
+				MessageManager::callAsync([this, result]() {
+					audioProcessor.tailDecimation = 1 << (result - 820);
+					audioProcessor.irDirty = true;
+				});
+			}
+			else if (result == 840) {
+				AudioFormatManager formatManager;
+				formatManager.registerBasicFormats();
+				morphPicker = std::make_unique<FileChooser>("Select morph IR", File(audioProcessor.irDir), formatManager.getWildcardForAllFormats());
+				morphPicker->launchAsync(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles,
+					[this](const FileChooser& chooser) {
+						File selected = chooser.getResult();
+						if (selected.existsAsFile())
+							audioProcessor.addMorphImpulse(selected.getFullPathName());
+					});
+			}
+			else if (result >= 851 && result < 850 + IR_SLOTS) {
+				const int slot = result - 850;
+				AudioFormatManager formatManager;
+				formatManager.registerBasicFormats();
+				slotPicker = std::make_unique<FileChooser>("Select IR for slot " + String(slot), File(audioProcessor.irDir), formatManager.getWildcardForAllFormats());
+				slotPicker->launchAsync(FileBrowserComponent::openMode | FileBrowserComponent::canSelectFiles,
+					[this, slot](const FileChooser& chooser) {
+						File selected = chooser.getResult();
+						if (selected.existsAsFile())
+							audioProcessor.setSlotFile(slot, selected.getFullPathName());
+					});
+			}
+			else if (result == 862) {
+				MessageManager::callAsync([this]() {
+					audioProcessor.clearSlots();
+				});
+			}
+			else if (result >= 863 && result <= 866) {
+				MessageManager::callAsync([this, result]() {
+					audioProcessor.slotBudgetMB = 128 << (result - 863);
+					audioProcessor.saveSettings();
+					audioProcessor.slotsDirty = true;
+				});
+			}
+			else if (result >= 2030 && result <= 2047) {
+				audioProcessor.slotChn = result - 2030 - 1;
+			}
+			else if (result == 841) {
+				MessageManager::callAsync([this]() {
+					audioProcessor.clearMorphImpulses();
+				});
+			}
+			else if (result >= 830 && result <= 833) {
+				MessageManager::callAsync([this, result]() {
+					audioProcessor.hybridTailMs = result == 830 ? 0 : 500 << (result - 831);
+					audioProcessor.irDirty = true;
+				});
+			}
+			else if (result >= 810 && result <= 814) {
+				MessageManager::callAsync([this, result]() {
+					audioProcessor.outOfCoreMB = result == 810 ? 0 : 64 << (result - 811);
+					audioProcessor.saveSettings();
+					audioProcessor.irDirty = true;
+				});
+			}
 			else if (result == 1000) {
 				toggleAbout();
 			}
@@ -19,4 +19,6 @@ public:
 
 private:
     REEVRAudioProcessor& audioProcessor;
+    std::unique_ptr<juce::FileChooser> morphPicker;
+    std::unique_ptr<juce::FileChooser> slotPicker;
 };
\ No newline at end of file
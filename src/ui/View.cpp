@@ -14,11 +14,15 @@
 View::View(REEVRAudioProcessor& p) : audioProcessor(p), multiSelect(p), paintTool(p)
 {
     setWantsKeyboardFocus(true);
+    preSamples.resize(MAX_PLUG_WIDTH, 0); // samples array size must be >= viewport width
+    postSamples.resize(MAX_PLUG_WIDTH, 0);
+    audioProcessor.viewTap.setActive(true);
     startTimerHz(60);
 };
 
 View::~View()
 {
+    audioProcessor.viewTap.setActive(false);
 };
 
 void View::timerCallback()
@@ -45,6 +49,7 @@ void View::timerCallback()
     }
 
     luimode = audioProcessor.uimode;
+    audioProcessor.viewTap.readPeaks(std::min(winw, (int)preSamples.size()), preSamples.data(), postSamples.data());
     repaint();
 }
 
@@ -59,11 +64,6 @@ void View::resized()
     multiSelect.setViewBounds(winx, winy, winw, winh);
     paintTool.setViewBounds(winx, winy, winw, winh);
     audioProcessor.sequencer->setViewBounds(winx, winy, winw, winh);
-    juce::Component::SafePointer<View> safeThis(this); // FIX Renoise DAW crashing on plugin instantiated
-    MessageManager::callAsync([safeThis] {
-        if (safeThis != nullptr)
-            safeThis->audioProcessor.viewW = safeThis->winw;
-    });
     multiSelect.recalcSelectionArea();
 }
 
@@ -83,8 +83,8 @@ void View::paint(Graphics& g) {
         audioProcessor.sequencer->drawBackground(g);
 
     if (uimode == UIMode::Normal || uimode == UIMode::Seq) {
-        drawWave(g, audioProcessor.preSamples, Colour(0xff7f7f7f));
-        drawWave(g, audioProcessor.postSamples, Colour(COLOR_ACTIVE));
+        drawWave(g, preSamples, Colour(0xff7f7f7f));
+        drawWave(g, postSamples, Colour(COLOR_ACTIVE));
     }
 
     drawGrid(g);
@@ -75,6 +75,8 @@ private:
     int luimode = false;
 
     REEVRAudioProcessor& audioProcessor;
+    std::vector<float> preSamples; // pre audio peaks per pixel, read from the processor view tap
+    std::vector<float> postSamples; // post audio peaks per pixel
     double origTension = 0;
     int dragStartY = 0; // used for midpoint dragging
     uint64_t patternID = 0; // used to detect pattern changes
@@ -0,0 +1,114 @@
+#include "RTAudit.h"
+
+#if REEVR_RT_AUDIT
+
+#include <JuceHeader.h>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    constexpr int MAX_REPORTS = 32; // violations are still counted after this, only the logging stops
+
+    thread_local int realtimeDepth = 0;
+    thread_local bool reporting = false; // the report itself allocates
+    std::atomic<int> violations { 0 };
+
+    bool isAudited()
+    {
+        return realtimeDepth > 0 && !reporting;
+    }
+
+    void* allocate(std::size_t size)
+    {
+        if (isAudited())
+            RTAudit::violation("heap allocation");
+        if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t align)
+    {
+        if (isAudited())
+            RTAudit::violation("heap allocation");
+        auto alignment = static_cast<std::size_t>(align);
+        size = (size + alignment - 1) / alignment * alignment;
+#if JUCE_WINDOWS
+        if (auto* ptr = _aligned_malloc(size == 0 ? alignment : size, alignment))
+#else
+        if (auto* ptr = std::aligned_alloc(alignment, size == 0 ? alignment : size))
+#endif
+            return ptr;
+        throw std::bad_alloc();
+    }
+
+    void deallocate(void* ptr)
+    {
+        if (ptr != nullptr && isAudited())
+            RTAudit::violation("heap free");
+        std::free(ptr);
+    }
+
+    void deallocateAligned(void* ptr)
+    {
+        if (ptr != nullptr && isAudited())
+            RTAudit::violation("heap free");
+#if JUCE_WINDOWS
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
+
+namespace RTAudit
+{
+    ScopedAudioThread::ScopedAudioThread(bool _enabled)
+        : enabled(_enabled)
+    {
+        if (enabled) ++realtimeDepth;
+    }
+
+    ScopedAudioThread::~ScopedAudioThread()
+    {
+        if (enabled) --realtimeDepth;
+    }
+
+    void violation(const char* what, std::atomic<bool>* reported)
+    {
+        if (!isAudited())
+            return;
+
+        reporting = true;
+        bool logged = reported != nullptr && reported->exchange(true);
+        if (violations.fetch_add(1) < MAX_REPORTS && !logged) {
+            juce::Logger::writeToLog(juce::String("RT audit: ") + what + " on the audio thread\n"
+                + juce::SystemStats::getStackBacktrace());
+            jassertfalse;
+        }
+        reporting = false;
+    }
+
+    int getViolationCount()
+    {
+        return violations.load();
+    }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { try { return allocate(size); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { try { return allocate(size); } catch (...) { return nullptr; } }
+void* operator new(std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { deallocateAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { deallocateAligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { deallocateAligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { deallocateAligned(ptr); }
+
+#endif
@@ -0,0 +1,40 @@
+// Copyright 2025 tilr
+
+#pragma once
+
+/*
+	Real-time safety audit, enabled with the RT_AUDIT cmake option.
+	Threads inside an RT_AUDIT_SCOPE report heap allocations, frees and the
+	known blocking calls marked with RT_AUDIT_BLOCKING, the report logs the
+	offending stack and asserts. Compiles to nothing in normal builds.
+*/
+#if REEVR_RT_AUDIT
+
+#include <atomic>
+
+namespace RTAudit
+{
+    // marks the calling thread as real-time while in scope
+    class ScopedAudioThread
+    {
+    public:
+        explicit ScopedAudioThread(bool enabled);
+        ~ScopedAudioThread();
+    private:
+        bool enabled;
+    };
+
+    // reports if the calling thread is real-time, sites passing a flag are logged once
+    void violation(const char* what, std::atomic<bool>* reported = nullptr);
+    int getViolationCount();
+}
+
+#define RT_AUDIT_SCOPE(enabled) RTAudit::ScopedAudioThread rtAuditScope(enabled)
+#define RT_AUDIT_BLOCKING(what) do { static std::atomic<bool> rtAuditReported { false }; RTAudit::violation(what, &rtAuditReported); } while (0)
+
+#else
+
+#define RT_AUDIT_SCOPE(enabled)
+#define RT_AUDIT_BLOCKING(what)
+
+#endif
@@ -0,0 +1,201 @@
+// Copyright 2025 tilr
+
+/*
+	Headless real-time safety check, built with the RT_AUDIT cmake option.
+	Drives the processor through IR loads, pattern switches, tail clears and
+	MIDI bursts the way a host would and fails when the audio thread
+	allocated, freed or hit a known blocking call.
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "PluginProcessor.h"
+
+namespace
+{
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 512;
+    constexpr int SETTLE_TIMEOUT_MS = 30000;
+
+    class TestPlayHead : public AudioPlayHead
+    {
+    public:
+        bool playing = false;
+        int64_t timeInSamples = 0;
+
+        Optional<PositionInfo> getPosition() const override
+        {
+            PositionInfo info;
+            info.setBpm(120.0);
+            info.setTimeSignature(TimeSignature{ 4, 4 });
+            info.setIsPlaying(playing);
+            info.setTimeInSamples(timeInSamples);
+            info.setPpqPosition(timeInSamples / SAMPLE_RATE * 2.0);
+            return info;
+        }
+    };
+
+    class Harness
+    {
+    public:
+        Harness()
+        {
+            processor.setPlayHead(&playhead);
+            processor.setRateAndBufferSizeDetails(SAMPLE_RATE, BLOCK_SIZE);
+            processor.prepareToPlay(SAMPLE_RATE, BLOCK_SIZE);
+            int channels = std::max(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+            buffer.setSize(channels, BLOCK_SIZE * 4);
+            midi.ensureSize(globals::MAX_MIDI_EVENTS * 16);
+        }
+
+        ~Harness()
+        {
+            processor.releaseResources();
+        }
+
+        // buffers and midi are filled here, outside the audited processBlock
+        void process(int numSamples = BLOCK_SIZE)
+        {
+            AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numSamples);
+            for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    block.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+            processor.processBlock(block, midi);
+            midi.clear();
+            if (playhead.playing)
+                playhead.timeInSamples += numSamples;
+        }
+
+        // keeps processing until the queued IR loads and releases are done
+        bool settle()
+        {
+            auto start = Time::getMillisecondCounter();
+            while (processor.irDirty || processor.loadState.load() != kIdle) {
+                if (Time::getMillisecondCounter() - start > SETTLE_TIMEOUT_MS)
+                    return false;
+                process();
+                Thread::sleep(1);
+            }
+            process();
+            return true;
+        }
+
+        // host automation arrives on the audio thread, the listeners run there too
+        void automate(const String& id, float value)
+        {
+            RT_AUDIT_SCOPE(true);
+            auto* ranged = processor.params.getParameter(id);
+            auto normalized = ranged->convertTo0to1(value);
+            AudioProcessorParameter& param = *ranged; // setValue is only public on the base
+            param.setValue(normalized);
+            param.sendValueChangedMessageToListeners(normalized);
+        }
+
+        void gesture(const String& id, bool starting)
+        {
+            auto* param = processor.params.getParameter(id);
+            if (starting)
+                param->beginChangeGesture();
+            else
+                param->endChangeGesture();
+        }
+
+        REEVRAudioProcessor processor;
+        TestPlayHead playhead;
+        AudioBuffer<float> buffer;
+        MidiBuffer midi;
+        Random random{ 1234 };
+    };
+
+    // a short decaying noise IR so the load path reads and resamples a real file
+    File writeTestImpulse()
+    {
+        auto file = File::getSpecialLocation(File::tempDirectory).getChildFile("reevr_rtaudit_ir.wav");
+        file.deleteFile();
+
+        const double irRate = 44100.0;
+        AudioBuffer<float> ir(2, (int)irRate);
+        Random random{ 42 };
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < ir.getNumSamples(); ++i)
+                ir.setSample(ch, i, (random.nextFloat() * 2.f - 1.f) * std::exp(-6.f * i / (float)irRate));
+
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatWriter> writer(wav.createWriterFor(new FileOutputStream(file), irRate, 2, 24, {}, 0));
+        if (writer != nullptr)
+            writer->writeFromAudioSampleBuffer(ir, 0, ir.getNumSamples());
+        return file;
+    }
+
+    bool check(bool ok, const char* step)
+    {
+        if (!ok)
+            std::cout << "RTAuditTest: " << step << " timed out" << std::endl;
+        return ok;
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juceInit;
+    auto irFile = writeTestImpulse();
+    bool ok = true;
+    {
+        Harness h;
+        ok &= check(h.settle(), "initial IR load");
+
+        // IR loads, a new file, a dragged IR parameter with its draft and full rebuilds, back to the default
+        h.processor.loadImpulse(irFile.getFullPathName());
+        ok &= check(h.settle(), "IR file load");
+        h.gesture("irdecay", true);
+        for (int i = 0; i < 8; ++i) {
+            h.automate("irdecay", 0.2f + i * 0.1f);
+            h.process();
+        }
+        h.gesture("irdecay", false);
+        ok &= check(h.settle(), "IR parameter rebuild");
+        h.processor.loadImpulse("");
+        ok &= check(h.settle(), "default IR load");
+
+        // pattern switches, immediate while stopped and queued on the beat while playing
+        for (int pat = 2; pat <= 12; ++pat) {
+            h.automate("pattern", (float)pat);
+            h.process();
+        }
+        h.playhead.playing = true;
+        h.automate("patsync", 3.0f);
+        for (int pat = 1; pat <= 4; ++pat) {
+            h.automate("pattern", (float)pat);
+            for (int i = 0; i < 32; ++i)
+                h.process();
+        }
+
+        // tail clears
+        for (int i = 0; i < 8; ++i) {
+            h.processor.clearTails = true;
+            for (int j = 0; j < 16; ++j)
+                h.process();
+        }
+
+        // MIDI bursts on the MIDI trigger, one in a host block larger than the prepared size
+        h.automate("trigger", 1.0f);
+        for (int burst = 0; burst < 4; ++burst) {
+            int numSamples = burst == 3 ? BLOCK_SIZE * 4 : BLOCK_SIZE;
+            for (int i = 0; i < globals::MAX_MIDI_EVENTS / 2; ++i) {
+                int pos = i % numSamples;
+                h.midi.addEvent(MidiMessage::noteOn(1 + i % 16, 36 + i % 48, (uint8)100), pos);
+                h.midi.addEvent(MidiMessage::noteOff(1 + i % 16, 36 + i % 48), std::min(pos + 1, numSamples - 1));
+            }
+            h.process(numSamples);
+        }
+        h.playhead.playing = false;
+        h.process();
+        ok &= check(h.settle(), "final IR release");
+    }
+    irFile.deleteFile();
+
+    int violations = RTAudit::getViolationCount();
+    std::cout << "RTAuditTest: " << violations << " audio thread violations" << std::endl;
+    return ok && violations == 0 ? 0 : 1;
+}